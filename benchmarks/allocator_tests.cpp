@@ -0,0 +1,100 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream> //to write on a file
+#include <new>
+#include <random>
+
+/*
+ * Number of calls to operator new and wall time for building, searching and clearing a tree,
+ * with the default std::allocator and with pool_allocator.
+ *
+ * Compile with: g++ -O3 -std=c++14 allocator_tests.cpp -o allocator_tests.x
+ */
+
+static std::size_t allocations{0};
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+template <typename Tree>
+void run(const char *name, const std::vector<int> &keys, std::ofstream &file)
+{
+    const auto before = allocations;
+    auto start_build = clock_type::now();
+    Tree tree{};
+    for (auto k : keys)
+    {
+        tree.insert(std::pair<const int, int>{k, k});
+    }
+    auto end_build = clock_type::now();
+    const auto build_allocations = allocations - before;
+
+    long int found{0};
+    auto start_find = clock_type::now();
+    for (int round = 0; round < 10; ++round)
+    {
+        for (auto k : keys)
+        {
+            found += tree.find(k)->second;
+        }
+    }
+    auto end_find = clock_type::now();
+
+    auto start_clear = clock_type::now();
+    tree.clear();
+    auto end_clear = clock_type::now();
+
+    file << name << "\t" << keys.size() << "\t" << build_allocations << "\t"
+         << elapsed_ms(start_build, end_build) << "\t" << elapsed_ms(start_find, end_find) << "\t"
+         << elapsed_ms(start_clear, end_clear) << "\n";
+    std::cout << name << ": " << build_allocations << " allocations, build " << elapsed_ms(start_build, end_build)
+              << " ms, 10x find " << elapsed_ms(start_find, end_find) << " ms, clear " << elapsed_ms(start_clear, end_clear)
+              << " ms (checksum " << found << ")\n";
+}
+
+int main()
+{
+    using pair_type = std::pair<const int, int>;
+    std::ofstream file{"allocations.txt"};
+    file << "#allocator\tnodes\tallocations\tbuild_ms\tfind_ms\tclear_ms\n";
+
+    for (int nodes : {1000, 10000, 150000, 1000000})
+    {
+        std::vector<int> keys(nodes);
+        for (auto i = 0; i < nodes; ++i)
+        {
+            keys[i] = i;
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+
+        run<bst<int, int, std::less<int>, red_black>>("std::allocator", keys, file);
+        run<bst<int, int, std::less<int>, red_black, pool_allocator<pair_type>>>("pool_allocator", keys, file);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <map>
+#include <random>
+#include <string>
+
+/*
+ * Insertion + lookup times for the balancing policies, compared with std::map.
+ * For each stream (sorted, reverse-sorted, random) and each size, the keys are inserted one by one
+ * and then each of them is looked up once. Times are in nanoseconds per operation.
+ *
+ * Compile with: g++ -O3 -std=c++14 balancing_tests.cpp -o balancing_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+template <typename Container>
+std::pair<double, double> time_container(const std::vector<int> &keys)
+{
+    Container container{};
+    auto start_insert = clock_type::now();
+    for (auto k : keys)
+    {
+        container.insert(std::pair<const int, int>{k, k});
+    }
+    auto end_insert = clock_type::now();
+
+    long int found{0};
+    auto start_find = clock_type::now();
+    for (auto k : keys)
+    {
+        found += container.find(k)->second;
+    }
+    auto end_find = clock_type::now();
+    if (found == -1)
+    {
+        std::cout << "never printed, prevents the lookups from being optimised away\n";
+    }
+
+    const double n{static_cast<double>(keys.size())};
+    return {std::chrono::duration_cast<std::chrono::nanoseconds>(end_insert - start_insert).count() / n,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end_find - start_find).count() / n};
+}
+
+std::vector<int> make_stream(const std::string &kind, int nodes)
+{
+    std::vector<int> keys(nodes);
+    for (auto i = 0; i < nodes; ++i)
+    {
+        keys[i] = i;
+    }
+    if (kind == "reverse")
+    {
+        std::reverse(keys.begin(), keys.end());
+    }
+    else if (kind == "random")
+    {
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+    }
+    return keys;
+}
+
+int main()
+{
+    const std::vector<std::string> streams{"sorted", "reverse", "random"};
+    const int max_unbalanced{20000}; //the unbalanced tree is quadratic on sorted input
+
+    for (const auto &kind : streams)
+    {
+        std::ofstream file{"times_balancing_" + kind + ".txt"};
+        file << "#nodes\tunbalanced_ins\tunbalanced_find\tavl_ins\tavl_find\trb_ins\trb_find\tmap_ins\tmap_find\n";
+        for (auto nodes = 5000; nodes <= 150000; nodes += 5000)
+        {
+            const auto keys = make_stream(kind, nodes);
+            std::pair<double, double> unb{0.0, 0.0};
+            if (kind == "random" || nodes <= max_unbalanced)
+            {
+                unb = time_container<bst<int, int>>(keys);
+            }
+            const auto avl_times = time_container<bst<int, int, std::less<int>, avl>>(keys);
+            const auto rb_times = time_container<bst<int, int, std::less<int>, red_black>>(keys);
+            const auto map_times = time_container<std::map<int, int>>(keys);
+
+            file << nodes << "\t" << unb.first << "\t" << unb.second << "\t"
+                 << avl_times.first << "\t" << avl_times.second << "\t"
+                 << rb_times.first << "\t" << rb_times.second << "\t"
+                 << map_times.first << "\t" << map_times.second << "\n";
+        }
+        std::cout << "Written times_balancing_" << kind << ".txt\n";
+    }
+    return 0;
+}
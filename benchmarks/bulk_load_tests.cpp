@@ -0,0 +1,72 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Time to build a balanced tree from n pairs:
+ *  - insert + balance(), as done by tree_generator in map_tests.cpp
+ *  - range constructor on unsorted input (sort + O(n) build)
+ *  - range constructor with the sorted_unique tag on sorted input (O(n) build)
+ *
+ * Compile with: g++ -O3 -std=c++14 bulk_load_tests.cpp -o bulk_load_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+int main()
+{
+    std::ofstream file{"times_bulk_load.txt"};
+    file << "#nodes\tinsert_balance_ms\tunsorted_range_ms\tsorted_range_ms\n";
+
+    std::vector<int> nodes_range{};
+    for (auto i = 1000; i <= 150000; i += 1000)
+    {
+        nodes_range.push_back(i);
+    }
+    nodes_range.push_back(5000000);
+
+    for (auto nodes : nodes_range)
+    {
+        std::vector<std::pair<int, int>> pairs(nodes);
+        for (auto i = 0; i < nodes; ++i)
+        {
+            pairs[i] = {i, i};
+        }
+        auto sorted = pairs;
+        std::shuffle(pairs.begin(), pairs.end(), std::mt19937{42});
+
+        auto start_insert = clock_type::now();
+        bst<int, int> inserted{};
+        for (const auto &p : pairs)
+        {
+            inserted.insert(p);
+        }
+        inserted.balance();
+        auto end_insert = clock_type::now();
+
+        auto start_unsorted = clock_type::now();
+        bst<int, int> from_unsorted{pairs.begin(), pairs.end()};
+        auto end_unsorted = clock_type::now();
+
+        auto start_sorted = clock_type::now();
+        bst<int, int> from_sorted{sorted_unique, std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end())};
+        auto end_sorted = clock_type::now();
+
+        file << nodes << "\t" << elapsed_ms(start_insert, end_insert) << "\t" << elapsed_ms(start_unsorted, end_unsorted)
+             << "\t" << elapsed_ms(start_sorted, end_sorted) << "\n";
+        if (nodes == nodes_range.back())
+        {
+            std::cout << nodes << " nodes: insert + balance " << elapsed_ms(start_insert, end_insert)
+                      << " ms, unsorted range " << elapsed_ms(start_unsorted, end_unsorted)
+                      << " ms, sorted range " << elapsed_ms(start_sorted, end_sorted) << " ms\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "../include/compact_bst.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream> //to write on a file
+#include <map>
+#include <malloc.h> //malloc_usable_size, glibc only
+#include <new>
+#include <random>
+
+/*
+ * Heap bytes per entry and random lookup time of a red-black bst, a compact_bst and std::map
+ * with int keys and values, all built by n random insertions. The heap usage counts the usable
+ * size of every block plus the 8-byte malloc header, so it includes the allocator overhead
+ * and the spare capacity of the vectors of compact_bst.
+ *
+ * Compile with: g++ -O3 -std=c++14 compact_tests.cpp -o compact_tests.x
+ */
+
+static std::size_t live_bytes{0};
+
+void *operator new(std::size_t size)
+{
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        live_bytes += malloc_usable_size(p) + sizeof(std::size_t);
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p)
+    {
+        live_bytes -= malloc_usable_size(p) + sizeof(std::size_t);
+    }
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+using clock_type = std::chrono::steady_clock;
+
+template <typename Tree>
+void run(const char *name, const std::vector<int> &keys, const std::vector<int> &probes, std::ofstream &file)
+{
+    const auto before = live_bytes;
+    Tree tree{};
+    for (auto k : keys)
+    {
+        tree.insert(std::pair<const int, int>{k, k});
+    }
+    const double bytes{double(live_bytes - before) / keys.size()};
+
+    long int found{0};
+    auto start = clock_type::now();
+    for (auto k : probes)
+    {
+        found += tree.find(k)->second;
+    }
+    auto end = clock_type::now();
+    const double ns{std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(probes.size())};
+    file << keys.size() << "\t" << name << "\t" << bytes << "\t" << ns << "\n";
+    std::cout << keys.size() << " " << name << ": " << bytes << " bytes per entry, " << ns << " ns per find (" << found << ")\n";
+}
+
+int main()
+{
+    std::ofstream file{"times_compact.txt"};
+    file << "#n\ttree\tbytes_per_entry\tfind_ns\n";
+    for (int n : {1000, 150000, 1000000, 10000000})
+    {
+        std::mt19937 gen{42};
+        std::vector<int> keys(n);
+        for (int i = 0; i < n; ++i)
+        {
+            keys[i] = i;
+        }
+        std::shuffle(keys.begin(), keys.end(), gen);
+        std::vector<int> probes(1000000);
+        std::uniform_int_distribution<int> dist{0, n - 1};
+        for (auto &p : probes)
+        {
+            p = dist(gen);
+        }
+        run<bst<int, int, std::less<int>, red_black>>("bst", keys, probes, file);
+        run<compact_bst<int, int>>("compact_bst", keys, probes, file);
+        run<std::map<int, int>>("std::map", keys, probes, file);
+    }
+    return 0;
+}
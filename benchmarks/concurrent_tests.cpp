@@ -0,0 +1,129 @@
+#include "../include/concurrent_bst.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+ * Throughput of mixed workloads on 1M random keys out of 2M: 1 to hardware_concurrency() threads
+ * run lookups, inserts and erases of random keys for one second, with 90%, 50% and 10% of
+ * lookups. A concurrent_bst is compared with a red-black bst guarded by a std::mutex.
+ *
+ * Compile with: g++ -O3 -std=c++14 -pthread concurrent_tests.cpp -o concurrent_tests.x
+ */
+
+const int n{1000000};
+
+struct locked_tree
+{
+    bst<int, int, std::less<int>, red_black> tree{};
+    std::mutex m{};
+
+    bool insert(int k)
+    {
+        std::lock_guard<std::mutex> lock{m};
+        return tree.insert(std::pair<const int, int>{k, k}).second;
+    }
+    bool erase(int k)
+    {
+        std::lock_guard<std::mutex> lock{m};
+        return tree.erase(k);
+    }
+    bool contains(int k)
+    {
+        std::lock_guard<std::mutex> lock{m};
+        return tree.find(k) != tree.end();
+    }
+};
+
+struct fine_grained_tree
+{
+    concurrent_bst<int, int> tree{};
+
+    bool insert(int k) { return tree.insert({k, k}); }
+    bool erase(int k) { return tree.erase(k); }
+    bool contains(int k) { return tree.contains(k); }
+};
+
+template <typename Tree>
+void run(const char *name, unsigned int threads, int read_percent, std::ofstream &file)
+{
+    Tree t{};
+    std::vector<int> keys(2 * n);
+    for (int i = 0; i < 2 * n; ++i)
+    {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+    for (int i = 0; i < n; ++i)
+    {
+        t.insert(keys[i]);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<long int> operations{0};
+    std::atomic<long int> hits{0};
+    std::vector<std::thread> workers{};
+    for (unsigned int w = 0; w < threads; ++w)
+    {
+        workers.emplace_back([&, w]() {
+            std::mt19937 gen{w};
+            std::uniform_int_distribution<int> dist{0, 2 * n - 1};
+            std::uniform_int_distribution<int> percent{0, 99};
+            long int ops{0};
+            long int h{0};
+            while (!done)
+            {
+                const int k{dist(gen)};
+                const int p{percent(gen)};
+                if (p < read_percent)
+                {
+                    h += t.contains(k);
+                }
+                else if ((p - read_percent) % 2)
+                {
+                    h += t.insert(k);
+                }
+                else
+                {
+                    h += t.erase(k);
+                }
+                ++ops;
+            }
+            operations += ops;
+            hits += h;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds{1});
+    done = true;
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+    file << name << "\t" << threads << "\t" << read_percent << "\t" << operations / 1e6 << "\n";
+    std::cout << name << ", " << threads << " threads, " << read_percent << "% lookups: " << operations / 1e6 << "M ops/s (" << hits << ")\n";
+}
+
+int main()
+{
+    std::ofstream file{"times_concurrent.txt"};
+    file << "#tree\tthreads\tread_percent\tmillion_ops_per_s\n";
+    const unsigned int cores{std::max(1u, std::thread::hardware_concurrency())};
+    for (int read_percent : {90, 50, 10})
+    {
+        for (unsigned int threads = 1;; threads = std::min(2 * threads, cores)) //powers of two, then all the cores
+        {
+            run<locked_tree>("mutex bst", threads, read_percent, file);
+            run<fine_grained_tree>("concurrent_bst", threads, read_percent, file);
+            if (threads == cores)
+            {
+                break;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "../include/bst.h"
+#include <chrono>
+
+/*
+ * Latency of a deep copy of a 5M-Node tree: sequential copy with std::allocator,
+ * sequential copy with pool_allocator (all the Nodes preallocated in one block),
+ * and parallel copies with an increasing number of threads.
+ *
+ * Compile with: g++ -O3 -std=c++14 copy_tests.cpp -o copy_tests.x -pthread
+ */
+
+using clock_type = std::chrono::steady_clock;
+using pair_type = std::pair<const int, int>;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+int main()
+{
+    const int nodes{5000000};
+    std::vector<std::pair<int, int>> v{};
+    v.reserve(nodes);
+    for (auto i = 0; i < nodes; ++i)
+    {
+        v.emplace_back(i, i);
+    }
+
+    bst<int, int, std::less<int>, red_black> tree{sorted_unique, v.begin(), v.end()};
+    {
+        auto start = clock_type::now();
+        bst<int, int, std::less<int>, red_black> copy{tree};
+        auto end = clock_type::now();
+        std::cout << "sequential, std::allocator: " << elapsed_ms(start, end) << " ms\n";
+    }
+
+    bst<int, int, std::less<int>, red_black, pool_allocator<pair_type>> pool_tree{sorted_unique, v.begin(), v.end()};
+    {
+        auto start = clock_type::now();
+        bst<int, int, std::less<int>, red_black, pool_allocator<pair_type>> copy{pool_tree};
+        auto end = clock_type::now();
+        std::cout << "sequential, pool_allocator: " << elapsed_ms(start, end) << " ms\n";
+    }
+
+    for (unsigned int threads : {2u, 4u, 8u, 16u})
+    {
+        auto start = clock_type::now();
+        bst<int, int, std::less<int>, red_black> copy{tree, parallel_copy{threads}};
+        auto end = clock_type::now();
+        std::cout << "parallel, " << threads << " threads: " << elapsed_ms(start, end) << " ms\n";
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Inserting values that are expensive to copy (a std::vector<double> of 1024 elements) in a
+ * red-black tree:
+ *  - insert(pair_type{key, value}), which copies the value into the pair
+ *  - emplace(key, std::move(value)) and try_emplace(key, std::move(value)), which move it
+ * and then the same calls with keys that are already present, where try_emplace builds nothing.
+ *
+ * Compile with: g++ -O3 -std=c++14 emplace_tests.cpp -o emplace_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+using value_type = std::vector<double>;
+using tree_type = bst<int, value_type, std::less<int>, red_black>;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+template <typename F>
+double run(const std::vector<int> &keys, tree_type &tree, F insert)
+{
+    std::vector<value_type> values(keys.size(), value_type(1024, 1.0));
+    auto start = clock_type::now();
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        insert(tree, keys[i], values[i]);
+    }
+    return elapsed_ms(start, clock_type::now());
+}
+
+int main()
+{
+    std::ofstream file{"times_emplace.txt"};
+    file << "#nodes\tinsert_copy_ms\templace_ms\ttry_emplace_ms\tduplicate_emplace_ms\tduplicate_try_emplace_ms\n";
+    for (int nodes : {1000, 10000, 100000})
+    {
+        std::vector<int> keys(nodes);
+        for (int i = 0; i < nodes; ++i)
+        {
+            keys[i] = i;
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+
+        auto copy_insert = [](tree_type &t, int k, value_type &v) { t.insert(std::pair<const int, value_type>{k, v}); };
+        auto emplace = [](tree_type &t, int k, value_type &v) { t.emplace(k, std::move(v)); };
+        auto try_emplace = [](tree_type &t, int k, value_type &v) { t.try_emplace(k, std::move(v)); };
+
+        tree_type a{}, b{}, c{};
+        const double copy_ms{run(keys, a, copy_insert)};
+        const double emplace_ms{run(keys, b, emplace)};
+        const double try_emplace_ms{run(keys, c, try_emplace)};
+        const double duplicate_emplace_ms{run(keys, b, emplace)}; //every key is already there
+        const double duplicate_try_emplace_ms{run(keys, c, try_emplace)};
+
+        file << nodes << "\t" << copy_ms << "\t" << emplace_ms << "\t" << try_emplace_ms << "\t" << duplicate_emplace_ms << "\t"
+             << duplicate_try_emplace_ms << "\n";
+        std::cout << nodes << " nodes: insert(copy) " << copy_ms << " ms, emplace " << emplace_ms << " ms, try_emplace "
+                  << try_emplace_ms << " ms; duplicates: emplace " << duplicate_emplace_ms << " ms, try_emplace "
+                  << duplicate_try_emplace_ms << " ms\n";
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream> //to write on a file
+#include <new>
+#include <random>
+#include <string>
+
+/*
+ * Session-table churn on a red-black tree with std::string keys: every round erases a random
+ * live key and inserts a new one. Counts the calls to operator new made by erase (there must be
+ * none) and compares erase(key) with erase(iterator) after a find.
+ *
+ * Compile with: g++ -O3 -std=c++14 erase_tests.cpp -o erase_tests.x
+ */
+
+static std::size_t allocations{0};
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = bst<std::string, std::string, std::less<std::string>, red_black>;
+
+std::string session(long int i)
+{
+    return "session-id-" + std::to_string(1000000000L + i);
+}
+
+int main()
+{
+    std::ofstream file{"times_erase.txt"};
+    file << "#nodes\tmethod\tallocations_in_erase\tns_per_erase\n";
+    std::mt19937 gen{42};
+
+    for (int nodes : {1000, 150000, 1000000})
+    {
+        for (int by_iterator = 0; by_iterator < 2; ++by_iterator)
+        {
+            tree_type tree{};
+            std::vector<std::string> live{};
+            for (int i = 0; i < nodes; ++i)
+            {
+                live.push_back(session(i));
+                tree.insert(std::make_pair(live.back(), std::string(40, 'x')));
+            }
+            const int rounds{200000};
+            long int next_id{nodes};
+            std::size_t erase_allocations{0};
+            clock_type::duration erase_time{};
+            for (int r = 0; r < rounds; ++r)
+            {
+                auto &victim = live[gen() % live.size()];
+                const auto before = allocations;
+                auto start = clock_type::now();
+                if (by_iterator)
+                {
+                    tree.erase(tree.find(victim));
+                }
+                else
+                {
+                    tree.erase(victim);
+                }
+                erase_time += clock_type::now() - start;
+                erase_allocations += allocations - before;
+                victim = session(next_id++);
+                tree.insert(std::make_pair(victim, std::string(40, 'x')));
+            }
+            const double ns{std::chrono::duration_cast<std::chrono::nanoseconds>(erase_time).count() / double(rounds)};
+            const char *method{by_iterator ? "erase(find(key))" : "erase(key)"};
+            file << nodes << "\t" << method << "\t" << erase_allocations << "\t" << ns << "\n";
+            std::cout << nodes << " nodes, " << method << ": " << erase_allocations << " allocations, " << ns << " ns per erase\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "../include/bst.h"
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Throughput of 1M random lookups on a red-black tree: one find() after the other against
+ * find_batch() with groups of 1 to 64 interleaved lookups. The gain shows up when the tree
+ * doesn't fit in the last level cache.
+ *
+ * Compile with: g++ -O3 -std=c++14 find_batch_tests.cpp -o find_batch_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = bst<int, int, std::less<int>, red_black>;
+
+double elapsed_ns(clock_type::time_point start, clock_type::time_point end, std::size_t lookups)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(lookups);
+}
+
+int main()
+{
+    std::ofstream file{"times_find_batch.txt"};
+    file << "#nodes\tgroup\tns_per_lookup\n";
+    std::mt19937 gen{42};
+    long int checksum{0};
+
+    for (int nodes : {150000, 1000000, 10000000})
+    {
+        std::vector<std::pair<int, int>> pairs(nodes);
+        for (int i = 0; i < nodes; ++i)
+        {
+            pairs[i] = {i, i};
+        }
+        const tree_type tree{sorted_unique, pairs.begin(), pairs.end()};
+        std::uniform_int_distribution<int> dist{0, nodes - 1};
+        std::vector<int> queries(1000000);
+        for (auto &q : queries)
+        {
+            q = dist(gen);
+        }
+        std::vector<decltype(tree.cend())> results(queries.size());
+
+        auto start = clock_type::now();
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            results[i] = tree.find(queries[i]);
+        }
+        auto end = clock_type::now();
+        checksum += results.back()->second;
+        file << nodes << "\tfind\t" << elapsed_ns(start, end, queries.size()) << "\n";
+        std::cout << nodes << " nodes: find " << elapsed_ns(start, end, queries.size()) << " ns";
+
+        for (std::size_t group : {1, 2, 4, 8, 16, 32, 64})
+        {
+            start = clock_type::now();
+            tree.find_batch(queries.begin(), queries.end(), results.begin(), group);
+            end = clock_type::now();
+            checksum += results.back()->second;
+            file << nodes << "\t" << group << "\t" << elapsed_ns(start, end, queries.size()) << "\n";
+            std::cout << ", " << group << ": " << elapsed_ns(start, end, queries.size()) << " ns";
+        }
+        std::cout << " per lookup\n";
+    }
+    std::cout << "(checksum " << checksum << ")\n";
+    return 0;
+}
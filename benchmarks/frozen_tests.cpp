@@ -0,0 +1,86 @@
+#include "../include/frozen_bst.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream> //to write on a file
+#include <map>
+#include <random>
+
+/*
+ * Average time of a successful lookup on a balanced bst (red_black), on its frozen_bst snapshot and on
+ * std::map, with random keys. The sizes go from 1000 to 150000 Nodes as in map_tests.cpp, then up to
+ * the number of Nodes given as first argument (10M by default; 100M needs about 15 GB of memory).
+ *
+ * Compile with: g++ -O3 -std=c++14 frozen_tests.cpp -o frozen_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+const int lookups{1000000};
+
+template <typename Container>
+double lookup_ns(const Container &container, const std::vector<int> &queries, long int &checksum)
+{
+    auto start = clock_type::now();
+    for (auto q : queries)
+    {
+        checksum += container.find(q)->second;
+    }
+    auto end = clock_type::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(queries.size());
+}
+
+int main(int argc, char **argv)
+{
+    const long int max_nodes{argc > 1 ? std::atol(argv[1]) : 10000000L};
+    std::ofstream file{"times_frozen.txt"};
+    file << "#nodes\tbst_ns\tfrozen_ns\tmap_ns\n";
+
+    std::vector<long int> nodes_range{};
+    for (long int i = 1000; i <= 150000; i += 1000)
+    {
+        nodes_range.push_back(i);
+    }
+    for (long int i = 1000000; i <= max_nodes; i *= 10)
+    {
+        nodes_range.push_back(i);
+    }
+
+    std::mt19937 gen{42};
+    long int checksum{0};
+    for (auto nodes : nodes_range)
+    {
+        std::vector<std::pair<int, int>> pairs(nodes);
+        for (int i = 0; i < nodes; ++i)
+        {
+            pairs[i] = {i, i};
+        }
+        std::uniform_int_distribution<int> dist{0, static_cast<int>(nodes - 1)};
+        std::vector<int> queries(lookups);
+        for (auto &q : queries)
+        {
+            q = dist(gen);
+        }
+
+        double bst_ns, frozen_ns, map_ns;
+        {
+            bst<int, int, std::less<int>, red_black> tree{sorted_unique, pairs.begin(), pairs.end()};
+            bst_ns = lookup_ns(tree, queries, checksum);
+            auto frozen = freeze(tree);
+            frozen_ns = lookup_ns(frozen, queries, checksum);
+        }
+        {
+            std::map<int, int> map{pairs.begin(), pairs.end()};
+            map_ns = lookup_ns(map, queries, checksum);
+        }
+
+        file << nodes << "\t" << bst_ns << "\t" << frozen_ns << "\t" << map_ns << "\n";
+        if (nodes == 1000 || nodes == 150000 || nodes >= 1000000)
+        {
+            std::cout << nodes << " nodes: bst " << bst_ns << " ns, frozen_bst " << frozen_ns << " ns, std::map " << map_ns
+                      << " ns per lookup\n";
+        }
+    }
+    std::cout << "(checksum " << checksum << ")\n";
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "../include/bst.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream> //to write on a file
+#include <new>
+#include <random>
+#include <string>
+
+/*
+ * Lookups by const char* in a tree with std::string keys longer than the small string buffer:
+ * with std::less<std::string> every find() builds a temporary std::string (one heap allocation),
+ * with the transparent std::less<> the stored keys are compared directly with the probe. Comparing a
+ * std::string with a const char* calls strlen every time, so the last case uses a probe that
+ * carries its length, as std::string_view does in C++17.
+ *
+ * Compile with: g++ -O3 -std=c++14 heterogeneous_tests.cpp -o heterogeneous_tests.x
+ */
+
+static std::size_t allocations{0};
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using clock_type = std::chrono::steady_clock;
+
+/**
+ * @brief Pointer and length of a string, the C++14 stand-in for std::string_view.
+ */
+struct string_ref
+{
+    const char *data;
+    std::size_t size;
+};
+
+/**
+ * @brief Transparent comparison between std::string and string_ref.
+ */
+struct less_string_ref
+{
+    using is_transparent = void;
+    bool operator()(const std::string &a, const std::string &b) const noexcept { return a < b; }
+    bool operator()(const std::string &a, const string_ref &b) const noexcept { return a.compare(0, a.size(), b.data, b.size) < 0; }
+    bool operator()(const string_ref &a, const std::string &b) const noexcept { return b.compare(0, b.size(), a.data, a.size) > 0; }
+};
+
+template <typename Tree, typename Probe>
+void run(const char *name, const std::vector<std::string> &keys, const std::vector<Probe> &probes, std::ofstream &file)
+{
+    Tree tree{};
+    for (const auto &k : keys)
+    {
+        tree.insert(std::pair<const std::string, int>{k, 1});
+    }
+    long int found{0};
+    const auto before = allocations;
+    auto start = clock_type::now();
+    for (auto p : probes)
+    {
+        found += tree.find(p)->second;
+    }
+    auto end = clock_type::now();
+    const auto lookup_allocations = allocations - before;
+    const double ns{std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(probes.size())};
+    file << name << "\t" << keys.size() << "\t" << lookup_allocations << "\t" << ns << "\n";
+    std::cout << name << ", " << keys.size() << " keys: " << lookup_allocations << " allocations, " << ns
+              << " ns per lookup (checksum " << found << ")\n";
+}
+
+int main()
+{
+    std::ofstream file{"times_heterogeneous.txt"};
+    file << "#comparator\tnodes\tallocations\tns_per_lookup\n";
+    std::mt19937 gen{42};
+    for (int nodes : {1000, 150000})
+    {
+        std::vector<std::string> keys{};
+        for (int i = 0; i < nodes; ++i)
+        {
+            keys.push_back("/routing/table/entry/" + std::to_string(i));
+        }
+        std::uniform_int_distribution<int> dist{0, nodes - 1};
+        std::vector<const char *> probes(1000000);
+        for (auto &p : probes)
+        {
+            p = keys[dist(gen)].c_str();
+        }
+        run<bst<std::string, int, std::less<std::string>, red_black>>("std::less<std::string>", keys, probes, file);
+        run<bst<std::string, int, std::less<>, red_black>>("std::less<>", keys, probes, file);
+        std::vector<string_ref> refs(probes.size());
+        for (std::size_t i = 0; i < probes.size(); ++i)
+        {
+            refs[i] = string_ref{probes[i], std::char_traits<char>::length(probes[i])};
+        }
+        run<bst<std::string, int, less_string_ref, red_black>>("less_string_ref", keys, refs, file);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <numeric>
+#include <random>
+
+/*
+ * Hinted insertion: n keys inserted in a red-black tree with insert(pair), and with
+ * insert(hint, pair) passing the position of the previous insertion (end() for the first one).
+ * The streams are sorted, sorted with 1% of the keys swapped at random, and random.
+ * A correct hint costs O(1) amortized comparisons; a wrong one falls back to a full descent.
+ *
+ * Compile with: g++ -O3 -std=c++14 hint_tests.cpp -o hint_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = bst<int, int, std::less<int>, red_black>;
+
+double plain(const std::vector<int> &keys)
+{
+    tree_type tree{};
+    auto start = clock_type::now();
+    for (auto k : keys)
+    {
+        tree.insert(std::pair<const int, int>{k, k});
+    }
+    auto end = clock_type::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(keys.size());
+}
+
+double hinted(const std::vector<int> &keys)
+{
+    tree_type tree{};
+    auto start = clock_type::now();
+    auto hint = tree.end();
+    for (auto k : keys)
+    {
+        hint = tree.insert(hint, std::pair<const int, int>{k, k});
+        ++hint; //the next key of a sorted stream goes right before the successor
+    }
+    auto end = clock_type::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(keys.size());
+}
+
+int main()
+{
+    std::ofstream file{"times_hint.txt"};
+    file << "#n\tstream\tinsert_ns\thinted_ns\n";
+    for (int n : {150000, 1000000})
+    {
+        std::mt19937 gen{42};
+        std::vector<int> sorted(n);
+        std::iota(sorted.begin(), sorted.end(), 0);
+        auto nearly{sorted};
+        std::uniform_int_distribution<int> dist{0, n - 1};
+        for (int i = 0; i < n / 100; ++i)
+        {
+            std::swap(nearly[dist(gen)], nearly[dist(gen)]);
+        }
+        auto shuffled{sorted};
+        std::shuffle(shuffled.begin(), shuffled.end(), gen);
+
+        for (auto stream : {std::make_pair("sorted", &sorted), std::make_pair("1%-shuffled", &nearly), std::make_pair("random", &shuffled)})
+        {
+            const double a{plain(*stream.second)};
+            const double b{hinted(*stream.second)};
+            file << n << "\t" << stream.first << "\t" << a << "\t" << b << "\n";
+            std::cout << n << " " << stream.first << ": insert " << a << " ns, hinted " << b << " ns\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "../include/mapped_bst.h"
+#include <chrono>
+#include <cstdio>  //std::remove
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Time to get a saved tree of n int -> double pairs ready for lookups:
+ *  - load(path) of a file written by save(), which reads every pair and rebuilds the Nodes
+ *  - opening a mapped_bst on a file written by write_mapped(), which maps the file and checks its header
+ * then the time of the first 1000 lookups after opening, and the average time of a lookup on the
+ * loaded bst (red_black), on the mapped_bst and on a frozen_bst in memory, with 1M random queries.
+ * The files are in the page cache of the operating system: reading them from disk adds to load(),
+ * while a mapped_bst only reads the pages its lookups touch.
+ *
+ * Compile with: g++ -O3 -std=c++14 mapped_tests.cpp -o mapped_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e6;
+}
+
+template <typename Container>
+double lookup_ns(const Container &container, const std::vector<int> &queries, double &checksum)
+{
+    auto start = clock_type::now();
+    for (auto q : queries)
+    {
+        checksum += container.find(q)->second;
+    }
+    return elapsed_ms(start, clock_type::now()) * 1e6 / queries.size();
+}
+
+int main()
+{
+    using tree_type = bst<int, double, std::less<int>, red_black>;
+    const std::string saved{"mapped_tests_saved.bin"};
+    const std::string mapped{"mapped_tests_mapped.bin"};
+    std::ofstream file{"times_mapped.txt"};
+    file << "#n\tload_ms\tmap_ms\tfirst_lookups_ms\tbst_ns\tmapped_ns\tfrozen_ns\n";
+    std::mt19937 gen{42};
+    double checksum{0};
+    for (int n : {1000000, 10000000})
+    {
+        std::vector<std::pair<int, double>> pairs(n);
+        for (int i = 0; i < n; ++i)
+        {
+            pairs[i] = {2 * i, i * 0.5};
+        }
+        std::uniform_int_distribution<int> dist{0, n - 1};
+        std::vector<int> queries(1000000);
+        for (auto &q : queries)
+        {
+            q = 2 * dist(gen);
+        }
+        {
+            tree_type tree{sorted_unique, pairs.begin(), pairs.end()};
+            tree.save(saved);
+            write_mapped(tree, mapped);
+        }
+
+        tree_type loaded{};
+        auto start = clock_type::now();
+        loaded.load(saved);
+        const double load_ms{elapsed_ms(start, clock_type::now())};
+
+        start = clock_type::now();
+        mapped_bst<int, double> view{mapped};
+        const double map_ms{elapsed_ms(start, clock_type::now())};
+        start = clock_type::now();
+        for (int i = 0; i < 1000; ++i)
+        {
+            checksum += view.find(queries[i])->second;
+        }
+        const double first_ms{elapsed_ms(start, clock_type::now())};
+
+        const double bst_ns{lookup_ns(loaded, queries, checksum)};
+        const double mapped_ns{lookup_ns(view, queries, checksum)};
+        const double frozen_ns{lookup_ns(freeze(loaded), queries, checksum)};
+        std::remove(saved.c_str());
+        std::remove(mapped.c_str());
+
+        file << n << "\t" << load_ms << "\t" << map_ms << "\t" << first_ms << "\t" << bst_ns << "\t" << mapped_ns << "\t" << frozen_ns << "\n";
+        std::cout << n << " pairs: load " << load_ms << " ms, map " << map_ms << " ms, first 1000 lookups " << first_ms << " ms; lookup bst " << bst_ns << " ns, mapped " << mapped_ns << " ns, frozen " << frozen_ns << " ns\n";
+    }
+    std::cout << "(checksum " << checksum << ")\n";
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Reconciliation of two red-black trees with n and m random keys (half of the keys of the second one are also in the first):
+ *  - merge: a loop of insert(*it) over the second tree, against bst::merge(), both followed by clearing the second tree
+ *  - union: a copy of the first tree plus a loop of insert(*it), against set_union()
+ *  - intersection: a loop of find() over the first tree that inserts the common pairs in a new tree, against set_intersection()
+ * The trees are built by inserting the keys in random order, as they would be after a long use, and built again before every measurement.
+ *
+ * Compile with: g++ -O3 -std=c++14 merge_tests.cpp -o merge_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = bst<int, int, std::less<int>, red_black>;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+tree_type build(const std::vector<std::pair<int, int>> &pairs)
+{
+    tree_type tree{};
+    for (const auto &p : pairs)
+    {
+        tree.insert(std::pair<const int, int>{p.first, p.second});
+    }
+    return tree;
+}
+
+int main()
+{
+    std::ofstream file{"times_merge.txt"};
+    file << "#n\tm\toperation\tloop_ms\tlinear_ms\n";
+    for (auto sizes : {std::make_pair(1000000, 1000000), std::make_pair(1000000, 10000), std::make_pair(4000000, 4000000)})
+    {
+        const int n{sizes.first};
+        const int m{sizes.second};
+        std::mt19937 gen{42};
+        std::vector<int> keys(n + m / 2);
+        for (int i = 0; i < static_cast<int>(keys.size()); ++i)
+        {
+            keys[i] = 2 * i;
+        }
+        std::shuffle(keys.begin(), keys.end(), gen);
+        std::vector<std::pair<int, int>> first{}, second{};
+        for (int i = 0; i < n; ++i)
+        {
+            first.emplace_back(keys[i], 1);
+        }
+        for (int i = 0; i < m; ++i)
+        {
+            second.emplace_back(keys[n - m / 2 + i], 2); //the first m/2 are also in the first tree
+        }
+
+        double loop, linear;
+        {
+            auto a = build(first);
+            auto b = build(second);
+            auto start = clock_type::now();
+            for (const auto &p : b)
+            {
+                a.insert(p);
+            }
+            b.clear();
+            loop = elapsed_ms(start, clock_type::now());
+        }
+        {
+            auto a = build(first);
+            auto b = build(second);
+            auto start = clock_type::now();
+            a.merge(b);
+            b.clear();
+            linear = elapsed_ms(start, clock_type::now());
+        }
+        file << n << "\t" << m << "\tmerge\t" << loop << "\t" << linear << "\n";
+        std::cout << n << " + " << m << " merge: " << loop << " ms with insert, " << linear << " ms with merge()\n";
+
+        auto a = build(first);
+        auto b = build(second);
+        {
+            auto start = clock_type::now();
+            tree_type u{a};
+            for (const auto &p : b)
+            {
+                u.insert(p);
+            }
+            loop = elapsed_ms(start, clock_type::now());
+            start = clock_type::now();
+            auto v = set_union(a, b);
+            linear = elapsed_ms(start, clock_type::now());
+            if (u.size() != v.size())
+            {
+                return 1;
+            }
+        }
+        file << n << "\t" << m << "\tunion\t" << loop << "\t" << linear << "\n";
+        std::cout << n << " + " << m << " union: " << loop << " ms with insert, " << linear << " ms with set_union()\n";
+        {
+            auto start = clock_type::now();
+            tree_type i{};
+            for (const auto &p : a)
+            {
+                if (b.find(p.first) != b.end())
+                {
+                    i.insert(p);
+                }
+            }
+            loop = elapsed_ms(start, clock_type::now());
+            start = clock_type::now();
+            auto j = set_intersection(a, b);
+            linear = elapsed_ms(start, clock_type::now());
+            if (i.size() != j.size())
+            {
+                return 1;
+            }
+        }
+        file << n << "\t" << m << "\tintersection\t" << loop << "\t" << linear << "\n";
+        std::cout << n << " + " << m << " intersection: " << loop << " ms with find, " << linear << " ms with set_intersection()\n";
+    }
+    return 0;
+}
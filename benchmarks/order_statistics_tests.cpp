@@ -0,0 +1,86 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Percentile queries on a red-black tree: the k-th key found by walking k steps from begin(),
+ * against select(k) with the order_statistics policy. The cost of keeping the subtree sizes is
+ * measured on random insertions.
+ *
+ * Compile with: g++ -O3 -std=c++14 order_statistics_tests.cpp -o order_statistics_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+using plain_tree = bst<int, int, std::less<int>, red_black>;
+using counted_tree = bst<int, int, std::less<int>, order_statistics<red_black>>;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+template <typename Tree>
+double build_ms(Tree &tree, const std::vector<int> &keys)
+{
+    auto start = clock_type::now();
+    for (auto k : keys)
+    {
+        tree.insert(std::pair<const int, int>{k, k});
+    }
+    return elapsed_ms(start, clock_type::now());
+}
+
+int main()
+{
+    std::ofstream file{"times_order_statistics.txt"};
+    file << "#nodes\tbuild_ms\tbuild_counted_ms\twalk_us\tselect_us\n";
+    const int queries{100};
+    long int checksum{0};
+
+    for (int nodes : {1000, 150000, 1000000})
+    {
+        std::vector<int> keys(nodes);
+        for (int i = 0; i < nodes; ++i)
+        {
+            keys[i] = i;
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+
+        plain_tree plain{};
+        counted_tree counted{};
+        const double plain_build{build_ms(plain, keys)};
+        const double counted_build{build_ms(counted, keys)};
+
+        std::uniform_int_distribution<std::size_t> dist{0, static_cast<std::size_t>(nodes - 1)};
+        std::mt19937 gen{7};
+        std::vector<std::size_t> ranks(queries);
+        for (auto &r : ranks)
+        {
+            r = dist(gen);
+        }
+
+        auto start_walk = clock_type::now();
+        for (auto r : ranks)
+        {
+            checksum += std::next(plain.begin(), r)->first;
+        }
+        auto end_walk = clock_type::now();
+
+        auto start_select = clock_type::now();
+        for (auto r : ranks)
+        {
+            checksum -= counted.select(r)->first;
+        }
+        auto end_select = clock_type::now();
+
+        const double walk_us{elapsed_ms(start_walk, end_walk) * 1000 / queries};
+        const double select_us{elapsed_ms(start_select, end_select) * 1000 / queries};
+        file << nodes << "\t" << plain_build << "\t" << counted_build << "\t" << walk_us << "\t" << select_us << "\n";
+        std::cout << nodes << " nodes: build " << plain_build << " ms (counted " << counted_build << " ms), k-th key: walk "
+                  << walk_us << " us, select " << select_us << " us\n";
+    }
+    std::cout << "(checksum " << checksum << ", must be 0)\n";
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "../include/bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+#include <thread>
+
+/*
+ * Time to build a balanced red-black tree from n pairs in random order:
+ *  - n calls to insert
+ *  - the sequential range constructor (sort + O(n) build)
+ *  - the range constructor with parallel_build{t}, for t from 1 to hardware_concurrency()
+ *
+ * Compile with: g++ -O3 -std=c++14 -pthread parallel_build_tests.cpp -o parallel_build_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+using tree_type = bst<int, int, std::less<int>, red_black>;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+int main()
+{
+    std::ofstream file{"times_parallel_build.txt"};
+    file << "#n\tmethod\tthreads\tms\n";
+    const unsigned int cores{std::max(1u, std::thread::hardware_concurrency())};
+    for (int n : {1000000, 10000000, 50000000})
+    {
+        std::vector<std::pair<int, int>> pairs(n);
+        for (int i = 0; i < n; ++i)
+        {
+            pairs[i] = {i, i};
+        }
+        std::shuffle(pairs.begin(), pairs.end(), std::mt19937{42});
+
+        if (n <= 10000000)
+        {
+            auto start = clock_type::now();
+            tree_type tree{};
+            for (const auto &p : pairs)
+            {
+                tree.insert(std::pair<const int, int>{p.first, p.second});
+            }
+            auto end = clock_type::now();
+            file << n << "\tinsert\t1\t" << elapsed_ms(start, end) << "\n";
+            std::cout << n << " insert: " << elapsed_ms(start, end) << " ms\n";
+        }
+        {
+            auto start = clock_type::now();
+            tree_type tree{pairs.begin(), pairs.end()};
+            auto end = clock_type::now();
+            file << n << "\trange\t1\t" << elapsed_ms(start, end) << "\n";
+            std::cout << n << " range constructor: " << elapsed_ms(start, end) << " ms\n";
+        }
+        for (unsigned int threads = 1;; threads = std::min(2 * threads, cores)) //powers of two, then all the cores
+        {
+            auto start = clock_type::now();
+            tree_type tree{pairs.begin(), pairs.end(), parallel_build{threads}};
+            auto end = clock_type::now();
+            file << n << "\tparallel_build\t" << threads << "\t" << elapsed_ms(start, end) << "\n";
+            std::cout << n << " parallel_build{" << threads << "}: " << elapsed_ms(start, end) << " ms\n";
+            if (threads == cores)
+            {
+                break;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "../include/bst.h"
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Time-window queries "all the keys in [a, a + width)" on a red-black tree: a scan from begin()
+ * that filters every key, against range(a, a + width), which finds the first key with one
+ * descent and then visits only the matching Nodes.
+ *
+ * Compile with: g++ -O3 -std=c++14 range_tests.cpp -o range_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_us(clock_type::time_point start, clock_type::time_point end, int queries)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000.0 / queries;
+}
+
+int main()
+{
+    std::ofstream file{"times_range.txt"};
+    file << "#nodes\twidth\tscan_us\trange_us\n";
+    std::mt19937 gen{42};
+    long int checksum{0};
+    const int queries{200};
+
+    for (int nodes : {1000, 150000, 1000000})
+    {
+        std::vector<std::pair<int, int>> pairs(nodes);
+        for (int i = 0; i < nodes; ++i)
+        {
+            pairs[i] = {i, i};
+        }
+        const bst<int, int, std::less<int>, red_black> tree{sorted_unique, pairs.begin(), pairs.end()};
+        for (int width : {10, 1000})
+        {
+            std::uniform_int_distribution<int> dist{0, nodes - 1};
+            std::vector<int> starts(queries);
+            for (auto &a : starts)
+            {
+                a = dist(gen);
+            }
+
+            auto start_scan = clock_type::now();
+            for (auto a : starts)
+            {
+                for (const auto &p : tree)
+                {
+                    if (p.first >= a && p.first < a + width)
+                    {
+                        checksum += p.second;
+                    }
+                }
+            }
+            auto end_scan = clock_type::now();
+
+            auto start_range = clock_type::now();
+            for (auto a : starts)
+            {
+                for (const auto &p : tree.range(a, a + width))
+                {
+                    checksum -= p.second;
+                }
+            }
+            auto end_range = clock_type::now();
+
+            file << nodes << "\t" << width << "\t" << elapsed_us(start_scan, end_scan, queries) << "\t"
+                 << elapsed_us(start_range, end_range, queries) << "\n";
+            std::cout << nodes << " nodes, window " << width << ": scan " << elapsed_us(start_scan, end_scan, queries)
+                      << " us, range " << elapsed_us(start_range, end_range, queries) << " us per query\n";
+        }
+    }
+    std::cout << "(checksum " << checksum << ", must be 0)\n";
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "../include/bst.h"
+#include <chrono>
+#include <cstdio>  //std::remove
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Time to persist a red-black tree with n random int -> double pairs and to get it back:
+ *  - save(path), which writes the pairs in blocks through a checksummed stream
+ *  - load(path), which reads them and rebuilds a balanced tree in linear time
+ *  - rebuilding the tree with a loop of insert() from the same pairs, already in memory, for comparison
+ *
+ * Compile with: g++ -O3 -std=c++14 serialize_tests.cpp -o serialize_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e6;
+}
+
+int main()
+{
+    using tree_type = bst<int, double, std::less<int>, red_black>;
+    const std::string path{"serialize_tests.bin"};
+    std::ofstream file{"times_serialize.txt"};
+    file << "#n\tinsert_ms\tsave_ms\tload_ms\n";
+    std::mt19937 gen{42};
+    for (int n : {1000000, 10000000})
+    {
+        std::vector<std::pair<int, double>> pairs(n);
+        for (int i = 0; i < n; ++i)
+        {
+            pairs[i] = {static_cast<int>(gen()), i * 0.5};
+        }
+
+        auto start = clock_type::now();
+        tree_type tree{};
+        for (const auto &p : pairs)
+        {
+            tree.insert(std::pair<const int, double>{p.first, p.second});
+        }
+        const double insert_ms{elapsed_ms(start, clock_type::now())};
+
+        start = clock_type::now();
+        tree.save(path);
+        const double save_ms{elapsed_ms(start, clock_type::now())};
+
+        tree_type loaded{};
+        start = clock_type::now();
+        loaded.load(path);
+        const double load_ms{elapsed_ms(start, clock_type::now())};
+        std::remove(path.c_str());
+        if (loaded.size() != tree.size())
+        {
+            std::cout << "wrong size\n";
+        }
+
+        file << n << "\t" << insert_ms << "\t" << save_ms << "\t" << load_ms << "\n";
+        std::cout << n << " pairs: insert loop " << insert_ms << " ms, save " << save_ms << " ms, load " << load_ms << " ms\n";
+    }
+    return 0;
+}
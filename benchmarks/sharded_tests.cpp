@@ -0,0 +1,85 @@
+#include "../include/sharded_bst.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+ * Write scaling of sharded_bst: 1 to hardware_concurrency() threads insert 4M random keys in
+ * total, into a map with 1 shard (a single lock) and with 16 shards of equal key ranges.
+ * Then a 1M-key shard is split at its median while the map is idle.
+ *
+ * Compile with: g++ -O3 -std=c++14 -pthread sharded_tests.cpp -o sharded_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+const int total{4000000};
+const int max_key{1 << 30};
+
+double insert_ms(unsigned int shards, unsigned int threads, const std::vector<int> &keys)
+{
+    std::vector<int> splitters{};
+    for (unsigned int s = 1; s < shards; ++s)
+    {
+        splitters.push_back(static_cast<int>(static_cast<long int>(max_key) * s / shards));
+    }
+    sharded_bst<int, int> map{splitters};
+    auto start = clock_type::now();
+    std::vector<std::thread> workers{};
+    for (unsigned int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            for (std::size_t i = t; i < keys.size(); i += threads)
+            {
+                map.insert({keys[i], keys[i]});
+            }
+        });
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+    auto end = clock_type::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+int main()
+{
+    std::ofstream file{"times_sharded.txt"};
+    file << "#shards\tthreads\tinsert_ms\n";
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> dist{0, max_key - 1};
+    std::vector<int> keys(total);
+    for (auto &k : keys)
+    {
+        k = dist(gen);
+    }
+    const unsigned int cores{std::max(1u, std::thread::hardware_concurrency())};
+    for (unsigned int threads = 1;; threads = std::min(2 * threads, cores)) //powers of two, then all the cores
+    {
+        for (unsigned int shards : {1u, 16u})
+        {
+            const double ms{insert_ms(shards, threads, keys)};
+            file << shards << "\t" << threads << "\t" << ms << "\n";
+            std::cout << shards << " shards, " << threads << " threads: " << ms << " ms\n";
+        }
+        if (threads == cores)
+        {
+            break;
+        }
+    }
+
+    sharded_bst<int, int> map{};
+    for (int i = 0; i < 1000000; ++i)
+    {
+        map.insert({keys[i], i});
+    }
+    auto start = clock_type::now();
+    map.split_shard(0);
+    auto end = clock_type::now();
+    std::cout << "split of a 1M-key shard: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0 << " ms (" << map.shard_size(0) << " + " << map.shard_size(1) << ")\n";
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include "../include/snapshot_bst.h"
+#include <algorithm> //std::min
+#include <atomic>
+#include <chrono>
+#include <fstream> //to write on a file
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+ * Reader throughput with a writer running: 1 to hardware_concurrency() reader threads do random
+ * lookups on 1M keys for one second, while one writer keeps inserting and erasing random keys.
+ * A red-black bst guarded by a std::mutex is compared with a snapshot_bst, whose readers take
+ * a new snapshot every 100 lookups, and then before every lookup, which measures the cost of
+ * taking a snapshot.
+ *
+ * Compile with: g++ -O3 -std=c++14 -pthread snapshot_tests.cpp -o snapshot_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+const int n{1000000};
+
+struct locked_tree
+{
+    bst<int, int, std::less<int>, red_black> tree{};
+    std::mutex m{};
+
+    void insert(int k)
+    {
+        std::lock_guard<std::mutex> lock{m};
+        tree.insert(std::pair<const int, int>{k, k});
+    }
+    void erase(int k)
+    {
+        std::lock_guard<std::mutex> lock{m};
+        tree.erase(k);
+    }
+    long int read(std::mt19937 &gen)
+    {
+        std::uniform_int_distribution<int> dist{0, 2 * n - 1};
+        long int found{0};
+        for (int i = 0; i < 100; ++i)
+        {
+            std::lock_guard<std::mutex> lock{m};
+            auto it = tree.find(dist(gen));
+            found += it != tree.end();
+        }
+        return found;
+    }
+};
+
+struct rcu_tree
+{
+    snapshot_bst<int, int> tree{};
+
+    void insert(int k) { tree.insert({k, k}); }
+    void erase(int k) { tree.erase(k); }
+    long int read(std::mt19937 &gen)
+    {
+        std::uniform_int_distribution<int> dist{0, 2 * n - 1};
+        long int found{0};
+        auto s = tree.snapshot();
+        for (int i = 0; i < 100; ++i)
+        {
+            found += s.count(dist(gen));
+        }
+        return found;
+    }
+};
+
+struct rcu_tree_per_lookup : rcu_tree
+{
+    long int read(std::mt19937 &gen)
+    {
+        std::uniform_int_distribution<int> dist{0, 2 * n - 1};
+        long int found{0};
+        for (int i = 0; i < 100; ++i)
+        {
+            found += tree.snapshot().count(dist(gen));
+        }
+        return found;
+    }
+};
+
+template <typename Tree>
+void run(const char *name, unsigned int readers, std::ofstream &file)
+{
+    Tree t{};
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> dist{0, 2 * n - 1};
+    for (int i = 0; i < n; ++i)
+    {
+        t.insert(dist(gen));
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<long int> lookups{0};
+    std::atomic<long int> updates{0};
+    std::atomic<long int> hits{0};
+    std::thread writer{[&]() {
+        std::mt19937 g{7};
+        long int u{0};
+        while (!done)
+        {
+            t.insert(dist(g));
+            t.erase(dist(g));
+            u += 2;
+        }
+        updates = u;
+    }};
+    std::vector<std::thread> threads{};
+    for (unsigned int r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&, r]() {
+            std::mt19937 g{r};
+            long int l{0};
+            long int found{0};
+            while (!done)
+            {
+                found += t.read(g);
+                l += 100;
+            }
+            lookups += l;
+            hits += found;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds{1});
+    done = true;
+    writer.join();
+    for (auto &th : threads)
+    {
+        th.join();
+    }
+    file << name << "\t" << readers << "\t" << lookups / 1e6 << "\t" << updates / 1e3 << "\n";
+    std::cout << name << ", " << readers << " readers: " << lookups / 1e6 << "M lookups/s, " << updates / 1e3 << "k updates/s (" << hits << " hits)\n";
+}
+
+int main()
+{
+    std::ofstream file{"times_snapshot.txt"};
+    file << "#tree\treaders\tmillion_lookups_per_s\tthousand_updates_per_s\n";
+    const unsigned int cores{std::max(1u, std::thread::hardware_concurrency())};
+    for (unsigned int readers = 1;; readers = std::min(2 * readers, cores))
+    {
+        run<locked_tree>("mutex bst", readers, file);
+        run<rcu_tree>("snapshot_bst", readers, file);
+        run<rcu_tree_per_lookup>("snapshot_bst, a snapshot per lookup", readers, file);
+        if (readers == cores)
+        {
+            break;
+        }
+    }
+    return 0;
+}
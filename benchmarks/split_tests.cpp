@@ -0,0 +1,68 @@
+#include "../include/bst.h"
+#include <chrono>
+#include <fstream> //to write on a file
+
+/*
+ * Time to cut a tree with n keys at the key n * fraction, keeping the larger keys (e.g. to archive the oldest entries):
+ *  - erase(begin(), lower_bound(x)), which unlinks and frees the Nodes one by one
+ *  - split(x), which reuses the Nodes and needs the order_statistics policy
+ * and time to join the two halves back with join(). erase() runs on the tree without subtree sizes.
+ *
+ * Compile with: g++ -O3 -std=c++14 split_tests.cpp -o split_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e6;
+}
+
+template <typename Tree, typename Plain>
+void measure(std::ofstream &file, const char *name, const std::vector<std::pair<int, int>> &pairs, double fraction)
+{
+    const int n{static_cast<int>(pairs.size())};
+    const int x{static_cast<int>(n * fraction)};
+    double erase_ms, split_ms, join_ms;
+    {
+        Plain tree{sorted_unique, pairs.begin(), pairs.end()};
+        auto start = clock_type::now();
+        tree.erase(tree.cbegin(), tree.lower_bound(x));
+        erase_ms = elapsed_ms(start, clock_type::now());
+    }
+    {
+        Tree tree{sorted_unique, pairs.begin(), pairs.end()};
+        auto start = clock_type::now();
+        auto recent = tree.split(x);
+        split_ms = elapsed_ms(start, clock_type::now());
+        start = clock_type::now();
+        auto whole = join(std::move(tree), std::move(recent));
+        join_ms = elapsed_ms(start, clock_type::now());
+        if (whole.size() != pairs.size())
+        {
+            std::cout << "wrong size\n";
+        }
+    }
+    file << n << "\t" << fraction << "\t" << name << "\t" << erase_ms << "\t" << split_ms << "\t" << join_ms << "\n";
+    std::cout << n << " keys, cut at " << fraction << ", " << name << ": erase " << erase_ms << " ms, split " << split_ms << " ms, join " << join_ms << " ms\n";
+}
+
+int main()
+{
+    std::ofstream file{"times_split.txt"};
+    file << "#n\tfraction\tpolicy\terase_ms\tsplit_ms\tjoin_ms\n";
+    for (int n : {1000000, 10000000})
+    {
+        std::vector<std::pair<int, int>> pairs(n);
+        for (int i = 0; i < n; ++i)
+        {
+            pairs[i] = {i, i};
+        }
+        for (double fraction : {0.01, 0.1, 0.5})
+        {
+            measure<bst<int, int, std::less<int>, order_statistics<red_black>>, bst<int, int, std::less<int>, red_black>>(file, "red_black", pairs, fraction);
+            measure<bst<int, int, std::less<int>, order_statistics<avl>>, bst<int, int, std::less<int>, avl>>(file, "avl", pairs, fraction);
+        }
+    }
+    return 0;
+}
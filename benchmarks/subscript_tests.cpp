@@ -0,0 +1,42 @@
+#include "../include/bst.h"
+#include <chrono>
+#include <fstream> //to write on a file
+#include <random>
+
+/*
+ * Counters aggregation: ++tree[key] over a stream of 5M random keys drawn from n distinct ones,
+ * on a red-black tree. Every call to operator[] is a single descent that either finds the key
+ * or links a new Node where the descent stopped.
+ *
+ * Compile with: g++ -O3 -std=c++14 subscript_tests.cpp -o subscript_tests.x
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+int main()
+{
+    std::ofstream file{"times_subscript.txt"};
+    file << "#distinct_keys\tns_per_increment\n";
+    const int stream{5000000};
+    for (int distinct : {1000, 150000, 1000000})
+    {
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> dist{0, distinct - 1};
+        std::vector<int> keys(stream);
+        for (auto &k : keys)
+        {
+            k = dist(gen);
+        }
+        bst<int, long int, std::less<int>, red_black> counters{};
+        auto start = clock_type::now();
+        for (auto k : keys)
+        {
+            ++counters[k];
+        }
+        auto end = clock_type::now();
+        const double ns{std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(stream)};
+        file << distinct << "\t" << ns << "\n";
+        std::cout << distinct << " distinct keys: " << ns << " ns per increment (" << counters[0] << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "../include/bst.h"
+#include <chrono>
+#include <pthread.h>
+
+/*
+ * Destruction of a 10M-Node linked-list-shaped tree: iterative destruction (Node::destroy_subtree,
+ * the same algorithm used by bst::clear) against the old recursive one, which used to run through
+ * the unique_ptr destructors. The recursive version needs about one stack frame per Node, so it's
+ * run on a thread with a 4 GB stack; on the default 8 MB stack it overflows.
+ *
+ * Compile with: g++ -O3 -std=c++14 teardown_tests.cpp -o teardown_tests.x -pthread
+ */
+
+using clock_type = std::chrono::steady_clock;
+using node_type = Node<std::pair<const int, int>>;
+
+const int nodes{10000000};
+
+node_type *make_chain()
+{
+    auto head_node = new node_type{std::pair<const int, int>{0, 0}, nullptr};
+    auto last = head_node;
+    for (int i = 1; i < nodes; ++i)
+    {
+        last->right.reset(new node_type{std::pair<const int, int>{i, i}, last});
+        last = last->right.get();
+    }
+    return head_node;
+}
+
+/**
+ * @brief Post-order recursive destruction, as done before by the default destructor of Node.
+ */
+void recursive_delete(node_type *ptn)
+{
+    if (!ptn)
+    {
+        return;
+    }
+    recursive_delete(ptn->left.release());
+    recursive_delete(ptn->right.release());
+    delete ptn;
+}
+
+void *run_recursive(void *chain)
+{
+    recursive_delete(static_cast<node_type *>(chain));
+    return nullptr;
+}
+
+double elapsed_ms(clock_type::time_point start, clock_type::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+int main()
+{
+    auto chain = make_chain();
+    auto start_iterative = clock_type::now();
+    delete chain;
+    auto end_iterative = clock_type::now();
+    std::cout << "iterative: " << elapsed_ms(start_iterative, end_iterative) << " ms\n";
+
+    chain = make_chain();
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, std::size_t{1} << 32);
+    pthread_t thread;
+    auto start_recursive = clock_type::now();
+    if (pthread_create(&thread, &attributes, run_recursive, chain) != 0)
+    {
+        std::cout << "could not create a thread with a 4 GB stack\n";
+        return 1;
+    }
+    pthread_join(thread, nullptr);
+    auto end_recursive = clock_type::now();
+    pthread_attr_destroy(&attributes);
+    std::cout << "recursive: " << elapsed_ms(start_recursive, end_recursive) << " ms\n";
+    return 0;
+}
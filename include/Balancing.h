@@ -0,0 +1,668 @@
+#ifndef Balancing_h
+#define Balancing_h
+
+#include "Node.h"
+#include <algorithm> //std::max
+#include <type_traits>
+
+/**
+ * @brief Rotations shared by the balancing policies.
+ *
+ * All the functions work directly on the parent-linked @ref Node: the ownership of the children is moved between the `unique_ptr`s, so no @ref Node is ever copied or reallocated.
+ * @tparam Counts `std::true_type` if `Node::subtree_size` must be kept up to date. Otherwise @ref recount() and @ref recount_path() do nothing, so the rotations of the plain policies don't touch the sizes at all.
+ */
+template <typename Counts>
+struct basic_tree_rotations
+{
+    /**
+     * @brief Whether the policy keeps `Node::subtree_size` up to date. Only @ref order_statistics does.
+     */
+    using counts_subtrees = Counts;
+
+    template <typename N>
+    static unsigned int subtree_size(const N *n) noexcept
+    {
+        return n ? n->subtree_size : 0;
+    }
+
+    /**
+     * @brief Recomputes the size of the subtree rooted at n from the sizes of its children.
+     */
+    template <typename N>
+    static void recount(N *n) noexcept
+    {
+        if (!Counts::value)
+        {
+            return;
+        }
+        n->subtree_size = 1 + subtree_size(n->left.get()) + subtree_size(n->right.get());
+    }
+
+    /**
+     * @brief Recomputes the sizes from n up to the root.
+     */
+    template <typename N>
+    static void recount_path(N *n) noexcept
+    {
+        for (; Counts::value && n; n = n->parent)
+        {
+            recount(n);
+        }
+    }
+
+    /**
+     * @brief Makes left and right the children of middle, which must have none, and recomputes its size. Used by the `join()` of the policies.
+     */
+    template <typename N>
+    static void attach(N *middle, typename N::owner left, typename N::owner right) noexcept
+    {
+        if (left)
+        {
+            left->parent = middle;
+        }
+        if (right)
+        {
+            right->parent = middle;
+        }
+        middle->left.reset(left.release()); //middle keeps the deleters of its own links
+        middle->right.reset(right.release());
+        recount(middle);
+    }
+
+    /**
+     * @brief Returns the `unique_ptr` that owns a @ref Node: the head if the @ref Node has no parent, otherwise the left or right child of its parent.
+     * @param root Reference to the head of the tree
+     * @param n Raw pointer to the @ref Node
+     */
+    template <typename N>
+    static typename N::owner &owner(typename N::owner &root, N *n) noexcept
+    {
+        if (!n->parent)
+        {
+            return root;
+        }
+        return n == n->parent->left.get() ? n->parent->left : n->parent->right;
+    }
+
+    /**
+     * @brief Left rotation around x. The right child of x takes its place and x becomes its left child.
+     */
+    template <typename N>
+    static void rotate_left(typename N::owner &root, N *x) noexcept
+    {
+        auto &slot = owner(root, x);
+        typename N::owner y{std::move(x->right)};
+        x->right = std::move(y->left);
+        if (x->right)
+        {
+            x->right->parent = x;
+        }
+        y->parent = x->parent;
+        y->left = std::move(slot); //slot owned x
+        x->parent = y.get();
+        recount(x);
+        recount(y.get());
+        slot = std::move(y);
+    }
+
+    /**
+     * @brief Right rotation around x. The left child of x takes its place and x becomes its right child.
+     */
+    template <typename N>
+    static void rotate_right(typename N::owner &root, N *x) noexcept
+    {
+        auto &slot = owner(root, x);
+        typename N::owner y{std::move(x->left)};
+        x->left = std::move(y->right);
+        if (x->left)
+        {
+            x->left->parent = x;
+        }
+        y->parent = x->parent;
+        y->right = std::move(slot); //slot owned x
+        x->parent = y.get();
+        recount(x);
+        recount(y.get());
+        slot = std::move(y);
+    }
+};
+
+/**
+ * @brief The rotations of the policies that don't count the subtrees.
+ */
+using tree_rotations = basic_tree_rotations<std::false_type>;
+
+/**
+ * @brief Default policy: the tree is never rebalanced automatically, and it's up to the user to call `bst::balance()`.
+ */
+template <typename Counts = std::false_type>
+struct basic_unbalanced : basic_tree_rotations<Counts>
+{
+    using basic_tree_rotations<Counts>::attach;
+
+    /**
+     * @brief The same policy, keeping `Node::subtree_size` up to date. Used by @ref order_statistics.
+     */
+    using counted = basic_unbalanced<std::true_type>;
+
+    /**
+     * @brief Called after a new @ref Node n has been linked as a leaf.
+     */
+    template <typename N>
+    static void after_insert(typename N::owner &, N *) noexcept {}
+
+    /**
+     * @brief Called after a @ref Node has been unlinked from the tree.
+     * @param x The @ref Node that took the place of the removed one (possibly `nullptr`)
+     * @param x_parent The parent of x
+     * @param removed_data The `balance_data` of the @ref Node that has been physically removed from its position
+     */
+    template <typename N>
+    static void after_erase(typename N::owner &, N *, N *, int) noexcept {}
+
+    /**
+     * @brief Called after the whole shape of the tree has been rebuilt (e.g. by `bst::balance()`), to restore the bookkeeping of every @ref Node.
+     */
+    template <typename O>
+    static void after_rebuild(O &) noexcept {}
+
+    /**
+     * @brief Joins the trees rooted at left and right, whose keys are all less and all greater than the key of middle, into one tree rooted at middle. middle must have no children.
+     */
+    template <typename N>
+    static typename N::owner join(typename N::owner left, N *middle, typename N::owner right) noexcept
+    {
+        middle->parent = nullptr;
+        attach(middle, std::move(left), std::move(right));
+        return typename N::owner{middle, middle->left.get_deleter()};
+    }
+};
+
+using unbalanced = basic_unbalanced<>;
+
+/**
+ * @brief AVL policy: `balance_data` stores the height of the subtree rooted at each @ref Node, and the heights of the two children of any @ref Node differ at most by one.
+ */
+template <typename Counts = std::false_type>
+struct basic_avl : basic_tree_rotations<Counts>
+{
+    using basic_tree_rotations<Counts>::attach;
+    using basic_tree_rotations<Counts>::recount_path;
+    using basic_tree_rotations<Counts>::rotate_left;
+    using basic_tree_rotations<Counts>::rotate_right;
+    using counted = basic_avl<std::true_type>;
+
+    template <typename N>
+    static int height(const N *n) noexcept
+    {
+        return n ? n->balance_data : 0;
+    }
+
+    template <typename N>
+    static void update(N *n) noexcept
+    {
+        n->balance_data = 1 + std::max(height(n->left.get()), height(n->right.get()));
+    }
+
+    /**
+     * @brief Restores the AVL property at n with one or two rotations. Returns the new root of the subtree.
+     */
+    template <typename N>
+    static N *rebalance(typename N::owner &root, N *n) noexcept
+    {
+        update(n);
+        const int balance_factor{height(n->left.get()) - height(n->right.get())};
+        if (balance_factor > 1)
+        {
+            auto l = n->left.get();
+            if (height(l->left.get()) < height(l->right.get()))
+            { //left-right case
+                rotate_left(root, l);
+                update(l);
+            }
+            rotate_right(root, n);
+            update(n);
+            update(n->parent);
+            return n->parent;
+        }
+        if (balance_factor < -1)
+        {
+            auto r = n->right.get();
+            if (height(r->right.get()) < height(r->left.get()))
+            { //right-left case
+                rotate_right(root, r);
+                update(r);
+            }
+            rotate_left(root, n);
+            update(n);
+            update(n->parent);
+            return n->parent;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Walks up from n fixing heights and rotating where needed. It stops as soon as the height of a subtree is the same as before the update, since the ancestors are then unaffected.
+     */
+    template <typename N>
+    static void retrace(typename N::owner &root, N *n) noexcept
+    {
+        while (n)
+        {
+            const int old_height{n->balance_data};
+            auto top = rebalance(root, n);
+            if (top->balance_data == old_height)
+            {
+                return;
+            }
+            n = top->parent;
+        }
+    }
+
+    template <typename N>
+    static void after_insert(typename N::owner &root, N *n) noexcept
+    {
+        n->balance_data = 1;
+        retrace(root, n->parent);
+    }
+
+    template <typename N>
+    static void after_erase(typename N::owner &root, N *, N *x_parent, int) noexcept
+    {
+        retrace(root, x_parent);
+    }
+
+    template <typename O>
+    static void after_rebuild(O &root) noexcept
+    {
+        set_heights(root.get());
+    }
+
+    /**
+     * @brief Joins the trees rooted at left and right, whose keys are all less and all greater than the key of middle, with middle between them. Returns the root of the result.
+     * middle is linked where the inner spine of the taller tree reaches the height of the shorter one, and the heights are then fixed going up, so it costs O(1 + |height(left) - height(right)|).
+     */
+    template <typename N>
+    static typename N::owner join(typename N::owner left, N *middle, typename N::owner right) noexcept
+    {
+        const int left_height{height(left.get())};
+        const int right_height{height(right.get())};
+        if (left_height > right_height + 1)
+        { //middle replaces the first Node on the right spine of left that is not too tall
+            left->parent = nullptr;
+            auto p = left.get();
+            while (height(p->right.get()) > right_height + 1)
+            {
+                p = p->right.get();
+            }
+            attach(middle, std::move(p->right), std::move(right));
+            update(middle);
+            middle->parent = p;
+            p->right.reset(middle);
+            recount_path(p);
+            retrace(left, p);
+            return left;
+        }
+        if (right_height > left_height + 1)
+        { //symmetric, on the left spine of right
+            right->parent = nullptr;
+            auto p = right.get();
+            while (height(p->left.get()) > left_height + 1)
+            {
+                p = p->left.get();
+            }
+            attach(middle, std::move(left), std::move(p->left));
+            update(middle);
+            middle->parent = p;
+            p->left.reset(middle);
+            recount_path(p);
+            retrace(right, p);
+            return right;
+        }
+        middle->parent = nullptr;
+        attach(middle, std::move(left), std::move(right));
+        update(middle);
+        return typename N::owner{middle, middle->left.get_deleter()};
+    }
+
+private:
+    template <typename N>
+    static int set_heights(N *n) noexcept
+    {
+        if (!n)
+        {
+            return 0;
+        }
+        n->balance_data = 1 + std::max(set_heights(n->left.get()), set_heights(n->right.get()));
+        return n->balance_data;
+    }
+};
+
+using avl = basic_avl<>;
+
+/**
+ * @brief Red-black policy: `balance_data` stores the colour of each @ref Node. Missing children count as black.
+ */
+template <typename Counts = std::false_type>
+struct basic_red_black : basic_tree_rotations<Counts>
+{
+    using basic_tree_rotations<Counts>::attach;
+    using basic_tree_rotations<Counts>::recount_path;
+    using basic_tree_rotations<Counts>::rotate_left;
+    using basic_tree_rotations<Counts>::rotate_right;
+    using counted = basic_red_black<std::true_type>;
+
+    static constexpr int red = 0;
+    static constexpr int black = 1;
+
+    template <typename N>
+    static bool is_red(const N *n) noexcept
+    {
+        return n && n->balance_data == red;
+    }
+
+    template <typename N>
+    static void after_insert(typename N::owner &root, N *n) noexcept
+    {
+        n->balance_data = red;
+        while (is_red(n->parent))
+        {
+            auto p = n->parent;
+            auto g = p->parent; //exists, since the head is always black
+            if (p == g->left.get())
+            {
+                auto u = g->right.get();
+                if (is_red(u))
+                {
+                    p->balance_data = black;
+                    u->balance_data = black;
+                    g->balance_data = red;
+                    n = g;
+                }
+                else
+                {
+                    if (n == p->right.get())
+                    {
+                        n = p;
+                        rotate_left(root, n);
+                        p = n->parent;
+                    }
+                    p->balance_data = black;
+                    g->balance_data = red;
+                    rotate_right(root, g);
+                }
+            }
+            else
+            {
+                auto u = g->left.get();
+                if (is_red(u))
+                {
+                    p->balance_data = black;
+                    u->balance_data = black;
+                    g->balance_data = red;
+                    n = g;
+                }
+                else
+                {
+                    if (n == p->left.get())
+                    {
+                        n = p;
+                        rotate_right(root, n);
+                        p = n->parent;
+                    }
+                    p->balance_data = black;
+                    g->balance_data = red;
+                    rotate_left(root, g);
+                }
+            }
+        }
+        root->balance_data = black;
+    }
+
+    template <typename N>
+    static void after_erase(typename N::owner &root, N *x, N *x_parent, int removed_data) noexcept
+    {
+        if (removed_data != black)
+        {
+            return; //removing a red Node doesn't change any black height
+        }
+        while (x != root.get() && !is_red(x))
+        {
+            if (x == x_parent->left.get())
+            {
+                auto w = x_parent->right.get();
+                if (is_red(w))
+                {
+                    w->balance_data = black;
+                    x_parent->balance_data = red;
+                    rotate_left(root, x_parent);
+                    w = x_parent->right.get();
+                }
+                if (!is_red(w->left.get()) && !is_red(w->right.get()))
+                {
+                    w->balance_data = red;
+                    x = x_parent;
+                    x_parent = x->parent;
+                }
+                else
+                {
+                    if (!is_red(w->right.get()))
+                    {
+                        w->left->balance_data = black;
+                        w->balance_data = red;
+                        rotate_right(root, w);
+                        w = x_parent->right.get();
+                    }
+                    w->balance_data = x_parent->balance_data;
+                    x_parent->balance_data = black;
+                    w->right->balance_data = black;
+                    rotate_left(root, x_parent);
+                    x = root.get();
+                }
+            }
+            else
+            {
+                auto w = x_parent->left.get();
+                if (is_red(w))
+                {
+                    w->balance_data = black;
+                    x_parent->balance_data = red;
+                    rotate_right(root, x_parent);
+                    w = x_parent->left.get();
+                }
+                if (!is_red(w->left.get()) && !is_red(w->right.get()))
+                {
+                    w->balance_data = red;
+                    x = x_parent;
+                    x_parent = x->parent;
+                }
+                else
+                {
+                    if (!is_red(w->left.get()))
+                    {
+                        w->right->balance_data = black;
+                        w->balance_data = red;
+                        rotate_left(root, w);
+                        w = x_parent->left.get();
+                    }
+                    w->balance_data = x_parent->balance_data;
+                    x_parent->balance_data = black;
+                    w->left->balance_data = black;
+                    rotate_right(root, x_parent);
+                    x = root.get();
+                }
+            }
+        }
+        if (x)
+        {
+            x->balance_data = black;
+        }
+    }
+
+    /**
+     * @brief A tree rebuilt by `bst::balance()` has all its leaves on the last two levels: colouring the deepest level in red and everything else in black gives a valid red-black tree.
+     */
+    template <typename O>
+    static void after_rebuild(O &root) noexcept
+    {
+        paint(root.get(), 1, depth(root.get()));
+    }
+
+    /**
+     * @brief Joins the trees rooted at left and right, whose keys are all less and all greater than the key of middle, with middle between them. Returns the root of the result.
+     * The two roots are painted black. middle is then linked, red, in place of the first black Node on the inner spine of the tree with more black levels that has as many as the other tree, and the red-red conflicts are fixed as after an insertion: it costs O(1 + |height(left) - height(right)|), plus the O(height) needed to count the black levels.
+     */
+    template <typename N>
+    static typename N::owner join(typename N::owner left, N *middle, typename N::owner right) noexcept
+    {
+        for (auto root : {left.get(), right.get()})
+        {
+            if (root)
+            {
+                root->parent = nullptr;
+                root->balance_data = black;
+            }
+        }
+        const int left_black{black_height(left.get())};
+        const int right_black{black_height(right.get())};
+        if (left_black > right_black)
+        {
+            auto p = left.get();
+            int p_black{left_black}; //black levels from p down
+            while (is_red(p->right.get()) || p_black - !is_red(p) > right_black)
+            {
+                p_black -= !is_red(p);
+                p = p->right.get();
+            }
+            attach(middle, std::move(p->right), std::move(right));
+            middle->parent = p;
+            p->right.reset(middle);
+            recount_path(p);
+            after_insert(left, middle);
+            return left;
+        }
+        if (right_black > left_black)
+        {
+            auto p = right.get();
+            int p_black{right_black};
+            while (is_red(p->left.get()) || p_black - !is_red(p) > left_black)
+            {
+                p_black -= !is_red(p);
+                p = p->left.get();
+            }
+            attach(middle, std::move(left), std::move(p->left));
+            middle->parent = p;
+            p->left.reset(middle);
+            recount_path(p);
+            after_insert(right, middle);
+            return right;
+        }
+        middle->parent = nullptr;
+        middle->balance_data = black;
+        attach(middle, std::move(left), std::move(right));
+        return typename N::owner{middle, middle->left.get_deleter()};
+    }
+
+private:
+    /**
+     * @brief Number of black Nodes on the path from n to its leftmost leaf, which is the same on every path to a leaf.
+     */
+    template <typename N>
+    static int black_height(const N *n) noexcept
+    {
+        int h{0};
+        for (; n; n = n->left.get())
+        {
+            h += !is_red(n);
+        }
+        return h;
+    }
+
+    template <typename N>
+    static int depth(const N *n) noexcept
+    {
+        return n ? 1 + std::max(depth(n->left.get()), depth(n->right.get())) : 0;
+    }
+
+    template <typename N>
+    static void paint(N *n, int level, int deepest) noexcept
+    {
+        if (!n)
+        {
+            return;
+        }
+        n->balance_data = (level == deepest && level > 1) ? red : black;
+        paint(n->left.get(), level + 1, deepest);
+        paint(n->right.get(), level + 1, deepest);
+    }
+};
+
+template <typename Counts>
+constexpr int basic_red_black<Counts>::red;
+template <typename Counts>
+constexpr int basic_red_black<Counts>::black;
+
+using red_black = basic_red_black<>;
+
+/**
+ * @brief Augmentation of another policy that keeps in every @ref Node the size of its subtree, e.g. `bst<int, int, std::less<int>, order_statistics<red_black>>`. It enables `bst::rank()`, `bst::select()` and `bst::sample()` in O(height).
+ *
+ * The sizes are fixed on the path from the modified @ref Node to the root before the fixup of Base runs, and the rotations keep them up to date on their own. Base must name its counting variant as `Base::counted`; the plain policies don't pay for the sizes.
+ */
+template <typename Base = unbalanced>
+struct order_statistics : Base::counted
+{
+    using policy = typename Base::counted;
+
+    /**
+     * @brief Recomputes the sizes of all the Nodes with an iterative post-order visit, following the parent pointers.
+     */
+    template <typename N>
+    static void recount_all(N *root) noexcept
+    {
+        N *n{root};
+        const N *previous{root ? root->parent : nullptr};
+        while (n)
+        {
+            if (previous == n->parent && (n->left || n->right))
+            { //coming from above: go down
+                previous = n;
+                n = n->left ? n->left.get() : n->right.get();
+            }
+            else if (previous == n->left.get() && previous && n->right)
+            { //coming from the left subtree: visit the right one
+                previous = n;
+                n = n->right.get();
+            }
+            else
+            { //both subtrees are done
+                policy::recount(n);
+                previous = n;
+                n = n == root ? nullptr : n->parent;
+            }
+        }
+    }
+
+    template <typename N>
+    static void after_insert(typename N::owner &root, N *n) noexcept
+    {
+        policy::recount_path(n->parent);
+        policy::after_insert(root, n);
+    }
+
+    template <typename N>
+    static void after_erase(typename N::owner &root, N *x, N *x_parent, int removed_data) noexcept
+    {
+        policy::recount_path(x_parent); //the Node that took the place of the removed one, if any, is on this path
+        policy::after_erase(root, x, x_parent, removed_data);
+    }
+
+    template <typename O>
+    static void after_rebuild(O &root) noexcept
+    {
+        policy::after_rebuild(root);
+        recount_all(root.get());
+    }
+};
+
+#endif /* Balancing_h */
@@ -2,30 +2,52 @@
 #define Iterator_h
 
 #include "Node.h"
+#include <cstddef>
 #include <iterator>
+#include <type_traits>
 #include <utility>
 
-template <typename T, bool is_const = true>
+/**
+ * @brief Header of a tree, shared by all its iterators. It caches the leftmost and rightmost Nodes, so that `begin()` is O(1) and the past-the-end iterator can be decremented, and the number of Nodes.
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+struct tree_header
+{
+    /** @brief Raw pointer to the @ref Node with the smallest key, `nullptr` if the tree is empty*/
+    Node<T, Alloc> *leftmost;
+    /** @brief Raw pointer to the @ref Node with the largest key, `nullptr` if the tree is empty*/
+    Node<T, Alloc> *rightmost;
+    /** @brief Number of Nodes in the tree*/
+    std::size_t count;
+};
+
+template <typename T, bool is_const = true, typename Alloc = std::allocator<T>>
 class _iterator
 {
-    using nodeT = Node<T>; //for the sake of readability. T will be pair_type
+    using nodeT = Node<T, Alloc>; //for the sake of readability. T will be pair_type
+    using headerT = tree_header<T, Alloc>;
     /**
      * @brief Raw pointer to the current @ref Node
      */
 private:
     nodeT *current;
 
+    /**
+     * @brief Raw pointer to the header of the tree. The past-the-end iterator has `current == nullptr` and uses it to go back to the last @ref Node.
+     */
+    const headerT *header;
+
 public:
-    friend _iterator<T, true>;
-    friend _iterator<T, false>;
+    friend _iterator<T, true, Alloc>;
+    friend _iterator<T, false, Alloc>;
 
-    template <typename key_type, typename value_type, typename OP>
+    template <typename key_type, typename value_type, typename OP, typename Balance, typename A>
     friend class bst;
 
     using value_type = typename std::conditional<is_const, const T, T>::type;
     using reference = typename std::conditional<is_const, const T &, T &>::type;
     using pointer = typename std::conditional<is_const, const T *, T *>::type;
-    using iterator_category = std::forward_iterator_tag;
+    using iterator_category = std::bidirectional_iterator_tag;
     using difference_type = std::ptrdiff_t;
 
     /**
@@ -34,7 +56,20 @@ public:
      *
      * Construct a new @ref _iterator that refers to @ref Node pn
      */
-    explicit _iterator(nodeT *pn) noexcept : current{pn} {}
+    explicit _iterator(nodeT *pn) noexcept : current{pn}, header{nullptr} {}
+
+    /**
+     * @brief Custom constructor for @ref iterator
+     * @param pn Raw pointer to a @ref Node, `nullptr` for the past-the-end iterator
+     * @param h Raw pointer to the header of the tree
+     */
+    _iterator(nodeT *pn, const headerT *h) noexcept : current{pn}, header{h} {}
+
+    /**
+     * @brief Conversion from a non-constant @ref iterator to a constant one, as for the iterators of the standard containers
+     */
+    template <bool other_const, typename = typename std::enable_if<is_const && !other_const>::type>
+    _iterator(const _iterator<T, other_const, Alloc> &other) noexcept : current{other.current}, header{other.header} {}
 
     /**
      * @brief Default-generated constructor
@@ -110,6 +145,45 @@ public:
         ++(*this);
         return tmp;
     }
+    /**
+     * @brief Pre-decrement operator: goes to the previous (ordering by key) @ref Node.
+     * Decrementing the past-the-end iterator gives the last @ref Node of the tree.
+     */
+    _iterator &operator--() noexcept
+    {
+        if (!current)
+        {
+            current = header ? header->rightmost : nullptr;
+        }
+        else if (current->left)
+        {                                  //has left child
+            current = current->left.get(); //go left
+            while (current->right)
+            { //keep descending on the right subtree to find the previous value
+                current = current->right.get();
+            }
+        }
+        else
+        { //no left child
+            while (current->parent && current == current->parent->left.get())
+            {
+                current = current->parent;
+            }
+            current = current->parent;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Post-decrement operator.
+     */
+    _iterator operator--(int)
+    {
+        auto tmp{*this};
+        --(*this);
+        return tmp;
+    }
+
     /**
      * @brief Equality operator
      *
@@ -123,7 +197,7 @@ public:
     //        }
 
     template <bool constBool>
-    bool operator==(const _iterator<T, constBool> &candidate) const noexcept
+    bool operator==(const _iterator<T, constBool, Alloc> &candidate) const noexcept
     {
         return current == candidate.current;
     }
@@ -134,7 +208,7 @@ public:
      * To avoid code duplication, use the logical negation of `==` operator.
      */
     template <bool constBool>
-    bool operator!=(const _iterator<T, constBool> &candidate) const noexcept { return !(current == candidate.current); }
+    bool operator!=(const _iterator<T, constBool, Alloc> &candidate) const noexcept { return !(current == candidate.current); }
 
     /**
     * @brief Print a @ref Node by using the knowledge of the raw pointer `current`
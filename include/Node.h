@@ -4,73 +4,195 @@
 
 #include <iostream>
 #include <memory>
+#include <new> //placement new
+#include <type_traits>
+#include <utility>
 
-template <typename T>
+/**
+ * @brief Deleter of the `unique_ptr`s that own the Nodes: destroys and deallocates a @ref Node with the allocator it comes from, rebound to the type of the Node.
+ * It derives from the allocator, so that it takes no room when the allocator is stateless (e.g. `std::allocator`). A `pool_allocator` only needs a pointer to its arena, see NodePool.h.
+ */
+template <typename N, typename Alloc>
+struct node_deleter : std::allocator_traits<Alloc>::template rebind_alloc<N>
+{
+    using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<N>;
+
+    node_deleter() = default;
+
+    node_deleter(const allocator_type &a) noexcept : allocator_type(a) {}
+
+    node_deleter(const node_deleter &) = default;
+
+    /**
+     * @brief Copy assignment, used when a `unique_ptr` is moved into a link. Allocators that can't be assigned (e.g. `std::pmr::polymorphic_allocator`) are rebuilt as copies of the other one.
+     */
+    node_deleter &operator=(const node_deleter &other) noexcept
+    {
+        if (this != &other)
+        {
+            assign_helper(other, std::is_copy_assignable<allocator_type>{});
+        }
+        return *this;
+    }
+
+    void operator()(N *p) noexcept
+    {
+        allocator_type &a{*this};
+        std::allocator_traits<allocator_type>::destroy(a, p);
+        std::allocator_traits<allocator_type>::deallocate(a, p, 1);
+    }
+
+private:
+    void assign_helper(const node_deleter &other, std::true_type) noexcept
+    {
+        static_cast<allocator_type &>(*this) = other;
+    }
+
+    void assign_helper(const node_deleter &other, std::false_type) noexcept
+    {
+        this->~node_deleter();
+        ::new (static_cast<void *>(this)) node_deleter(other);
+    }
+};
+
+template <typename T, typename Alloc = std::allocator<T>>
 struct Node{
+    /** @brief Deleter of the children: the Nodes are given back to the allocator they come from, never to `delete`*/
+    using deleter_type = node_deleter<Node, Alloc>;
+
+    /** @brief Type of the pointers that own the children (and the head of a tree)*/
+    using owner = std::unique_ptr<Node, deleter_type>;
+
     /** @brief Data to be stored in the Node*/
     T data;
     /** @brief Unique pointer to the left child*/
-    std::unique_ptr<Node<T>> left;
+    owner left;
     
     /** @brief Unique pointer to the right child*/
-    std::unique_ptr<Node<T>> right;
+    owner right;
     
     /**@brief Raw pointer to the parent @ref Node*/
-    Node<T>* parent;
+    Node* parent;
+
+    /**@brief Bookkeeping used by the balancing policy of the tree: the height for @ref avl, the colour for @ref red_black. Unused by @ref unbalanced*/
+    int balance_data;
+
+    /**@brief Number of Nodes in the subtree rooted here, kept up to date only by the @ref order_statistics policy (32 bits, so that it fits in the padding after @ref balance_data)*/
+    unsigned int subtree_size;
     
     /**
      @brief Custom constructor
     */
   
-    explicit Node(const T& _data): data{_data}, left{nullptr}, right{nullptr},parent{nullptr}{}
+    explicit Node(const T& _data): data{_data}, left{nullptr}, right{nullptr},parent{nullptr},balance_data{0},subtree_size{1}{}
 
     /**
      @brief Default constructor
      */
-    Node(): data{},left{nullptr}, right{nullptr},parent{nullptr}{}
+    Node(): data{},left{nullptr}, right{nullptr},parent{nullptr},balance_data{0},subtree_size{1}{}
     
     /**
-     * @brief Default-generated destructor
+     * @brief Destructor. The subtrees are destroyed iteratively by @ref destroy_subtree(), so that the stack usage doesn't depend on the shape of the tree.
      */
     
-    ~Node()=default;
+    ~Node() noexcept {
+        destroy_subtree(left.release(), left.get_deleter());
+        destroy_subtree(right.release(), right.get_deleter());
+    }
+
+    /**
+     * @brief Destroys all the Nodes of the subtree rooted at ptn with constant stack usage.
+     * @param ptn Raw pointer to the root of the subtree, already released by its owner
+     * @param d The deleter of its owner
+     * While the current @ref Node has a left child, a right rotation moves the child up; when it has none, the @ref Node is destroyed (after releasing its right child) and we move on to the right. Every @ref Node is rotated at most once, so this is O(n).
+     */
+    static void destroy_subtree(Node* ptn, deleter_type &d) noexcept {
+        while (ptn) {
+            if (ptn->left) {
+                auto l = ptn->left.release();
+                ptn->left.reset(l->right.release());
+                l->right.reset(ptn);
+                ptn = l;
+            } else {
+                auto r = ptn->right.release();
+                d(ptn); //no children left, its destructor doesn't recurse
+                ptn = r;
+            }
+        }
+    }
     
     /**
      @brief Copy constructor
      */
     
-    Node(const T& _data, Node<T>* _parent) noexcept:
+    Node(const T& _data, Node* _parent) noexcept:
         data{_data},
         left{nullptr},
         right{nullptr},
-        parent{_parent} {}
+        parent{_parent},
+        balance_data{0},
+        subtree_size{1} {}
 
     
     /**
-     * @brief Helper recursive function that, starting from a @ref Node and its parent, copy all the tree recursively.
-     * @param ptn Reference to a `unique_ptr` to a @ref Node
+     * @brief Deep copy of the subtree rooted at ptn, which becomes the subtree rooted at this @ref Node.
+     * @param ptn Reference to a `unique_ptr` to a @ref Node, which must not be empty
      * @param _parent Raw pointer to the parent @ref Node
-     * This function exploit the `std::make_unique()` function, to construct an object of type @ref Node and wraps it into a `unique_ptr`.
+     * The source is visited in pre-order by following the parent pointers, so the stack usage is constant whatever the shape of the tree. If a copy throws, the Nodes copied so far are destroyed with the `unique_ptr`s that own them.
+     * The new Nodes are allocated with `new`, so it's only available with the default allocator.
      */
-    Node(const std::unique_ptr<Node<T>> &ptn, Node<T> *_parent) : data{ptn->data}, parent{_parent}
+    template <typename D>
+    Node(const std::unique_ptr<Node, D> &ptn, Node *_parent) : data{ptn->data}, left{nullptr}, right{nullptr}, parent{_parent}, balance_data{ptn->balance_data}, subtree_size{ptn->subtree_size}
     {
-        if(ptn->right){
-            right = std::make_unique<Node<T>>(ptn->right, this);
-        }
-        if(ptn->left){
-            left = std::make_unique<Node<T>>(ptn->left, this);
+        static_assert(std::is_same<Alloc, std::allocator<T>>::value, "the deep copy of a Node allocates with new");
+        const Node* src{ptn.get()};
+        Node* dst{this};
+        while (true) {
+            if (src->left && !dst->left) {
+                dst->left.reset(new Node{src->left->data, dst});
+                dst->left->balance_data = src->left->balance_data;
+                dst->left->subtree_size = src->left->subtree_size;
+                src = src->left.get();
+                dst = dst->left.get();
+            } else if (src->right && !dst->right) {
+                dst->right.reset(new Node{src->right->data, dst});
+                dst->right->balance_data = src->right->balance_data;
+                dst->right->subtree_size = src->right->subtree_size;
+                src = src->right.get();
+                dst = dst->right.get();
+            } else if (dst == this) {
+                break; //both subtrees have been copied
+            } else { //go back up
+                src = src->parent;
+                dst = dst->parent;
+            }
         }
     }
 
     /**
-     @brief Move constructor
+     @brief Move constructor: the data is moved (not copied) into the @ref Node
      */
 
-    // Node(const T&& _data, Node<T>* _parent) noexcept:
-    //     data{std::move(_data)},
-    //     left{nullptr},
-    //     right{nullptr},
-    //     parent{_parent} {}
+    Node(T&& _data, Node* _parent):
+        data{std::move(_data)},
+        left{nullptr},
+        right{nullptr},
+        parent{_parent},
+        balance_data{0},
+        subtree_size{1} {}
+
+    /**
+     @brief Forwarding constructor: the data is constructed in place from args, which are never copied
+     */
+
+    template <typename... Args>
+    explicit Node(Node* _parent, Args&&... args):
+        data(std::forward<Args>(args)...),
+        left{nullptr},
+        right{nullptr},
+        parent{_parent},
+        balance_data{0},
+        subtree_size{1} {}
 
     /**
      @brief Simple void function that prints a @ref Node. Used just for testing.
@@ -0,0 +1,271 @@
+#ifndef NodePool_h
+#define NodePool_h
+
+#include "Node.h"
+#include <cstddef>  //std::max_align_t
+#include <memory>   //std::shared_ptr
+#include <new>      //::operator new
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Arena that hands out fixed-size blocks carved from contiguous chunks.
+ *
+ * The block size is fixed by the first allocation. Freed blocks are kept in an intrusive free list and reused, while the chunks are returned to the system only by @ref release() or by the destructor.
+ */
+class node_arena
+{
+    /**
+     * @brief Blocks that have been freed, linked through their first bytes.
+     */
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    std::size_t block_size;
+    std::size_t blocks_per_chunk;
+    std::vector<void *> chunks;
+    free_block *free_list;
+    unsigned char *cursor;    //next never-used block of the last chunk
+    unsigned char *chunk_end; //one-past-the-end of the last chunk
+
+    void add_chunk(std::size_t blocks)
+    {
+        chunks.reserve(chunks.size() + 1); //if this throws, no chunk is leaked
+        auto chunk = static_cast<unsigned char *>(::operator new(block_size * blocks));
+        chunks.push_back(chunk);
+        cursor = chunk;
+        chunk_end = chunk + block_size * blocks;
+    }
+
+public:
+    /**
+     * @brief Custom constructor
+     * @param _blocks_per_chunk Number of blocks allocated with every call to `::operator new`
+     */
+    explicit node_arena(std::size_t _blocks_per_chunk = 1024) noexcept
+        : block_size{0}, blocks_per_chunk{_blocks_per_chunk ? _blocks_per_chunk : 1}, chunks{}, free_list{nullptr}, cursor{nullptr}, chunk_end{nullptr} {}
+
+    node_arena(const node_arena &) = delete;
+    node_arena &operator=(const node_arena &) = delete;
+
+    ~node_arena() noexcept { release(); }
+
+    /**
+     * @brief Returns true if a block of `size` bytes aligned to `alignment` can be served by the arena.
+     */
+    bool fits(std::size_t size, std::size_t alignment) const noexcept
+    {
+        return alignment <= alignof(std::max_align_t) && (block_size == 0 || rounded(size) == block_size);
+    }
+
+    /**
+     * @brief Returns a block, reusing a freed one if possible.
+     */
+    void *allocate(std::size_t size)
+    {
+        if (block_size == 0)
+        {
+            block_size = rounded(size);
+        }
+        if (free_list)
+        {
+            auto block = free_list;
+            free_list = free_list->next;
+            return block;
+        }
+        if (cursor == chunk_end)
+        {
+            add_chunk(blocks_per_chunk);
+        }
+        auto block = cursor;
+        cursor += block_size;
+        return block;
+    }
+
+    /**
+     * @brief Makes sure that the next n blocks of `size` bytes can be carved, in order, from a single contiguous chunk (freed blocks are still handed out first).
+     * The unused tail of the current chunk (if any) is left aside until @ref release().
+     */
+    void reserve(std::size_t n, std::size_t size)
+    {
+        if (block_size == 0)
+        {
+            block_size = rounded(size);
+        }
+        if (static_cast<std::size_t>(chunk_end - cursor) < n * block_size)
+        {
+            add_chunk(n > blocks_per_chunk ? n : blocks_per_chunk);
+        }
+    }
+
+    /**
+     * @brief Gives back a block to the arena. The memory is not returned to the system.
+     */
+    void deallocate(void *p) noexcept
+    {
+        auto block = static_cast<free_block *>(p);
+        block->next = free_list;
+        free_list = block;
+    }
+
+    /**
+     * @brief Frees all the chunks at once. Every block handed out so far becomes invalid.
+     */
+    void release() noexcept
+    {
+        for (auto chunk : chunks)
+        {
+            ::operator delete(chunk);
+        }
+        chunks.clear();
+        free_list = nullptr;
+        cursor = chunk_end = nullptr;
+    }
+
+    /**
+     * @brief Number of chunks currently owned by the arena.
+     */
+    std::size_t chunk_count() const noexcept { return chunks.size(); }
+
+    std::size_t chunk_capacity() const noexcept { return blocks_per_chunk; }
+
+private:
+    static std::size_t rounded(std::size_t size) noexcept
+    {
+        const std::size_t a{alignof(std::max_align_t)};
+        size = size < sizeof(free_block) ? sizeof(free_block) : size;
+        return (size + a - 1) / a * a;
+    }
+};
+
+/**
+ * @brief Allocator compatible with `std::allocator_traits` that serves single objects from a shared @ref node_arena.
+ *
+ * Copies of the allocator (including rebound ones) share the same arena. Requests for more than one object, or for over-aligned types, fall back to `::operator new`.
+ * A tree copy-constructed from a tree using this allocator gets a fresh arena.
+ */
+template <typename T>
+class pool_allocator
+{
+    template <typename U>
+    friend class pool_allocator;
+
+    template <typename N, typename Alloc>
+    friend struct node_deleter;
+
+    std::shared_ptr<node_arena> arena;
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    /**
+     * @brief Default constructor: creates a new arena.
+     */
+    pool_allocator() : arena{std::make_shared<node_arena>()} {}
+
+    /**
+     * @brief Custom constructor
+     * @param blocks_per_chunk Number of objects allocated at once by the arena
+     */
+    explicit pool_allocator(std::size_t blocks_per_chunk) : arena{std::make_shared<node_arena>(blocks_per_chunk)} {}
+
+    /**
+     * @brief Rebinding constructor: shares the arena of other.
+     */
+    template <typename U>
+    pool_allocator(const pool_allocator<U> &other) noexcept : arena{other.arena} {}
+
+    T *allocate(std::size_t n)
+    {
+        if (n == 1 && arena->fits(sizeof(T), alignof(T)))
+        {
+            return static_cast<T *>(arena->allocate(sizeof(T)));
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+        if (n == 1 && arena->fits(sizeof(T), alignof(T)))
+        {
+            arena->deallocate(p);
+        }
+        else
+        {
+            ::operator delete(p);
+        }
+    }
+
+    /**
+     * @brief Preallocates room for n objects in one contiguous chunk. Used by the copy constructor of `bst`.
+     */
+    void reserve(std::size_t n)
+    {
+        if (arena->fits(sizeof(T), alignof(T)))
+        {
+            arena->reserve(n, sizeof(T));
+        }
+    }
+
+    pool_allocator select_on_container_copy_construction() const
+    {
+        return pool_allocator{arena->chunk_capacity()};
+    }
+
+    /**
+     * @brief Frees every chunk of the arena at once, provided that this allocator is the only one using it. Returns true if the memory has been released.
+     * Used by `bst::clear()` to tear down a tree in O(number of chunks).
+     */
+    bool release() noexcept
+    {
+        if (arena.use_count() != 1)
+        {
+            return false;
+        }
+        arena->release();
+        return true;
+    }
+
+    /**
+     * @brief The underlying arena, e.g. to inspect how many chunks have been allocated.
+     */
+    const node_arena &resource() const noexcept { return *arena; }
+
+    template <typename U>
+    bool operator==(const pool_allocator<U> &other) const noexcept { return arena == other.arena; }
+
+    template <typename U>
+    bool operator!=(const pool_allocator<U> &other) const noexcept { return arena != other.arena; }
+};
+
+/**
+ * @brief Deleter of the Nodes allocated by a @ref pool_allocator. It keeps a raw pointer to the arena instead of a copy of the allocator, which would cost a `shared_ptr` in every link of the tree: the arena outlives the Nodes, since the tree holds the allocator.
+ */
+template <typename N, typename U>
+struct node_deleter<N, pool_allocator<U>>
+{
+    node_arena *arena;
+
+    node_deleter() noexcept : arena{nullptr} {}
+
+    node_deleter(const pool_allocator<N> &a) noexcept : arena{a.arena.get()} {}
+
+    void operator()(N *p) noexcept
+    {
+        p->~N();
+        if (arena->fits(sizeof(N), alignof(N))) //as in pool_allocator::deallocate()
+        {
+            arena->deallocate(p);
+        }
+        else
+        {
+            ::operator delete(p);
+        }
+    }
+};
+
+#endif /* NodePool_h */
@@ -0,0 +1,276 @@
+#ifndef Serializer_h
+#define Serializer_h
+
+#include <algorithm> //std::min
+#include <cstddef>   //std::size_t
+#include <cstdint>   //std::uint64_t
+#include <cstring>   //std::memcpy
+#include <istream>
+#include <ostream>
+#include <stdexcept> //std::runtime_error
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief 64-bit checksum of a stream of bytes: FNV-1a applied to 8-byte words, so that it runs at memory speed. The result doesn't depend on how the bytes are split among the calls to @ref update().
+ */
+class stream_checksum
+{
+    std::uint64_t hash;
+    unsigned char pending[8]; //bytes of the last, incomplete word
+    std::size_t filled;
+
+    void mix(const unsigned char *word) noexcept
+    {
+        std::uint64_t w;
+        std::memcpy(&w, word, 8);
+        hash = (hash ^ w) * 0x100000001b3ULL;
+    }
+
+public:
+    stream_checksum() noexcept : hash{0xcbf29ce484222325ULL}, pending{}, filled{0} {}
+
+    void update(const void *data, std::size_t n) noexcept
+    {
+        auto p = static_cast<const unsigned char *>(data);
+        for (; n && filled; --n)
+        {
+            pending[filled++] = *p++;
+            if (filled == 8)
+            {
+                mix(pending);
+                filled = 0;
+            }
+        }
+        for (; n >= 8; n -= 8, p += 8)
+        {
+            mix(p);
+        }
+        for (; n; --n)
+        {
+            pending[filled++] = *p++;
+        }
+    }
+
+    /**
+     * @brief The checksum of the bytes seen so far, including the incomplete word and its length.
+     */
+    std::uint64_t value() const noexcept
+    {
+        unsigned char last[8]{};
+        std::memcpy(last, pending, filled);
+        std::uint64_t w;
+        std::memcpy(&w, last, 8);
+        return ((hash ^ w) * 0x100000001b3ULL) ^ filled;
+    }
+};
+
+/**
+ * @brief Output side of `bst::save()`: writes bytes to a stream and keeps their checksum. Serializers write through it.
+ */
+class serial_writer
+{
+    std::ostream &os;
+    stream_checksum sum;
+
+public:
+    explicit serial_writer(std::ostream &_os) noexcept : os{_os}, sum{} {}
+
+    void write_bytes(const void *data, std::size_t n)
+    {
+        sum.update(data, n);
+        os.write(static_cast<const char *>(data), static_cast<std::streamsize>(n));
+        if (!os)
+        {
+            throw std::runtime_error{"bst::save: write error"};
+        }
+    }
+
+    /**
+     * @brief Writes the bytes of an object of trivially copyable type.
+     */
+    template <typename T>
+    void write_value(const T &x)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "write_value() needs a trivially copyable type");
+        write_bytes(&x, sizeof(T));
+    }
+
+    /**
+     * @brief Writes the checksum of everything written so far. It's not part of the checksum.
+     */
+    void write_checksum()
+    {
+        const std::uint64_t value{sum.value()};
+        os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        if (!os)
+        {
+            throw std::runtime_error{"bst::save: write error"};
+        }
+    }
+};
+
+/**
+ * @brief Input side of `bst::load()`: reads bytes from a stream and keeps their checksum. Serializers read through it.
+ */
+class serial_reader
+{
+    std::istream &is;
+    stream_checksum sum;
+
+public:
+    explicit serial_reader(std::istream &_is) noexcept : is{_is}, sum{} {}
+
+    void read_bytes(void *data, std::size_t n)
+    {
+        is.read(static_cast<char *>(data), static_cast<std::streamsize>(n));
+        if (static_cast<std::size_t>(is.gcount()) != n)
+        {
+            throw std::runtime_error{"bst::load: truncated input"};
+        }
+        sum.update(data, n);
+    }
+
+    template <typename T>
+    T read_value()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "read_value() needs a trivially copyable type");
+        T x;
+        read_bytes(&x, sizeof(T));
+        return x;
+    }
+
+    /**
+     * @brief Reads the stored checksum and compares it with the one of everything read so far.
+     */
+    void check_checksum()
+    {
+        const std::uint64_t expected{sum.value()};
+        std::uint64_t stored;
+        is.read(reinterpret_cast<char *>(&stored), sizeof(stored));
+        if (is.gcount() != sizeof(stored))
+        {
+            throw std::runtime_error{"bst::load: truncated input"};
+        }
+        if (stored != expected)
+        {
+            throw std::runtime_error{"bst::load: checksum mismatch"};
+        }
+    }
+};
+
+/**
+ * @brief Kind of an arithmetic type in a @ref trivial_type_tag(). `bool` and the character types have kinds of their own, since they share the size of some integers but not their meaning.
+ */
+template <typename T>
+constexpr std::uint64_t arithmetic_kind() noexcept
+{
+    return std::is_same<T, bool>::value ? 'B' : std::is_same<T, char>::value ? 'C' : std::is_same<T, wchar_t>::value ? 'W' : std::is_same<T, char16_t>::value ? 'H' : std::is_same<T, char32_t>::value ? 'Q' : std::is_floating_point<T>::value ? 'F' : std::is_signed<T>::value ? 'S' : 'U';
+}
+
+template <typename T>
+constexpr std::uint64_t trivial_type_tag_helper(std::false_type) noexcept
+{
+    return (arithmetic_kind<T>() << 56) | sizeof(T);
+}
+
+template <typename T>
+constexpr std::uint64_t trivial_type_tag_helper(std::true_type) noexcept
+{
+    return (std::uint64_t{'E'} << 56) | (arithmetic_kind<typename std::underlying_type<T>::type>() << 48) | sizeof(T);
+}
+
+/**
+ * @brief Tag of an arithmetic or enumeration type, stored in the header of a saved tree: its kind in the top byte (for an enumeration 'E', followed by the kind of the underlying type), and its size.
+ * Two enumerations with the same underlying type get the same tag. Any other type must name its own tag in a specialization of @ref serializer.
+ */
+template <typename T>
+constexpr std::uint64_t trivial_type_tag() noexcept
+{
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "trivial_type_tag() is only for arithmetic and enumeration types");
+    return trivial_type_tag_helper<typename std::remove_cv<T>::type>(std::is_enum<T>{});
+}
+
+/**
+ * @brief Base for the @ref serializer of a trivially copyable class: its bytes are copied in bulk, as for the arithmetic types, under the given tag, e.g. `template <> struct serializer<point> : trivial_serializer<point, 0x706f696e74> {};`.
+ */
+template <typename T, std::uint64_t Tag>
+struct trivial_serializer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be stored in bulk");
+    static constexpr bool bulk = true;
+    static constexpr std::uint64_t tag = Tag;
+};
+
+template <typename T, std::uint64_t Tag>
+constexpr bool trivial_serializer<T, Tag>::bulk;
+
+template <typename T, std::uint64_t Tag>
+constexpr std::uint64_t trivial_serializer<T, Tag>::tag;
+
+/**
+ * @brief How `bst::save()` and `bst::load()` store a key or a value of type T.
+ *
+ * The primary template handles the arithmetic and enumeration types: `bulk` is true, and their bytes are copied in blocks of many elements at once, under their @ref trivial_type_tag(). Any other type needs a specialization with a `tag` that identifies it, so that a file is never loaded into another type of the same size. A trivially copyable class can derive it from @ref trivial_serializer and keep the bulk copy. Other types set `bulk = false` and provide the functions `static void write(serial_writer &, const T &)` and `static T read(serial_reader &)`, like the specialization for `std::string` below.
+ */
+template <typename T, typename = void>
+struct serializer
+{
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "specialize serializer<T>, with a tag of its own, to save and load this type");
+    static constexpr bool bulk = true;
+    static constexpr std::uint64_t tag = trivial_type_tag<T>();
+};
+
+template <typename T, typename E>
+constexpr bool serializer<T, E>::bulk;
+
+template <typename T, typename E>
+constexpr std::uint64_t serializer<T, E>::tag;
+
+/**
+ * @brief Strings are stored as their length (64 bits) followed by their characters.
+ */
+template <>
+struct serializer<std::string>
+{
+    static constexpr bool bulk = false;
+    static constexpr std::uint64_t tag = (std::uint64_t{'s'} << 56) | 1;
+
+    static void write(serial_writer &out, const std::string &s)
+    {
+        out.write_value(static_cast<std::uint64_t>(s.size()));
+        out.write_bytes(s.data(), s.size());
+    }
+
+    static std::string read(serial_reader &in)
+    {
+        const auto size = in.read_value<std::uint64_t>();
+        std::string s{};
+        std::size_t done{0};
+        while (done < size)
+        { //grows with the data actually read, so a corrupted length can't allocate more than the input holds
+            const std::size_t block{static_cast<std::size_t>(std::min<std::uint64_t>(size - done, 1 << 16))};
+            s.resize(done + block);
+            in.read_bytes(&s[done], block);
+            done += block;
+        }
+        return s;
+    }
+};
+
+/**
+ * @brief Constants of the header written by `bst::save()`, which holds the magic number (with the version), a marker of the byte order, the tags of the key and value types and the number of pairs.
+ * The numbers are stored with the byte order of the machine: a file saved on a machine with the other order is rejected by `bst::load()`.
+ */
+struct serial_format
+{
+    static constexpr std::uint64_t magic = 0x3170616e73747362ULL; //"bstsnap1" on little-endian machines
+    static constexpr std::uint32_t byte_order = 0x01020304;
+
+    /**
+     * @brief Number of pairs per block when both types are written in bulk.
+     */
+    static constexpr std::size_t block = 4096;
+};
+
+#endif /* Serializer_h */
@@ -2,10 +2,40 @@
 #define bst_h
 
 #include "Iterator.h"
+#include "Balancing.h"
+#include "NodePool.h"
+#include "Serializer.h"
+#include <algorithm>  //std::stable_sort
+#include <exception>  //std::exception_ptr
+#include <fstream>    //std::ofstream, std::ifstream
 #include <functional> //std::less
+#include <future>     //std::async
+#include <iterator>
+#include <random>     //std::uniform_int_distribution
+#include <stdexcept>  //std::invalid_argument
+#include <thread>     //std::thread::hardware_concurrency
+#include <tuple>       //std::forward_as_tuple
+#include <type_traits>
 #include <utility>    //std::make_pair
 #include <vector>
 #include <time.h> //to generate a random tree and change the seed
+
+/**
+ * Compile-time tracing hook, called with a string literal by some member functions of `bst`. It does nothing by default; compile with `-DBST_TRACE_CALLS` to print the messages on `std::clog`, or define `BST_TRACE(message)` before including this header to route them elsewhere.
+ */
+#ifndef BST_TRACE
+#ifdef BST_TRACE_CALLS
+#define BST_TRACE(message) (std::clog << (message) << "\n")
+#else
+#define BST_TRACE(message) ((void)0)
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BST_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define BST_PREFETCH(address)
+#endif
 /** @mainpage
  *
  * In the following some brief descriptions of the classes involved in the project. 
@@ -13,44 +43,123 @@
  * A templated binary search tree implemented in C++ (compliant with the C++14 standard). The project is split into three files, each one of them contains the implementation of concept, and hence in each one of them we have a class declaration and definition.
  *
  * @subsection subsection1 Node.h
- * The implementation of the concept of a Node. A Node is templated on the type of the value, which in this project will be a `std::pair` with a key and a value, and must know its children and its parent. Therefore we have 4 data member. The pointers to the left and right child are `unique_ptr`, while the pointer to the parent is a raw pointer. If it were a `unique_ptr`, then we would end up with nodes that are pointed (uniquely) by more pointers, which is not correct.
+ * The implementation of the concept of a Node. A Node is templated on the type of the value, which in this project will be a `std::pair` with a key and a value, and must know its children and its parent. Therefore we have 4 data member, plus an integer used by the balancing policy. The pointers to the left and right child are `unique_ptr`, while the pointer to the parent is a raw pointer. If it were a `unique_ptr`, then we would end up with nodes that are pointed (uniquely) by more pointers, which is not correct.
  *
  * @subsection subsection2 Iterator.h
- * The class iterator is templated on the type 'T' of the Node, and on a boolean 'is_const', used to determine the const-ness of the iterator by exploiting `std::conditional`, a C++11 which determines at compile time the types of a member. The most important operator is the '++' (pre-increment), which allows to go the next (ordering by key) @ref Node by returning a self-reference.
+ * The class iterator is templated on the type 'T' of the Node, and on a boolean 'is_const', used to determine the const-ness of the iterator by exploiting `std::conditional`, a C++11 which determines at compile time the types of a member. The most important operator is the '++' (pre-increment), which allows to go the next (ordering by key) @ref Node by returning a self-reference. The iterator is bidirectional: '--' goes to the previous @ref Node, and the past-the-end iterator reaches the last @ref Node through the header of the tree, which caches the leftmost and the rightmost Nodes.
  *
  * @subsection subsection3 bst.h
- * This class contains the implementation of the Binary Search Tree. It's templated on the type of the key, on the type of the value, and on the type of the comparison operator, which is set to `std::less` by default. The data members are a `std::unique_ptr` to the head Node, and the comparison operator.
+ * This class contains the implementation of the Binary Search Tree. It's templated on the type of the key, on the type of the value, on the type of the comparison operator, which is set to `std::less` by default, and on the balancing policy, which is set to `unbalanced` by default. The data members are a `std::unique_ptr` to the head Node, and the comparison operator.
+ *
+ * @subsection subsection4 Balancing.h
+ * The balancing policies of the tree. `unbalanced` leaves the shape of the tree untouched (and @ref bst::balance() must be called by hand), while `avl` and `red_black` keep the height logarithmic after every insertion and erasure by rotating the Nodes in place. Any of them can be wrapped in `order_statistics`, which also keeps the size of every subtree and enables @ref bst::rank(), @ref bst::select(), @ref bst::sample() and @ref bst::split(). Every policy also knows how to `join()` two trees around a middle @ref Node, which @ref bst::split() and `join()` build on.
+ *
+ * @subsection subsection5 NodePool.h
+ * The Nodes are allocated through the allocator given as last template parameter of the tree (`std::allocator` by default, any allocator usable with `std::allocator_traits` works, including the `std::pmr` ones). `pool_allocator` hands out Nodes from contiguous chunks of a `node_arena` and lets @ref bst::clear() free the whole tree at once. The `unique_ptr`s that link the Nodes have a `node_deleter`, which gives a @ref Node back to the allocator it comes from: it's empty for stateless allocators, and holds a pointer to the arena for `pool_allocator`.
+ *
+ * @subsection subsection6 frozen_bst.h
+ * `freeze(tree)` takes an immutable snapshot of a tree: a `frozen_bst` stores the keys in two contiguous arrays laid out in Eytzinger (breadth-first) order, so that a lookup touches a single array and can prefetch the next levels. It's meant for trees that are built once and then only searched.
+ *
+ * @subsection subsection7 compact_bst.h
+ * `compact_bst` is a red-black tree stored in three parallel vectors (keys, values and links), where the children and the parent are 32-bit indices and the slots of erased entries are kept in a free list. It has the same lookup interface as `bst`, with iterators that yield a pair of references. `compact(tree)` copies a `bst` into a balanced `compact_bst`.
+ *
+ * @subsection subsection8 snapshot_bst.h
+ * `snapshot_bst` is a map for one writer and many concurrent readers. Every update builds a new version of a persistent AVL tree, sharing the untouched subtrees, and publishes it atomically. Readers call `snapshot()`, which is lock-free, and search or iterate that version without taking any lock.
+ *
+ * @subsection subsection9 concurrent_bst.h
+ * `concurrent_bst` lets many threads insert, erase and look up keys at once. It uses hand-over-hand locking on Nodes that carry their own mutex. A key erased from a Node with two children is only marked as missing.
+ *
+ * @subsection subsection10 sharded_bst.h
+ * `sharded_bst` splits the keys by range into independent `bst` shards, each with its own mutex. It routes every operation to its shard, iterates over all the shards in key order, and can split a hot shard at its median while the others keep working.
+ *
+ * @subsection subsection11 Serializer.h
+ * @ref bst::save() and @ref bst::load() store a tree in a binary stream or file: a header with the types and the number of pairs, the pairs in key order and a checksum. Loading rebuilds a balanced tree in linear time. Trivially copyable keys and values are copied in blocks, other types need a specialization of `serializer`, like the one provided for `std::string`.
+ *
+ * @subsection subsection12 mapped_bst.h
+ * `write_mapped(tree)` writes a tree of keys and values stored in bulk by their `serializer` to a file in the Eytzinger layout of `frozen_bst`. `mapped_bst` maps that file and searches it in place. Opening it reads only the header, so a large table is ready in a few microseconds, and its pages are loaded as the lookups reach them.
  *
  *
  */
 
 /**
- * @brief Struct used in the error-handling of the `erase` function. It'll be catched in a try-catch block.
- * 
- * */
+ * @brief Tag used to tell the range constructor and `bst::assign()` that the input is sorted by key and has no duplicate keys.
+ */
+struct sorted_unique_t
+{
+    explicit sorted_unique_t() = default;
+};
+
+/**
+ * @brief Instance of @ref sorted_unique_t, e.g. `bst<int, int> tree{sorted_unique, v.begin(), v.end()};`
+ */
+constexpr sorted_unique_t sorted_unique{};
 
-struct key_not_found
+/**
+ * @brief Pair of iterators that can be used in a range-based for loop. Returned by `bst::range()`.
+ */
+template <typename It>
+struct iterator_range
 {
-    /**
-     * @brief The string with the message  
-     */
-    std::string s;
-    /**
-     * @brief Custom constructor
-     * @param _s String to be printed  
-     */
-    key_not_found(std::string _s) : s{_s} {};
+    It first;
+    It last;
 
-    /**
-     * @brief Classical method to show the error message in the try-catch block
-     */
-    const char *what() const
-    {
-        return s.c_str();
-    }
+    It begin() const noexcept { return first; }
+    It end() const noexcept { return last; }
+    bool empty() const noexcept { return first == last; }
+};
+
+/**
+ * @brief Argument of the parallel copy constructor of `bst`: the number of threads that may be used for the copy.
+ */
+struct parallel_copy
+{
+    unsigned int threads;
+    explicit parallel_copy(unsigned int _threads = std::thread::hardware_concurrency()) : threads{_threads} {}
+};
+
+/**
+ * @brief Argument of the parallel range constructor of `bst`: the number of threads that may be used to sort the input and build the tree.
+ */
+struct parallel_build
+{
+    unsigned int threads;
+    explicit parallel_build(unsigned int _threads = std::thread::hardware_concurrency()) : threads{_threads} {}
+};
+
+/**
+ * @brief Trait telling whether an allocator can be used by several threads at once without synchronization. Specialize it to allow parallel copies with other allocators.
+ */
+template <typename A>
+struct allows_concurrent_allocation : std::false_type
+{
+};
+
+template <typename T>
+struct allows_concurrent_allocation<std::allocator<T>> : std::true_type
+{
+};
+
+/**
+ * @brief Trait telling whether a comparison operator declares `is_transparent`, i.e. whether it can compare the keys with objects of other types (e.g. `std::less<>`).
+ */
+template <typename C, typename = void>
+struct is_transparent_comparator : std::false_type
+{
+};
+
+template <typename C>
+struct is_transparent_comparator<C, decltype(void(sizeof(typename C::is_transparent *)))> : std::true_type
+{
 };
 
-template <typename key_type, typename value_type, typename OP = std::less<key_type>>
+/**
+ * @brief `int` if a probe of type K can be compared by C with keys of type Key as it is, i.e. if C is transparent and K is not Key itself. Otherwise a substitution failure, so that the heterogeneous lookups of the trees drop out of overload resolution.
+ */
+template <typename K, typename Key, typename C>
+using if_transparent_probe = typename std::enable_if<is_transparent_comparator<C>::value && !std::is_same<typename std::decay<K>::type, Key>::value, int>::type;
+
+template <typename key_type, typename value_type, typename OP = std::less<key_type>, typename Balance = unbalanced,
+          typename Alloc = std::allocator<std::pair<const key_type, value_type>>>
 class bst
 {
 
@@ -61,16 +170,33 @@ class bst
     /**
      * @brief Templated Node
      */
-    using node_type = Node<pair_type>;
+    using node_type = Node<pair_type, Alloc>;
 
     /**
      * @brief iterator templated on @ref node_type and on @ref pair_type
      */
-    using iterator = _iterator<pair_type, false>;
+    using iterator = _iterator<pair_type, false, Alloc>;
     /**
      * @brief iterator that points to a constant content (i.e. the @ref pair_type). It can be increased/decreased, but not used to modify the tree. Notice that it's the pair that is constant!
      */
-    using constant_iterator = _iterator<pair_type, true>;
+    using constant_iterator = _iterator<pair_type, true, Alloc>;
+
+    /**
+     * @brief iterators that visit the tree from the largest to the smallest key.
+     */
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using constant_reverse_iterator = std::reverse_iterator<constant_iterator>;
+
+    /**
+     * @brief The allocator given as template parameter, rebound to allocate @ref node_type objects.
+     */
+    using node_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<node_type>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    /**
+     * @brief The `unique_ptr` that owns a @ref node_type: its deleter gives the @ref Node back to @ref alloc.
+     */
+    using node_owner = typename node_type::owner;
 
 private:
     /**
@@ -78,531 +204,2337 @@ private:
     */
     OP comp;                         //std::less<key_type> comp;
 
+    /**
+     * @brief Allocator used for every @ref Node of the tree.
+     */
+    node_allocator alloc;
+
     /**
      * @brief Unique pointer to the head @ref Node. 
      */
-    std::unique_ptr<node_type> head; //unique pointer to the root/head Node
+    node_owner head; //unique pointer to the root/head Node
     //I set the head to be a unique pointer so I can use release,get,reset member fcts
 
     /**
-     * @brief Helper recursive function used in the copy constructor to perform a deep copy.
-     * @param ptn reference to a `std::unique_ptr`
-     *
+     * @brief Header shared by the iterators of the tree, with the leftmost and the rightmost @ref Node. Kept up to date by every function that links or unlinks Nodes.
      */
-    /*
-    void copy_helper(std::unique_ptr<Node<pair_type>>& ptn) {
-        this->insert(ptn.get()->data);
-        if (ptn.get()->left) {
-            copy_helper(ptn.get()->left);
+    tree_header<pair_type, Alloc> bounds{nullptr, nullptr, 0};
+
+    /**
+     * @brief Returns an @ref iterator to ptn that knows the header of the tree (so that it can be decremented from @ref end()).
+     */
+    iterator make_iterator(node_type *ptn) noexcept
+    {
+        return iterator{ptn, &bounds};
+    }
+
+    constant_iterator make_iterator(node_type *ptn) const noexcept
+    {
+        return constant_iterator{ptn, &bounds};
+    }
+
+    /**
+     * @brief Recomputes the leftmost and rightmost Nodes by descending the two spines of the tree.
+     */
+    void update_bounds() noexcept
+    {
+        bounds.leftmost = bounds.rightmost = head.get();
+        if (!head)
+        {
+            return;
         }
-        if (ptn.get()->right) {
-            copy_helper(ptn.get()->right);
+        while (bounds.leftmost->left)
+        {
+            bounds.leftmost = bounds.leftmost->left.get();
+        }
+        while (bounds.rightmost->right)
+        {
+            bounds.rightmost = bounds.rightmost->right.get();
         }
-        return;
     }
-    */
 
     /**
-     * @brief Helper recursive function that finds the height of a @ref Node.
-     * @param ptn Raw pointer to the Node of which we want to find the height.
-     * The height is the number of nodes along the longest path from the node down to the farthest leaf node.
+     * @brief Allocates and constructs a @ref Node with the allocator of the tree.
+     * @param args Arguments forwarded to the constructor of @ref Node
      */
-    int get_height(Node<pair_type> *ptn)
+    template <typename... Args>
+    node_type *create_node(Args &&...args)
     {
-        if (!ptn)
+        auto p = node_traits::allocate(alloc, 1);
+        try
         {
-            return 0; //if is nullptr, height is 0
+            node_traits::construct(alloc, p, std::forward<Args>(args)...);
         }
-        return 1 + std::max(get_height(ptn->left.get()), get_height(ptn->right.get()));
+        catch (...)
+        {
+            node_traits::deallocate(alloc, p, 1);
+            throw;
+        }
+        p->left.get_deleter() = p->right.get_deleter() = owner_deleter();
+        return p;
     }
 
     /**
-     * @brief Helper recursive function that checks if the tree is balanced.
-     * @param head_node Raw pointer to a @ref Node, which will be the @ref head Node. Since it's a unique pointer, we need to call it with `head.get()`.
-     * Recall that a tree is balanced if, <b>for each </b> @ref Node, the height of the left and right subtree is at most 1 and each subtree of the tree is balanced.
+     * @brief The deleter of the links of the tree, which gives the Nodes back to @ref alloc. Every @ref node_owner of the tree gets one, so that a `reset()` can never `delete` a @ref Node.
      */
-    bool balance_check(Node<pair_type> *head_node)
+    typename node_type::deleter_type owner_deleter() const noexcept
     {
-        if (!head_node)
+        return typename node_type::deleter_type{alloc};
+    }
+
+    /**
+     * @brief Destroys and deallocates a single @ref Node, which must not own any child.
+     */
+    void destroy_node(node_type *p) noexcept
+    {
+        node_traits::destroy(alloc, p);
+        node_traits::deallocate(alloc, p, 1);
+    }
+
+    /**
+     * @brief Helper function that destroys all the Nodes of the subtree rooted at ptn, with constant stack usage whatever the shape of the tree.
+     * As in `Node::destroy_subtree()`, left children are rotated up until the current @ref Node has none, and then the @ref Node is destroyed and we move to its right child. Parent pointers are not maintained, since every @ref Node is going away.
+     */
+    void destroy_helper(node_type *ptn) noexcept
+    {
+        while (ptn)
         {
-            return true; //empy tree is balanced by definition
+            if (ptn->left)
+            {
+                auto l = ptn->left.release();
+                ptn->left.reset(l->right.release());
+                l->right.reset(ptn);
+                ptn = l;
+            }
+            else
+            {
+                auto r = ptn->right.release();
+                destroy_node(ptn);
+                ptn = r;
+            }
         }
-        int left_height{get_height(head_node->left.get())};
-        int right_height{get_height(head_node->right.get())};
+    }
 
-        if (std::abs(left_height - right_height) <= 1 && balance_check(head_node->left.get()) && balance_check(head_node->right.get()))
+    /**
+     * @brief Asks the allocator to free all its memory at once, if it supports it (see `pool_allocator::release()`).
+     */
+    template <typename A>
+    static auto release_helper(A &a, int) noexcept -> decltype(a.release())
+    {
+        return a.release();
+    }
+
+    template <typename A>
+    static bool release_helper(A &, long) noexcept
+    {
+        return false;
+    }
+
+    /**
+     * @brief Helper function that performs a deep copy of the subtree rooted at src and returns the root of the copy.
+     * @param src Raw pointer to the @ref Node to be copied (not `nullptr`)
+     * @param parent Raw pointer to the parent of the copy
+     * As in the copy constructor of @ref Node, the source is visited in pre-order through the parent pointers, so the stack usage is constant. If an exception is thrown, the partial copy is destroyed.
+     */
+    node_type *copy_helper(const node_type *src, node_type *parent)
+    {
+        node_type *root{create_node(src->data, parent)};
+        root->balance_data = src->balance_data;
+        root->subtree_size = src->subtree_size;
+        node_type *dst{root};
+        try
         {
-            return true;
+            while (true)
+            {
+                if (src->left && !dst->left)
+                {
+                    dst->left.reset(create_node(src->left->data, dst));
+                    dst->left->balance_data = src->left->balance_data;
+                    dst->left->subtree_size = src->left->subtree_size;
+                    src = src->left.get();
+                    dst = dst->left.get();
+                }
+                else if (src->right && !dst->right)
+                {
+                    dst->right.reset(create_node(src->right->data, dst));
+                    dst->right->balance_data = src->right->balance_data;
+                    dst->right->subtree_size = src->right->subtree_size;
+                    src = src->right.get();
+                    dst = dst->right.get();
+                }
+                else if (dst == root)
+                {
+                    return root;
+                }
+                else
+                {
+                    src = src->parent;
+                    dst = dst->parent;
+                }
+            }
+        }
+        catch (...)
+        {
+            destroy_helper(root);
+            throw;
         }
+    }
 
-        return false;
+    /**
+     * @brief Lets the allocator preallocate all the Nodes of tree in one block, if it supports it (see `pool_allocator::reserve()`).
+     */
+    template <typename A>
+    static auto reserve_alloc_helper(A &a, const bst &tree, int) -> decltype(a.reserve(std::size_t{}))
+    {
+        return a.reserve(static_cast<std::size_t>(std::distance(tree.begin(), tree.end())));
     }
 
+    template <typename A>
+    static void reserve_alloc_helper(A &, const bst &, long) noexcept {}
+
     /**
-     * @brief Utility function used for @ref find(). It prevents code duplication since the body of @ref find() is almost the same if we do the lookup in a constant tree or not.
+     * @brief Copies all the Nodes of tree into the (empty) tree.
      */
+    void copy_from(const bst &tree)
+    {
+        if (!tree.head)
+        {
+            return;
+        }
+        reserve_alloc_helper(alloc, tree, 0);
+        head.reset(copy_helper(tree.head.get(), nullptr));
+        update_bounds();
+        bounds.count = tree.bounds.count;
+    }
 
-    node_type *find_helper(const key_type &x) const
+    /**
+     * @brief Helper recursive function for the parallel copy: the first `depth` levels of src are copied by the calling thread, and every subtree below them is copied by @ref copy_helper() in a separate task.
+     * @param tasks Futures of the running copies, each with the `unique_ptr` where its result must be linked
+     */
+    void parallel_copy_helper(const node_type *src, node_owner &slot, node_type *parent, unsigned int depth,
+                              std::vector<std::pair<std::future<node_type *>, node_owner *>> &tasks)
     {
-        auto ptr{head.get()};
-        while (ptr)
+        if (!src)
         {
-            if (comp(x, ptr->data.first))
+            return;
+        }
+        if (depth == 0)
+        {
+            tasks.emplace_back(std::async(std::launch::async, [this, src, parent]() { return copy_helper(src, parent); }), &slot);
+            return;
+        }
+        slot.reset(create_node(src->data, parent));
+        slot->balance_data = src->balance_data;
+        slot->subtree_size = src->subtree_size;
+        parallel_copy_helper(src->left.get(), slot->left, slot.get(), depth - 1, tasks);
+        parallel_copy_helper(src->right.get(), slot->right, slot.get(), depth - 1, tasks);
+    }
+
+    /**
+     * @brief Copies tree into the (empty) tree using up to `threads` threads. If the allocator is not known to be thread-safe (see @ref allows_concurrent_allocation), the copy is sequential.
+     */
+    void parallel_copy_from(const bst &tree, unsigned int threads)
+    {
+        if (threads <= 1 || !allows_concurrent_allocation<node_allocator>::value)
+        {
+            copy_from(tree);
+            return;
+        }
+        unsigned int depth{0};
+        while ((1u << depth) < threads && depth < 16)
+        {
+            ++depth; //2^depth subtrees, one per thread
+        }
+        std::vector<std::pair<std::future<node_type *>, node_owner *>> tasks{};
+        tasks.reserve(std::size_t{1} << depth);
+        std::exception_ptr error{};
+        try
+        {
+            parallel_copy_helper(tree.head.get(), head, nullptr, depth, tasks);
+        }
+        catch (...)
+        {
+            error = std::current_exception(); //wait for the running tasks before unwinding
+        }
+        join_helper(tasks, error);
+        update_bounds();
+        bounds.count = tree.bounds.count;
+    }
+
+    /**
+     * @brief Waits for the tasks of a parallel copy or build and links their subtrees. If any task, or the caller (error), has thrown, the tree is cleared and the first exception is rethrown.
+     */
+    void join_helper(std::vector<std::pair<std::future<node_type *>, node_owner *>> &tasks, std::exception_ptr error)
+    {
+        for (auto &task : tasks)
+        {
+            try
             {
-                ptr = ptr->left.get();
+                task.second->reset(task.first.get()); //link the subtree built by the task
             }
-            else if (comp(ptr->data.first, x))
+            catch (...)
             {
-                ptr = ptr->right.get();
-            }
-            else
-            { //equality holds
-                return ptr;
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
             }
         }
-        return nullptr;
+        if (error)
+        {
+            clear();
+            std::rethrow_exception(error);
+        }
     }
 
     /**
-     * @brief Helper (recursive) function to balance the tree.
-     * @param v reference to a constant std::vector
-     * @param a constant long int. Left bound of the subtree
-     * @param b constant long int. Right bound of the subtree
-     * Given a vector v with the (ordered) pairs of a tree, it balances the tree by inserting recursively the middle node, until this makes sense
+     * @brief Creates and links the Nodes of the balanced subtree holding the sorted pairs v[a..b], moving them, and returns its root. If an allocation throws, the part already built is destroyed.
      */
+    template <typename V>
+    node_type *build_subtree_helper(V &v, long int a, long int b, node_type *parent)
+    {
+        if (a > b)
+        {
+            return nullptr;
+        }
+        long int middle{(a + b) / 2};
+        auto ptn = create_node(std::move(v[middle]), parent);
+        try
+        {
+            ptn->left.reset(build_subtree_helper(v, a, middle - 1, ptn));
+            ptn->right.reset(build_subtree_helper(v, middle + 1, b, ptn));
+        }
+        catch (...)
+        {
+            destroy_helper(ptn);
+            throw;
+        }
+        return ptn;
+    }
 
-    void balance_helper(const std::vector<pair_type> &v, long int a, long int b)
+    /**
+     * @brief Helper recursive function for the parallel build, shaped like @ref parallel_copy_helper(): the medians of the first `depth` levels are linked by the calling thread, and every subtree below them is built by @ref build_subtree_helper() in a separate task.
+     */
+    template <typename V>
+    void parallel_build_helper(V &v, long int a, long int b, node_owner &slot, node_type *parent, unsigned int depth,
+                               std::vector<std::pair<std::future<node_type *>, node_owner *>> &tasks)
     {
         if (a > b)
         {
-            //            std::exception("Tree is not balancable");
-            //            std::cout<< "Not possible" <<"\n";
             return;
         }
-        else
+        if (depth == 0)
+        {
+            tasks.emplace_back(std::async(std::launch::async, [this, &v, a, b, parent]() { return build_subtree_helper(v, a, b, parent); }), &slot);
+            return;
+        }
+        long int middle{(a + b) / 2};
+        slot.reset(create_node(std::move(v[middle]), parent));
+        parallel_build_helper(v, a, middle - 1, slot->left, slot.get(), depth - 1, tasks);
+        parallel_build_helper(v, middle + 1, b, slot->right, slot.get(), depth - 1, tasks);
+    }
+
+    /**
+     * @brief Sorts v with up to `threads` threads: equal slices are sorted by separate tasks, and then merged pairwise, in parallel, until one is left. Both steps are stable.
+     */
+    template <typename V, typename Compare>
+    static void parallel_sort_helper(V &v, Compare by_key, unsigned int threads)
+    {
+        std::vector<std::size_t> cuts{};
+        for (unsigned int i = 0; i <= threads; ++i)
+        {
+            cuts.push_back(v.size() * i / threads);
+        }
+        std::vector<std::future<void>> tasks{};
+        for (unsigned int i = 0; i < threads; ++i)
+        {
+            tasks.emplace_back(std::async(std::launch::async, [&v, &cuts, by_key, i]() { std::stable_sort(v.begin() + cuts[i], v.begin() + cuts[i + 1], by_key); }));
+        }
+        for (auto &task : tasks)
+        {
+            task.get();
+        }
+        while (cuts.size() > 2)
+        {
+            tasks.clear();
+            std::vector<std::size_t> merged{};
+            for (std::size_t i = 0; i + 2 < cuts.size(); i += 2)
+            {
+                tasks.emplace_back(std::async(std::launch::async, [&v, &cuts, by_key, i]() { std::inplace_merge(v.begin() + cuts[i], v.begin() + cuts[i + 1], v.begin() + cuts[i + 2], by_key); }));
+                merged.push_back(cuts[i]);
+            }
+            if (cuts.size() % 2 == 0)
+            {
+                merged.push_back(cuts[cuts.size() - 2]); //odd slice out, merged in the next round
+            }
+            merged.push_back(cuts.back());
+            for (auto &task : tasks)
+            {
+                task.get();
+            }
+            cuts = std::move(merged);
+        }
+    }
+
+    /**
+     * @brief Fills an empty tree from a range in unknown order with up to `threads` threads: the pairs are sorted by @ref parallel_sort_helper(), deduplicated as in @ref assign_unsorted_helper(), and then moved into Nodes created by @ref parallel_build_helper(). If the allocator is not known to be thread-safe (see @ref allows_concurrent_allocation), only the sort is parallel.
+     */
+    template <typename It>
+    void parallel_assign_helper(It first, It last, unsigned int threads)
+    {
+        using sortable_pair = std::pair<typename std::remove_const<key_type>::type, value_type>;
+        std::vector<sortable_pair> v(first, last);
+        if (v.empty())
         {
-            int middle{static_cast<int>((a + b) / 2)};
-            this->insert(v[middle]);
-            balance_helper(v, a, middle - 1);
-            balance_helper(v, middle + 1, b);
+            return;
         }
+        threads = std::max(1u, std::min<unsigned int>(threads, static_cast<unsigned int>(v.size())));
+        auto by_key = [this](const sortable_pair &a, const sortable_pair &b) { return comp(a.first, b.first); };
+        parallel_sort_helper(v, by_key, threads);
+        auto same_key = [this](const sortable_pair &a, const sortable_pair &b) { return !comp(a.first, b.first) && !comp(b.first, a.first); };
+        v.erase(std::unique(v.begin(), v.end(), same_key), v.end());
+
+        unsigned int depth{0};
+        if (allows_concurrent_allocation<node_allocator>::value)
+        {
+            while ((1u << depth) < threads && depth < 16)
+            {
+                ++depth; //2^depth subtrees, one per thread
+            }
+        }
+        std::vector<std::pair<std::future<node_type *>, node_owner *>> tasks{};
+        std::exception_ptr error{};
+        try
+        {
+            if (depth == 0)
+            {
+                head.reset(build_subtree_helper(v, 0, static_cast<long int>(v.size()) - 1, nullptr));
+            }
+            else
+            {
+                parallel_build_helper(v, 0, static_cast<long int>(v.size()) - 1, head, nullptr, depth, tasks);
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception(); //wait for the running tasks before unwinding
+        }
+        join_helper(tasks, error);
+        update_bounds();
+        bounds.count = v.size();
+        Balance::after_rebuild(head);
+    }
+
+    /**
+     * @brief Move assignment of the Nodes when the allocator propagates: the allocator is taken along with the Nodes.
+     */
+    void move_helper(bst &t, std::true_type) noexcept
+    {
+        alloc = t.alloc;
+        head = std::move(t.head);
+        bounds = t.bounds;
+        t.bounds = {nullptr, nullptr, 0};
+    }
+
+    /**
+     * @brief Move assignment of the Nodes when the allocator doesn't propagate: Nodes can be stolen only if the two allocators are equal, otherwise they are copied.
+     */
+    void move_helper(bst &t, std::false_type)
+    {
+        if (alloc == t.alloc)
+        {
+            head = std::move(t.head);
+            bounds = t.bounds;
+            t.bounds = {nullptr, nullptr, 0};
+        }
+        else
+        {
+            copy_from(t);
+            t.clear();
+        }
+    }
+
+    void copy_alloc_helper(const bst &tree, std::true_type)
+    {
+        alloc = tree.alloc;
+        head.get_deleter() = owner_deleter();
+    }
+
+    void copy_alloc_helper(const bst &, std::false_type) noexcept {}
+
+    /**
+     * @brief Helper recursive function used in the copy constructor to perform a deep copy.
+     * @param ptn reference to a `std::unique_ptr`
+     *
+     */
+    /*
+    void copy_helper(node_owner &ptn) {
+        this->insert(ptn.get()->data);
+        if (ptn.get()->left) {
+            copy_helper(ptn.get()->left);
+        }
+        if (ptn.get()->right) {
+            copy_helper(ptn.get()->right);
+        }
+        return;
+    }
+    */
+
+    /**
+     * @brief Helper recursive function that finds the height of a @ref Node.
+     * @param ptn Raw pointer to the Node of which we want to find the height.
+     * The height is the number of nodes along the longest path from the node down to the farthest leaf node.
+     */
+    int get_height(node_type *ptn)
+    {
+        if (!ptn)
+        {
+            return 0; //if is nullptr, height is 0
+        }
+        return 1 + std::max(get_height(ptn->left.get()), get_height(ptn->right.get()));
+    }
+
+    /**
+     * @brief Helper recursive function that checks if the tree is balanced.
+     * @param head_node Raw pointer to a @ref Node, which will be the @ref head Node. Since it's a unique pointer, we need to call it with `head.get()`.
+     * Recall that a tree is balanced if, <b>for each </b> @ref Node, the height of the left and right subtree is at most 1 and each subtree of the tree is balanced.
+     */
+    bool balance_check(node_type *head_node)
+    {
+        if (!head_node)
+        {
+            return true; //empy tree is balanced by definition
+        }
+        int left_height{get_height(head_node->left.get())};
+        int right_height{get_height(head_node->right.get())};
+
+        if (std::abs(left_height - right_height) <= 1 && balance_check(head_node->left.get()) && balance_check(head_node->right.get()))
+        {
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Enables the heterogeneous overloads of @ref find(), @ref erase() and @ref operator[]() for a probe of type K only if the comparison operator is transparent, as `std::map` does.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+    /**
+     * @brief Utility function used for @ref find(). It prevents code duplication since the body of @ref find() is almost the same if we do the lookup in a constant tree or not.
+     */
+
+    template <typename K>
+    node_type *find_helper(const K &x) const
+    {
+        auto ptr{head.get()};
+        while (ptr)
+        {
+            if (comp(x, ptr->data.first))
+            {
+                ptr = ptr->left.get();
+            }
+            else if (comp(ptr->data.first, x))
+            {
+                ptr = ptr->right.get();
+            }
+            else
+            { //equality holds
+                return ptr;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Utility function used for @ref find_batch(). Looks up the keys in [first,last) in groups of `group` keys: the descents of a group advance one level at a time, in lockstep, and the next Node of every descent is prefetched, so that the cache misses of different keys overlap.
+     * @param emit Called with the Node found for every key (nullptr if the key is missing), in the order of the keys
+     * @param as_is Whether the keys are compared as they are, i.e. if they are of type key_type or the comparator is transparent. Otherwise each one is converted to key_type once, instead of at every comparison.
+     */
+    template <typename ForwardIt, typename F, typename AsIs>
+    void find_batch_helper(ForwardIt first, ForwardIt last, std::size_t group, F &&emit, AsIs as_is) const
+    {
+        group = group ? group : 1;
+        std::vector<typename std::conditional<AsIs::value, ForwardIt, key_type>::type> keys{};
+        keys.reserve(group);
+        std::vector<node_type *> cursor(group);
+        std::vector<node_type *> found(group);
+        while (first != last)
+        {
+            std::size_t n{0};
+            keys.clear();
+            for (; n < group && first != last; ++n, ++first)
+            {
+                keys.emplace_back(batch_load_helper(first, as_is));
+                cursor[n] = head.get();
+                found[n] = nullptr;
+            }
+            std::size_t active{n};
+            while (active)
+            {
+                active = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    auto ptr = cursor[i];
+                    if (!ptr)
+                    {
+                        continue;
+                    }
+                    const auto &x = batch_key_helper(keys[i], as_is);
+                    if (comp(x, ptr->data.first))
+                    {
+                        ptr = ptr->left.get();
+                    }
+                    else if (comp(ptr->data.first, x))
+                    {
+                        ptr = ptr->right.get();
+                    }
+                    else
+                    { //equality holds
+                        found[i] = ptr;
+                        ptr = nullptr;
+                    }
+                    if (ptr)
+                    {
+                        BST_PREFETCH(ptr);
+                        ++active;
+                    }
+                    cursor[i] = ptr;
+                }
+            }
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                emit(found[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Utility functions used for @ref find_batch_helper(): what is stored for a key (its iterator, or the key converted to key_type), and the key read back from it.
+     */
+    template <typename ForwardIt>
+    static const ForwardIt &batch_load_helper(const ForwardIt &it, std::true_type) noexcept
+    {
+        return it;
+    }
+
+    template <typename ForwardIt>
+    static auto batch_load_helper(const ForwardIt &it, std::false_type) -> decltype(*it)
+    {
+        return *it;
+    }
+
+    template <typename ForwardIt>
+    static auto batch_key_helper(const ForwardIt &it, std::true_type) -> decltype(*it)
+    {
+        return *it;
+    }
+
+    static const key_type &batch_key_helper(const key_type &k, std::false_type) noexcept
+    {
+        return k;
+    }
+
+    /**
+     * @brief Whether @ref find_batch() compares the keys read from a ForwardIt as they are.
+     */
+    template <typename ForwardIt>
+    using batch_as_is = std::integral_constant<bool, is_transparent_comparator<OP>::value || std::is_same<typename std::decay<typename std::iterator_traits<ForwardIt>::value_type>::type, key_type>::value>;
+
+    /**
+     * @brief Utility function used for @ref lower_bound() and @ref upper_bound(). Returns the first Node whose key is not less than x (if `strict` is false) or greater than x (if `strict` is true), or nullptr. A single descent from the root.
+     */
+    template <typename K>
+    node_type *bound_helper(const K &x, bool strict) const
+    {
+        auto ptr{head.get()};
+        node_type *candidate{nullptr};
+        while (ptr)
+        {
+            if (strict ? comp(x, ptr->data.first) : !comp(ptr->data.first, x))
+            { //ptr is a candidate, a better one can only be on the left
+                candidate = ptr;
+                ptr = ptr->left.get();
+            }
+            else
+            {
+                ptr = ptr->right.get();
+            }
+        }
+        return candidate;
+    }
+
+    /**
+     * @brief Utility function used for @ref select(): descends from the root using the sizes of the subtrees. Returns nullptr if k is not smaller than the number of Nodes.
+     */
+    node_type *select_helper(std::size_t k) const noexcept
+    {
+        static_assert(Balance::counts_subtrees::value, "select() needs the order_statistics policy, e.g. bst<K, V, std::less<K>, order_statistics<red_black>>");
+        auto ptr{head.get()};
+        while (ptr)
+        {
+            const std::size_t left_size{Balance::subtree_size(ptr->left.get())};
+            if (k < left_size)
+            {
+                ptr = ptr->left.get();
+            }
+            else if (k == left_size)
+            {
+                return ptr;
+            }
+            else
+            {
+                k -= left_size + 1;
+                ptr = ptr->right.get();
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Utility function used for @ref rank(): adds up the sizes of the subtrees left behind while descending towards x.
+     */
+    template <typename K>
+    std::size_t rank_helper(const K &x) const
+    {
+        static_assert(Balance::counts_subtrees::value, "rank() needs the order_statistics policy, e.g. bst<K, V, std::less<K>, order_statistics<red_black>>");
+        std::size_t smaller{0};
+        auto ptr{head.get()};
+        while (ptr)
+        {
+            if (comp(ptr->data.first, x))
+            {
+                smaller += Balance::subtree_size(ptr->left.get()) + 1;
+                ptr = ptr->right.get();
+            }
+            else
+            {
+                ptr = ptr->left.get();
+            }
+        }
+        return smaller;
+    }
+
+    /**
+     * @brief Utility function used for @ref equal_range(), shared by the constant and non-constant versions. Since the keys are unique, the upper end is the successor of the lower one if it holds x.
+     */
+    template <typename It, typename Tree, typename K>
+    static std::pair<It, It> equal_range_helper(Tree &tree, const K &x)
+    {
+        It first{tree.make_iterator(tree.bound_helper(x, false))};
+        It last{first};
+        if (last != tree.end() && !tree.comp(x, last->first))
+        {
+            ++last;
+        }
+        return std::make_pair(first, last);
+    }
+
+    /**
+     * @brief Utility function used for @ref range(), shared by the constant and non-constant versions.
+     */
+    template <typename It, typename Tree, typename K>
+    static iterator_range<It> range_helper(Tree &tree, const K &a, const K &b)
+    {
+        It first{tree.make_iterator(tree.bound_helper(a, false))};
+        if (first == tree.end() || !tree.comp(first->first, b))
+        { //no key in [a,b); a and b are never compared with each other, since they may be of a type not comparable with itself
+            return iterator_range<It>{tree.end(), tree.end()};
+        }
+        return iterator_range<It>{first, tree.make_iterator(tree.bound_helper(b, false))};
+    }
+
+    /**
+     * @brief Helper (recursive) function to balance the tree.
+     * @param v reference to a constant std::vector with the (ordered) Nodes of the tree, already unlinked from each other
+     * @param a constant long int. Left bound of the subtree
+     * @param b constant long int. Right bound of the subtree
+     * @param parent Raw pointer to the parent of the subtree
+     * It links the middle @ref Node of [a,b] under parent and then links recursively the two halves as its children. Returns the root of the subtree.
+     */
+
+    node_type *balance_helper(const std::vector<node_type *> &v, long int a, long int b, node_type *parent) noexcept
+    {
+        if (a > b)
+        {
+            //            std::exception("Tree is not balancable");
+            //            std::cout<< "Not possible" <<"\n";
+            return nullptr;
+        }
+        else
+        {
+            long int middle{(a + b) / 2};
+            auto ptn = v[middle];
+            ptn->parent = parent;
+            ptn->left.reset(balance_helper(v, a, middle - 1, ptn)); //children have been released, reset doesn't destroy anything
+            ptn->right.reset(balance_helper(v, middle + 1, b, ptn));
+            return ptn;
+        }
+    }
+
+    /**
+     * @brief Reserves room for the Nodes of the range [first,last), when its length can be computed without consuming it.
+     */
+    template <typename It>
+    static void reserve_helper(std::vector<node_type *> &v, It first, It last, std::forward_iterator_tag)
+    {
+        v.reserve(std::distance(first, last));
+    }
+
+    template <typename It>
+    static void reserve_helper(std::vector<node_type *> &, It, It, std::input_iterator_tag) noexcept {}
+
+    /**
+     * @brief Helper function that fills an empty tree with the pairs in [first,last), which must be strictly increasing by key.
+     * One @ref Node is created for each element, in order, and the Nodes are then linked by @ref balance_helper(): the result is a balanced tree built in O(n), without any comparison.
+     * Elements are moved if the range yields r-values (e.g. with `std::make_move_iterator`).
+     */
+    template <typename It>
+    void assign_sorted_helper(It first, It last)
+    {
+        std::vector<node_type *> vec_nodes{};
+        reserve_helper(vec_nodes, first, last, typename std::iterator_traits<It>::iterator_category{});
+        try
+        {
+            for (; first != last; ++first)
+            {
+                vec_nodes.push_back(nullptr); //if this throws, no Node is leaked
+                vec_nodes.back() = create_node(*first, nullptr);
+            }
+        }
+        catch (...)
+        {
+            for (auto ptn : vec_nodes)
+            {
+                if (ptn)
+                {
+                    destroy_node(ptn);
+                }
+            }
+            throw;
+        }
+        relink_helper(vec_nodes);
+    }
+
+    /**
+     * @brief Unlinks every @ref Node of the tree, without destroying any of them, and returns them in key order. The tree is left empty.
+     * The Nodes are collected in a single sweep, rotating left children up as `Node::destroy_subtree()` does, so that each one is unlinked as soon as it's reached. The only allocation is the vector, made before anything is unlinked: if it throws, the tree is untouched.
+     */
+    std::vector<node_type *> release_nodes_helper()
+    {
+        std::vector<node_type *> vec_nodes{};
+        vec_nodes.reserve(bounds.count);
+        auto ptn = head.release();
+        while (ptn)
+        {
+            if (ptn->left)
+            {
+                auto l = ptn->left.release();
+                ptn->left.reset(l->right.release());
+                l->right.reset(ptn);
+                ptn = l;
+            }
+            else
+            {
+                vec_nodes.push_back(ptn); //fits in the reserved room
+                ptn = ptn->right.release();
+            }
+        }
+        bounds = {nullptr, nullptr, 0};
+        return vec_nodes;
+    }
+
+    /**
+     * @brief Links the Nodes in v, which are strictly increasing by key and already unlinked from each other, into a balanced shape that becomes the (empty) tree.
+     */
+    void relink_helper(const std::vector<node_type *> &v) noexcept
+    {
+        if (v.empty())
+        {
+            return;
+        }
+        head.reset(balance_helper(v, 0, v.size() - 1, nullptr));
+        bounds = {v.front(), v.back(), v.size()};
+        Balance::after_rebuild(head); //the shape has been built by hand, restore the bookkeeping of the policy
+    }
+
+    /**
+     * @brief Helper function used in @ref split(): cuts the tree along the path towards x, and returns the roots of the trees with the keys less than x and with the others. The tree is left without Nodes.
+     * The Nodes on the path are joined bottom-up, by `Balance::join()`, with the subtree that hangs from them on the side away from the cut. For the @ref avl policy the costs of the joins add up to O(height), since every join only goes as deep as the difference of the heights of its two trees.
+     */
+    template <typename K>
+    std::pair<node_owner, node_owner> split_helper(const K &x)
+    {
+        std::vector<std::pair<node_type *, bool>> path{}; //the Nodes towards x, and whether each one goes to the left tree
+        for (auto ptn = head.get(); ptn;)
+        {
+            const bool less{comp(ptn->data.first, x)};
+            path.emplace_back(ptn, less);
+            ptn = less ? ptn->right.get() : ptn->left.get();
+        }
+        //from now on nothing can throw, and no comparison is needed
+        head.release();
+        for (auto step : path)
+        {
+            (step.second ? step.first->right : step.first->left).release(); //owned by the next step, which links it again
+        }
+        node_owner less{nullptr, owner_deleter()};
+        node_owner greater{nullptr, owner_deleter()};
+        for (auto step = path.rbegin(); step != path.rend(); ++step)
+        {
+            auto ptn = step->first;
+            if (step->second)
+            {
+                less = Balance::join(std::move(ptn->left), ptn, std::move(less));
+            }
+            else
+            {
+                greater = Balance::join(std::move(greater), ptn, std::move(ptn->right));
+            }
+        }
+        return std::make_pair(std::move(less), std::move(greater));
+    }
+
+    /**
+     * @brief Helper function used in @ref split(): moves into result the Nodes with keys not less than x, and sets the bounds of both trees. The sizes are read from the roots, kept by the @ref order_statistics policy.
+     */
+    template <typename K>
+    void split_into_helper(const K &x, bst &result)
+    {
+        static_assert(Balance::counts_subtrees::value, "split() needs the order_statistics policy, e.g. bst<K, V, std::less<K>, order_statistics<red_black>>");
+        const std::size_t total{bounds.count};
+        auto roots = split_helper(x);
+        head = std::move(roots.first);
+        result.head = std::move(roots.second);
+        update_bounds();
+        result.update_bounds();
+        bounds.count = head ? head->subtree_size : 0;
+        result.bounds.count = total - bounds.count;
+    }
+
+    /**
+     * @brief Helper function used in @ref save() when both serializers copy in bulk: the keys and the values are gathered in blocks of `serial_format::block` and each block is written at once.
+     */
+    void save_pairs_helper(serial_writer &out, std::true_type) const
+    {
+        auto keys = std::make_unique<key_type[]>(serial_format::block); //not std::vector, which packs bool
+        auto values = std::make_unique<value_type[]>(serial_format::block);
+        std::size_t n{0};
+        for (const auto &x : *this)
+        {
+            keys[n] = x.first;
+            values[n] = x.second;
+            if (++n == serial_format::block)
+            {
+                out.write_bytes(keys.get(), n * sizeof(key_type));
+                out.write_bytes(values.get(), n * sizeof(value_type));
+                n = 0;
+            }
+        }
+        out.write_bytes(keys.get(), n * sizeof(key_type));
+        out.write_bytes(values.get(), n * sizeof(value_type));
+    }
+
+    /**
+     * @brief Helper function used in @ref save() when a type has its own serializer: the pairs are written one by one, the key before the value.
+     */
+    void save_pairs_helper(serial_writer &out, std::false_type) const
+    {
+        for (const auto &x : *this)
+        {
+            save_one_helper(out, x.first, std::integral_constant<bool, serializer<key_type>::bulk>{});
+            save_one_helper(out, x.second, std::integral_constant<bool, serializer<value_type>::bulk>{});
+        }
+    }
+
+    template <typename T>
+    static void save_one_helper(serial_writer &out, const T &x, std::true_type)
+    {
+        out.write_value(x);
+    }
+
+    template <typename T>
+    static void save_one_helper(serial_writer &out, const T &x, std::false_type)
+    {
+        serializer<T>::write(out, x);
+    }
+
+    template <typename T>
+    static T load_one_helper(serial_reader &in, std::true_type)
+    {
+        return in.read_value<T>();
+    }
+
+    template <typename T>
+    static T load_one_helper(serial_reader &in, std::false_type)
+    {
+        return serializer<T>::read(in);
+    }
+
+    /**
+     * @brief Helper function used in @ref load() when both serializers copy in bulk: reads the blocks written by @ref save_pairs_helper() and creates one @ref Node per pair, in key order.
+     */
+    void load_pairs_helper(serial_reader &in, std::uint64_t count, std::vector<node_type *> &vec_nodes, std::true_type)
+    {
+        auto keys = std::make_unique<key_type[]>(serial_format::block); //not std::vector, which packs bool
+        auto values = std::make_unique<value_type[]>(serial_format::block);
+        while (count)
+        {
+            const std::size_t n{static_cast<std::size_t>(std::min(count, std::uint64_t{serial_format::block}))};
+            in.read_bytes(keys.get(), n * sizeof(key_type));
+            in.read_bytes(values.get(), n * sizeof(value_type));
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                vec_nodes.push_back(nullptr); //if this throws, no Node is leaked
+                vec_nodes.back() = create_node(nullptr, keys[i], values[i]);
+            }
+            count -= n;
+        }
+    }
+
+    void load_pairs_helper(serial_reader &in, std::uint64_t count, std::vector<node_type *> &vec_nodes, std::false_type)
+    {
+        for (; count; --count)
+        {
+            auto k = load_one_helper<key_type>(in, std::integral_constant<bool, serializer<key_type>::bulk>{});
+            auto v = load_one_helper<value_type>(in, std::integral_constant<bool, serializer<value_type>::bulk>{});
+            vec_nodes.push_back(nullptr);
+            vec_nodes.back() = create_node(nullptr, std::move(k), std::move(v));
+        }
+    }
+
+    /**
+     * @brief Fills the (empty) tree with copies of the pairs of a and b chosen by a set operation, walking the two trees in order at once.
+     * A pair whose key is only in a is copied if `only_a` is true, one whose key is only in b if `only_b` is true, and the pair of a if the key is in both trees and `both` is true. The Nodes are then linked as in @ref assign_sorted_helper(), so the whole operation is O(m + n).
+     */
+    void set_operation_helper(const bst &a, const bst &b, bool only_a, bool both, bool only_b)
+    {
+        std::vector<node_type *> vec_nodes{};
+        vec_nodes.reserve((only_a ? a.size() : 0) + (only_b ? b.size() : 0) + (!only_a && !only_b && both ? std::min(a.size(), b.size()) : 0));
+        auto emit = [this, &vec_nodes](const pair_type &x) {
+            vec_nodes.push_back(nullptr); //if this throws, no Node is leaked
+            vec_nodes.back() = create_node(x, nullptr);
+        };
+        try
+        {
+            auto i = a.cbegin();
+            auto i_stop = a.cend();
+            auto j = b.cbegin();
+            auto j_stop = b.cend();
+            while (i != i_stop && j != j_stop)
+            {
+                if (comp(i->first, j->first))
+                {
+                    if (only_a)
+                    {
+                        emit(*i);
+                    }
+                    ++i;
+                }
+                else if (comp(j->first, i->first))
+                {
+                    if (only_b)
+                    {
+                        emit(*j);
+                    }
+                    ++j;
+                }
+                else
+                {
+                    if (both)
+                    {
+                        emit(*i);
+                    }
+                    ++i;
+                    ++j;
+                }
+            }
+            for (; only_a && i != i_stop; ++i)
+            {
+                emit(*i);
+            }
+            for (; only_b && j != j_stop; ++j)
+            {
+                emit(*j);
+            }
+        }
+        catch (...)
+        {
+            for (auto ptn : vec_nodes)
+            {
+                if (ptn)
+                {
+                    destroy_node(ptn);
+                }
+            }
+            throw;
+        }
+        relink_helper(vec_nodes);
+    }
+
+    /**
+     * @brief Returns true if the keys in [first,last) are strictly increasing. Only used when the range can be traversed twice.
+     */
+    template <typename It>
+    bool is_sorted_helper(It first, It last) const
+    {
+        if (first == last)
+        {
+            return true;
+        }
+        for (auto next = std::next(first); next != last; ++first, ++next)
+        {
+            if (!comp((*first).first, (*next).first))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Fills an empty tree from a range in unknown order: the pairs are moved into a vector, sorted by key and deduplicated (the first occurrence of a key wins, as with repeated @ref insert()), and then moved into the Nodes.
+     */
+    template <typename It>
+    void assign_unsorted_helper(It first, It last)
+    {
+        using sortable_pair = std::pair<typename std::remove_const<key_type>::type, value_type>;
+        std::vector<sortable_pair> v(first, last);
+        auto by_key = [this](const sortable_pair &a, const sortable_pair &b) { return comp(a.first, b.first); };
+        std::stable_sort(v.begin(), v.end(), by_key);
+        auto same_key = [this](const sortable_pair &a, const sortable_pair &b) { return !comp(a.first, b.first) && !comp(b.first, a.first); };
+        v.erase(std::unique(v.begin(), v.end(), same_key), v.end());
+        assign_sorted_helper(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()));
+    }
+
+    template <typename It>
+    void assign_helper(It first, It last, std::forward_iterator_tag)
+    {
+        if (is_sorted_helper(first, last))
+        {
+            assign_sorted_helper(first, last);
+        }
+        else
+        {
+            assign_unsorted_helper(first, last);
+        }
+    }
+
+    template <typename It>
+    void assign_helper(It first, It last, std::input_iterator_tag)
+    {
+        assign_unsorted_helper(first, last); //a single pass is allowed: we can't check the order first
+    }
+
+    /**
+     * @brief Helper function that descends from the head looking for the key x.
+     * Returns the @ref Node with key x and true if there is one, otherwise the @ref Node below which a @ref Node with key x has to be linked (`nullptr` if the tree is empty) and false.
+     */
+    template <typename K>
+    std::pair<node_type *, bool> locate_helper(const K &x) const
+    {
+        auto ptr{head.get()};
+        node_type *parent{nullptr};
+        while (ptr)
+        {
+            if (comp(x, ptr->data.first))
+            {
+                parent = ptr;
+                ptr = ptr->left.get();
+            }
+            else if (comp(ptr->data.first, x))
+            {
+                parent = ptr;
+                ptr = ptr->right.get();
+            }
+            else
+            {
+                return std::make_pair(ptr, true);
+            }
+        }
+        return std::make_pair(parent, false);
+    }
+
+    /**
+     * @brief Like @ref locate_helper(), but starting from hint, the @ref Node before which x is expected to go (@ref end() if x is expected to be the largest key).
+     * If x belongs between the predecessor of hint and hint, the new @ref Node is linked below one of the two without descending from the head: this costs O(1) amortized, e.g. for increasing keys inserted with hint @ref end(). Otherwise it falls back to @ref locate_helper().
+     */
+    template <typename K>
+    std::pair<node_type *, bool> hint_locate_helper(constant_iterator hint, const K &x) const
+    {
+        node_type *h{hint.current};
+        if (!h)
+        { //hint is end(): x should go after the rightmost Node
+            if (bounds.rightmost && comp(bounds.rightmost->data.first, x))
+            {
+                return std::make_pair(bounds.rightmost, false);
+            }
+            return locate_helper(x);
+        }
+        if (comp(x, h->data.first))
+        { //x goes before h: check that it goes after its predecessor
+            if (h == bounds.leftmost)
+            {
+                return std::make_pair(h, false);
+            }
+            node_type *before{(--hint).current};
+            if (comp(before->data.first, x))
+            { //either before has no right child, or h has no left child
+                return std::make_pair(before->right ? h : before, false);
+            }
+            return locate_helper(x);
+        }
+        if (comp(h->data.first, x))
+        { //x goes after h: check that it goes before its successor
+            if (h == bounds.rightmost)
+            {
+                return std::make_pair(h, false);
+            }
+            node_type *after{(++hint).current};
+            if (comp(x, after->data.first))
+            {
+                return std::make_pair(h->right ? after : h, false);
+            }
+            return locate_helper(x);
+        }
+        return std::make_pair(h, true); //x is the key of h
+    }
+
+    /**
+     * @brief Helper function that links the new @ref Node n as a child of parent (as returned by @ref locate_helper()) and hands it to the balancing policy. Nothing is allocated, so it can't fail.
+     * Returns n: the iterators to it stay valid even if the policy rotates it to a different position, since Nodes are never reallocated.
+     */
+    node_type *link_node_helper(node_type *parent, node_type *n) noexcept
+    {
+        n->parent = parent;
+        if (!parent)
+        {
+            head.reset(n);
+            bounds = {n, n, 0};
+        }
+        else if (comp(n->data.first, parent->data.first))
+        {
+            parent->left.reset(n);
+            if (parent == bounds.leftmost)
+            {
+                bounds.leftmost = n;
+            }
+        }
+        else
+        {
+            parent->right.reset(n);
+            if (parent == bounds.rightmost)
+            {
+                bounds.rightmost = n;
+            }
+        }
+        ++bounds.count;
+        Balance::after_insert(head, n);
+        return n;
+    }
+
+    /**
+     * @brief Helper function used in @ref insert() that exploit forwarding reference to take both l-values and r-values references. Code duplication is hence avoided. In this way the user can just call the @ref insert() function and doesn't have to care about the type of the argument.
+     * @param x Forwarding reference with the 'pair_type' to be inserted.
+     * The @ref Node is created only if the key is not in the tree.
+     * @see insert()
+     */
+    template <typename O>
+    std::pair<iterator, bool> insert_helper(O &&x)
+    {
+        auto found = locate_helper(x.first);
+        if (found.second)
+        {
+            return std::make_pair(make_iterator(found.first), false);
+        }
+        return std::make_pair(make_iterator(link_node_helper(found.first, create_node(std::forward<O>(x), nullptr))), true);
+    }
+
+    /**
+     * @brief Helper function used in the hinted @ref insert().
+     */
+    template <typename O>
+    iterator hint_insert_helper(constant_iterator hint, O &&x)
+    {
+        auto found = hint_locate_helper(hint, x.first);
+        if (found.second)
+        {
+            return make_iterator(found.first);
+        }
+        return make_iterator(link_node_helper(found.first, create_node(std::forward<O>(x), nullptr)));
+    }
+
+    /**
+     * @brief Helper function used in @ref try_emplace(): the value is constructed from args, and the key from k, only if k is not in the tree.
+     */
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_helper(K &&k, Args &&...args)
+    {
+        auto found = locate_helper(k);
+        if (found.second)
+        {
+            return std::make_pair(make_iterator(found.first), false);
+        }
+        auto n = create_node(nullptr, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(k)), std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::make_pair(make_iterator(link_node_helper(found.first, n)), true);
+    }
+
+    /**
+     * @brief Helper function used in @ref insert_or_assign().
+     */
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign_helper(K &&k, M &&obj)
+    {
+        auto found = locate_helper(k);
+        if (found.second)
+        {
+            found.first->data.second = std::forward<M>(obj);
+            return std::make_pair(make_iterator(found.first), false);
+        }
+        auto n = create_node(nullptr, std::forward<K>(k), std::forward<M>(obj));
+        return std::make_pair(make_iterator(link_node_helper(found.first, n)), true);
+    }
+
+    /**
+     * @brief Helper function that unlinks the @ref Node z from the tree and returns it, without destroying it.
+     * @param z Raw pointer to the @ref Node to be removed.
+     * If z has two children, its in-order successor is moved (by relinking, not by copying) in its position. The balancing policy is then informed about the @ref Node that took the place of the one physically removed.
+     */
+    node_type *unlink_helper(node_type *z) noexcept
+    {
+        node_type *x;        //Node that takes the place of the physically removed one (maybe nullptr)
+        node_type *x_parent; //parent of x
+        int removed_data{z->balance_data};
+        if (z == bounds.leftmost)
+        { //z has no left child: the new leftmost is its successor
+            bounds.leftmost = z->parent;
+            if (z->right)
+            {
+                bounds.leftmost = z->right.get();
+                while (bounds.leftmost->left)
+                {
+                    bounds.leftmost = bounds.leftmost->left.get();
+                }
+            }
+        }
+        if (z == bounds.rightmost)
+        { //z has no right child: the new rightmost is its predecessor
+            bounds.rightmost = z->parent;
+            if (z->left)
+            {
+                bounds.rightmost = z->left.get();
+                while (bounds.rightmost->right)
+                {
+                    bounds.rightmost = bounds.rightmost->right.get();
+                }
+            }
+        }
+        if (!z->left || !z->right)
+        { //at most one child: its child takes its place
+            auto &slot = Balance::owner(head, z);
+            node_owner child{z->left ? std::move(z->left) : std::move(z->right)};
+            x = child.get();
+            x_parent = z->parent;
+            if (x)
+            {
+                x->parent = x_parent;
+            }
+            slot.release(); //slot owned z
+            slot = std::move(child);
+        }
+        else
+        { //two children: the successor y takes the place of z
+            auto y = z->right.get();
+            while (y->left)
+            {
+                y = y->left.get();
+            }
+            removed_data = y->balance_data;
+            x = y->right.get();
+            node_owner y_owner{nullptr, owner_deleter()};
+            if (y->parent == z)
+            {
+                x_parent = y;
+                y_owner = std::move(z->right);
+            }
+            else
+            {
+                x_parent = y->parent;
+                y_owner = std::move(x_parent->left); //y is always a left child here
+                x_parent->left = std::move(y->right);
+                if (x)
+                {
+                    x->parent = x_parent;
+                }
+                y->right = std::move(z->right);
+                y->right->parent = y;
+            }
+            y->left = std::move(z->left);
+            y->left->parent = y;
+            y->parent = z->parent;
+            y->balance_data = z->balance_data;
+            auto &slot = Balance::owner(head, z);
+            slot.release(); //slot owned z
+            slot = std::move(y_owner);
+        }
+        --bounds.count;
+        Balance::after_erase(head, x, x_parent, removed_data);
+        return z;
+    }
+
+    /**
+     * @brief Helper function used in @ref erase(): unlinks and destroys the @ref Node found by the lookup, if any. Returns the number of Nodes erased.
+     */
+    std::size_t erase_helper(node_type *locator) noexcept
+    {
+        if (!locator)
+        {
+            return 0;
+        }
+        destroy_node(unlink_helper(locator));
+        return 1;
+    }
+
+    /**
+     * @brief Helper private function that uses forwarding references for the subscript operator.
+     * @param x Forwarding reference, to be forwarded using `std::forward<O>(x)`
+     * @see @ref operator[]
+     */
+    template <typename O> //forwarding reference
+    value_type &subscript_helper(O &&x)
+    {
+        return try_emplace_helper(std::forward<O>(x)).first->second; //the value is value-initialized only if x is missing
+    }
+
+public:
+    /**
+     * @brief Default constructor for the tree.
+     */
+    bst() : comp{}, alloc{}, head{nullptr, owner_deleter()} {}
+
+    /**
+     * @brief Constructs an empty tree that allocates its Nodes with a (copy of) a.
+     * @param a The allocator, e.g. a `pool_allocator` or a `std::pmr::polymorphic_allocator`
+     */
+    explicit bst(const Alloc &a) : comp{}, alloc{a}, head{nullptr, owner_deleter()} {}
+
+    /**
+     * @brief Builds a balanced tree with the pairs in [first,last).
+     * If the keys are already strictly increasing the tree is built in O(n), otherwise the pairs are sorted first (O(n log n)). For duplicate keys only the first pair is kept.
+     */
+    template <typename InputIt>
+    bst(InputIt first, InputIt last, const Alloc &a = Alloc{}) : comp{}, alloc{a}, head{nullptr, owner_deleter()}
+    {
+        assign_helper(first, last, typename std::iterator_traits<InputIt>::iterator_category{});
+    }
+
+    /**
+     * @brief Builds a balanced tree in O(n) with the pairs in [first,last), which the caller guarantees to be strictly increasing by key.
+     * Use `std::make_move_iterator` to move the values into the tree.
+     */
+    template <typename InputIt>
+    bst(sorted_unique_t, InputIt first, InputIt last, const Alloc &a = Alloc{}) : comp{}, alloc{a}, head{nullptr, owner_deleter()}
+    {
+        assign_sorted_helper(first, last);
+    }
+
+    /**
+     * @brief Builds a balanced tree with the pairs in [first,last), in any order, using up to `policy.threads` threads, e.g. `bst<int, int> tree{v.begin(), v.end(), parallel_build{8}};`
+     * The pairs are sorted by slices that are then merged in parallel, and the subtrees below the first levels of medians are built by separate tasks. As with the sequential constructor, for duplicate keys only the first pair is kept.
+     */
+    template <typename InputIt>
+    bst(InputIt first, InputIt last, parallel_build policy, const Alloc &a = Alloc{}) : comp{}, alloc{a}, head{nullptr, owner_deleter()}
+    {
+        parallel_assign_helper(first, last, policy.threads);
+    }
+
+    /**
+     * @brief Destructor. The Nodes are given back to the allocator by @ref clear().
+     */
+    ~bst() noexcept
+    {
+        clear();
+    }
+
+    /**
+     * @brief Returns a copy of the allocator of the tree.
+     */
+    Alloc get_allocator() const noexcept
+    {
+        return Alloc(alloc);
+    }
+
+    /**
+     * @brief Returns a copy of the comparison operator of the tree.
+     */
+    OP key_comp() const
+    {
+        return comp;
+    }
+
+    /**
+     * @brief Move constructor. Avoiding the default-generated one for didactit purposes.
+     */
+    bst(bst &&t) noexcept : comp{std::move(t.comp)}, alloc{t.alloc}, head{std::move(t.head)}, bounds{t.bounds}
+    {
+        //        t.clear();
+        t.bounds = {nullptr, nullptr, 0};
+    }
+
+    /**
+     * @brief Move assignment. Avoiding the default-generated one for didactit purposes.
+     */
+    bst &operator=(bst &&t) noexcept(node_traits::propagate_on_container_move_assignment::value)
+    {
+        if (this == &t)
+        {
+            return *this;
+        }
+        clear();
+        comp = std::move(t.comp);
+        move_helper(t, typename node_traits::propagate_on_container_move_assignment{});
+        //        t.clear();
+        return *this;
+    }
+
+    /* Uncomment to use the default-generated (and recommended) version
+     bst(bst&& t) noexcept  = default;
+     
+     bst& operator=(bst&& t) noexcept = default; */
+
+    /**
+     * @brief Copy constructor.
+     */
+    explicit bst(const bst &tree) : comp{tree.comp}, alloc{node_traits::select_on_container_copy_construction(tree.alloc)}, head{nullptr, owner_deleter()}
+    {
+        //        head=std::make_unique<Node<pair_type>>(tree.head,nullptr);
+        copy_from(tree); //Nodes are copied with the allocator of this tree
+    }
+
+    /**
+     * @brief Parallel copy constructor: the subtrees below the first levels of tree are copied concurrently.
+     * @param tree The tree to be copied
+     * @param policy Number of threads to use, e.g. `bst<int, int> snapshot{tree, parallel_copy{8}};`
+     * It pays off on large trees. Only used if the allocator is thread-safe (`std::allocator` is), otherwise the copy is sequential.
+     */
+    bst(const bst &tree, parallel_copy policy) : comp{tree.comp}, alloc{node_traits::select_on_container_copy_construction(tree.alloc)}, head{nullptr, owner_deleter()}
+    {
+        parallel_copy_from(tree, policy.threads);
+    }
+
+    /**
+     * @brief Copy assignment.
+     */
+    bst &operator=(const bst &tree)
+    {
+        if (this == &tree)
+        {
+            return *this;
+        }
+        this->clear();
+        this->comp = tree.comp;
+        copy_alloc_helper(tree, typename node_traits::propagate_on_container_copy_assignment{});
+        copy_from(tree); //if it throws, the tree is left empty
+        return *this;
+    }
+
+    //    explicit bst(const bst& tree): comp{tree.comp},head{std::unique_ptr<Node<pair_type>> (new Node<pair_type>(tree.head.get()->data,nullptr))  } {
+    //        if (tree.head.get()->left) {
+    //            copy_helper(tree.head.get()->left);
+    //        }
+    //        if (tree.head.get()->right) {
+    //            copy_helper(tree.head.get()->right);
+    //        }
+    //    }
+
+    //    bst& operator=(const bst& tree) {
+    ////        std::cout << "Call to copy assignment";
+    //        this->clear();
+    //        this->insert(tree.head.get()->data);
+    //        if (tree.head.get()->left) {
+    //            copy_helper(tree.head.get()->left);
+    //        }
+    //        if (tree.head.get()->right) {
+    //            copy_helper(tree.head.get()->right);
+    //        }
+    //        return *this;
+    //    }
+
+    /**
+     * @brief Returns an @ref Iterator to the first @ref Node of the tree, which is the leftmost. It's O(1), since the leftmost @ref Node is cached in the header of the tree.
+     */
+    iterator begin() noexcept
+    {
+        //        std::cout << "Calling begin" <<"\n";
+        return make_iterator(bounds.leftmost);
+    }
+
+    /**
+     * @brief Returns a @ref constant_iterator to the first @ref Node of the tree. It's automatically applied when the tree is const-qualified and I call @ref begin()
+     */
+
+    constant_iterator begin() const noexcept
+    {
+        //        std::cout << "Calling const begin" <<"\n";
+        return make_iterator(bounds.leftmost);
+    }
+
+    /**
+     * @brief Returns a @ref constant_iterator to the first @ref Node of the tree. It must be used unconditionally when the tree is const-qualified.
+     */
+    constant_iterator cbegin() const noexcept
+    {
+        //        std::cout << "Calling cbegin" <<"\n";
+        return make_iterator(bounds.leftmost);
+    }
+
+    /**
+     * @brief Returns a constant @ref Iterator to one-past-the-last @ref Node of the tree. It can be decremented to reach the last @ref Node.
+     */
+    iterator end() noexcept
+    {
+        //        std::cout << "Calling end" <<"\n";
+        return make_iterator(nullptr);
+    }
+
+    /**
+     * @brief Returns a @ref constant_iterator to one-past-the-last @ref Node of the tree. It's automatically applied when the tree is const-qualified and I call @ref end.
+     */
+    constant_iterator end() const noexcept
+    {
+        //        std::cout <<"Calling  const end"<< "\n";
+        return make_iterator(nullptr);
+    }
+
+    /**
+     * @brief Returns a constant @ref Iterator to one-past-the-last @ref Node of the tree. It must be used unconditionally when the tree is const-qualified.
+     */
+    constant_iterator cend() const noexcept
+    {
+        //        std::cout <<"Calling cend"<< "\n";
+        return make_iterator(nullptr);
+    }
+
+    /**
+     * @brief Returns a reverse iterator to the last @ref Node of the tree, in O(1).
+     */
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator{end()};
+    }
+
+    constant_reverse_iterator rbegin() const noexcept
+    {
+        return constant_reverse_iterator{end()};
+    }
+
+    constant_reverse_iterator crbegin() const noexcept
+    {
+        return constant_reverse_iterator{cend()};
+    }
+
+    /**
+     * @brief Returns a reverse iterator to one-before-the-first @ref Node of the tree.
+     */
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator{begin()};
+    }
+
+    constant_reverse_iterator rend() const noexcept
+    {
+        return constant_reverse_iterator{begin()};
+    }
+
+    constant_reverse_iterator crend() const noexcept
+    {
+        return constant_reverse_iterator{cbegin()};
+    }
+
+    /**
+     *
+     * @brief Insert a new @ref Node in the tree with pair x
+     * @param x Const l-value reference to a pair with a key and a value
+     * Returns a std::pair with an @ref _iterator and a bool which is true if the node has been inserted, false otherwise.
+     */
+    std::pair<iterator, bool> insert(const pair_type &x)
+    {
+        //    std::cout <<"l-value insert"<<"\n";
+        return insert_helper(x);
+    }
+
+    /**
+     * @brief Insert a new @ref Node in the tree with pair x
+     * @param x r-value reference to a pair with a node and a value
+     * Returns a std::pair with an @ref _iterator and a bool which is true if the node has been inserted, false otherwise.
+     */
+
+    std::pair<iterator, bool> insert(pair_type &&x)
+    {
+        //    std::cout <<"r-value insert"<<"\n";
+        return insert_helper(std::move(x));
+    }
+
+    /**
+     * @brief Insert a new @ref Node with pair x, using hint as a suggestion for the position: the @ref Node before which x should go (@ref end() to append).
+     * If the hint is right the insertion costs O(1) amortized (plus the rebalancing), otherwise it's a normal insertion. Returns an @ref _iterator to the @ref Node with the key of x, new or not.
+     */
+    iterator insert(constant_iterator hint, const pair_type &x)
+    {
+        return hint_insert_helper(hint, x);
+    }
+
+    iterator insert(constant_iterator hint, pair_type &&x)
+    {
+        return hint_insert_helper(hint, std::move(x));
+    }
+
+    /**
+     * @brief Like @ref emplace(), but the position of the new @ref Node is searched starting from hint (see the hinted @ref insert()).
+     */
+    template <class... Types>
+    iterator emplace_hint(constant_iterator hint, Types &&...args)
+    {
+        auto n = create_node(nullptr, std::forward<Types>(args)...);
+        std::pair<node_type *, bool> found;
+        try
+        {
+            found = hint_locate_helper(hint, n->data.first);
+        }
+        catch (...)
+        {
+            destroy_node(n);
+            throw;
+        }
+        if (found.second)
+        {
+            destroy_node(n);
+            return make_iterator(found.first);
+        }
+        return make_iterator(link_node_helper(found.first, n));
+    }
+
+    /**
+     * @brief Replaces the content of the tree with the pairs in [first,last). See the range constructor.
+     */
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last)
+    {
+        clear();
+        assign_helper(first, last, typename std::iterator_traits<InputIt>::iterator_category{});
+    }
+
+    /**
+     * @brief Replaces the content of the tree with the pairs in [first,last), which must be strictly increasing by key. It runs in O(n).
+     */
+    template <typename InputIt>
+    void assign(sorted_unique_t, InputIt first, InputIt last)
+    {
+        clear();
+        assign_sorted_helper(first, last);
+    }
+
+    /**
+     * @brief Inserts a new element into the container constructed in-place with the given args if there is no element with the key in the container.
+     * @param args arguments to be *unpacked*
+     * The pair is constructed directly inside a new @ref Node (it's like if we apply ‘std::forward<Types>(args)‘ to each element of the pair), so nothing is copied. As for `std::map`, the @ref Node is created before the lookup, since the key is known only then: it's destroyed if the key is already present. Use @ref try_emplace() to avoid that.
+     */
+    template <class... Types> //packing all the arguments
+    std::pair<iterator, bool> emplace(Types &&...args)
+    { //forwarding reference
+        auto n = create_node(nullptr, std::forward<Types>(args)...);
+        std::pair<node_type *, bool> found;
+        try
+        {
+            found = locate_helper(n->data.first);
+        }
+        catch (...)
+        {
+            destroy_node(n);
+            throw;
+        }
+        if (found.second)
+        {
+            destroy_node(n);
+            return std::make_pair(make_iterator(found.first), false);
+        }
+        return std::make_pair(make_iterator(link_node_helper(found.first, n)), true);
+    }
+
+    /**
+     * @brief If the key k is not in the tree, inserts a @ref Node with key k and a value constructed in place from args. Otherwise nothing happens: in particular args are not moved from.
+     * Returns a std::pair with an @ref _iterator to the @ref Node with key k and a bool which is true if the @ref Node has been inserted.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type &k, Args &&...args)
+    {
+        return try_emplace_helper(k, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type &&k, Args &&...args)
+    {
+        return try_emplace_helper(std::move(k), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief If the key k is in the tree, assigns obj to its value, otherwise inserts a @ref Node with key k and value obj.
+     * Returns a std::pair with an @ref _iterator to the @ref Node with key k and a bool which is true if the @ref Node has been inserted, false if the value has been assigned.
+     */
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const key_type &k, M &&obj)
+    {
+        return insert_or_assign_helper(k, std::forward<M>(obj));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(key_type &&k, M &&obj)
+    {
+        return insert_or_assign_helper(std::move(k), std::forward<M>(obj));
+    }
+
+    /**
+     * @brief Returns an @ref _iterator to the @ref Node with key k, inserting it with a value-initialized value if it's missing, and a bool which is true if the @ref Node has been inserted. Like @ref operator[], it needs a single descent.
+     */
+    std::pair<iterator, bool> find_or_insert(const key_type &k)
+    {
+        BST_TRACE("Calling l-value find_or_insert");
+        return try_emplace_helper(k);
+    }
+
+    std::pair<iterator, bool> find_or_insert(key_type &&k)
+    {
+        BST_TRACE("Calling r-value find_or_insert");
+        return try_emplace_helper(std::move(k));
+    }
+
+    /**
+     * @brief Find a given key. If it's present, returns a @ref _iterator to the node with that key, otherwise @ref end(). It uses the helper function @ref find_helper to avoid code duplication
+     * @param x The key to be searched in the tree.
+     */
+    iterator find(const key_type &x)
+    {
+        return make_iterator(find_helper(x));
+    }
+
+    /**
+     * @brief Find a given key in a constant tree. If it's present, returns a @ref iterator to the node with that key, otherwise @ref end(). It uses the helper function @ref find_helper to avoid code duplication
+     * @param x The key to be searched in the tree.
+     */
+    constant_iterator find(const key_type &x) const
+    {
+        // std::cout << "Call to constant find" << "\n";
+        return make_iterator(find_helper(x));
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref find(): the keys are compared directly with x, without building a `key_type`. Available only if `OP::is_transparent` exists.
+     * @param x Object comparable with the keys, e.g. a `const char*` when the keys are `std::string` and OP is `std::less<>`
+     */
+    template <typename K, if_transparent<K> = 0>
+    iterator find(const K &x)
+    {
+        return make_iterator(find_helper(x));
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref find() in a constant tree.
+     */
+    template <typename K, if_transparent<K> = 0>
+    constant_iterator find(const K &x) const
+    {
+        return make_iterator(find_helper(x));
+    }
+
+    /**
+     * @brief Returns the number of Nodes in the tree, in O(1).
+     */
+    std::size_t size() const noexcept
+    {
+        return bounds.count;
+    }
+
+    /**
+     * @brief Returns true if the tree has no Nodes.
+     */
+    bool empty() const noexcept
+    {
+        return !head;
+    }
+
+    /**
+     * @brief Returns the number of keys less than x, in O(height). Needs the @ref order_statistics policy.
+     * @param x The key, which may or may not be in the tree
+     */
+    std::size_t rank(const key_type &x) const
+    {
+        return rank_helper(x);
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref rank(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    std::size_t rank(const K &x) const
+    {
+        return rank_helper(x);
+    }
+
+    /**
+     * @brief Returns an @ref iterator to the Node with the k-th smallest key (starting from 0), or @ref end() if k is not smaller than @ref size(). O(height), needs the @ref order_statistics policy.
+     */
+    iterator select(std::size_t k)
+    {
+        return make_iterator(select_helper(k));
+    }
+
+    constant_iterator select(std::size_t k) const
+    {
+        return make_iterator(select_helper(k));
+    }
+
+    /**
+     * @brief Returns an @ref iterator to a Node chosen uniformly at random with the generator g, or @ref end() if the tree is empty. O(height), needs the @ref order_statistics policy.
+     * @param g A uniform random bit generator, e.g. `std::mt19937`
+     */
+    template <typename URBG>
+    iterator sample(URBG &g)
+    {
+        return empty() ? end() : select(std::uniform_int_distribution<std::size_t>{0, size() - 1}(g));
+    }
+
+    template <typename URBG>
+    constant_iterator sample(URBG &g) const
+    {
+        return empty() ? cend() : select(std::uniform_int_distribution<std::size_t>{0, size() - 1}(g));
+    }
+
+    /**
+     * @brief Returns an @ref iterator to the first Node whose key is not less than x, or @ref end().
+     * @param x The key to be searched in the tree.
+     */
+    iterator lower_bound(const key_type &x)
+    {
+        return make_iterator(bound_helper(x, false));
+    }
+
+    constant_iterator lower_bound(const key_type &x) const
+    {
+        return make_iterator(bound_helper(x, false));
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref lower_bound(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    iterator lower_bound(const K &x)
+    {
+        return make_iterator(bound_helper(x, false));
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    constant_iterator lower_bound(const K &x) const
+    {
+        return make_iterator(bound_helper(x, false));
+    }
+
+    /**
+     * @brief Returns an @ref iterator to the first Node whose key is greater than x, or @ref end().
+     * @param x The key to be searched in the tree.
+     */
+    iterator upper_bound(const key_type &x)
+    {
+        return make_iterator(bound_helper(x, true));
+    }
+
+    constant_iterator upper_bound(const key_type &x) const
+    {
+        return make_iterator(bound_helper(x, true));
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref upper_bound(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    iterator upper_bound(const K &x)
+    {
+        return make_iterator(bound_helper(x, true));
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    constant_iterator upper_bound(const K &x) const
+    {
+        return make_iterator(bound_helper(x, true));
+    }
+
+    /**
+     * @brief Returns the pair (@ref lower_bound(x), @ref upper_bound(x)): the range of the Nodes with key x, which is empty or holds a single Node.
+     */
+    std::pair<iterator, iterator> equal_range(const key_type &x)
+    {
+        return equal_range_helper<iterator>(*this, x);
+    }
+
+    std::pair<constant_iterator, constant_iterator> equal_range(const key_type &x) const
+    {
+        return equal_range_helper<constant_iterator>(*this, x);
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref equal_range(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    std::pair<iterator, iterator> equal_range(const K &x)
+    {
+        return equal_range_helper<iterator>(*this, x);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    std::pair<constant_iterator, constant_iterator> equal_range(const K &x) const
+    {
+        return equal_range_helper<constant_iterator>(*this, x);
     }
 
     /**
-     * @brief Helper function used in @ref insert() that exploit forwarding reference to take both l-values and r-values references. Code duplication is hence avoided. In this way the user can just call the @ref insert() function and doesn't have to care about the type of the argument.
-     * @param x Forwarding reference with the 'pair_type' to be inserted.
-     * @see insert()
+     * @brief Returns a view of the Nodes whose keys are in [a,b), to be used e.g. in a range-based for loop. Finding the two ends costs O(height); the view is empty if b is not greater than a.
      */
-    template <typename O>
-    std::pair<iterator, bool> insert_helper(O &&x)
+    iterator_range<iterator> range(const key_type &a, const key_type &b)
     {
-        auto ptr{head.get()};
-        while (ptr)
-        {
-            if (comp(x.first, ptr->data.first))
-            {
-                if (ptr->left)
-                {
-                    ptr = ptr->left.get();
-                }
-                else
-                {
-                    ptr->left.reset(new Node<pair_type>{std::forward<O>(x), ptr});
-                    return std::make_pair<iterator, bool>(iterator{ptr->left.get()}, true);
-                }
-            }
-            else if (comp(ptr->data.first, x.first))
-            {
-                if (ptr->right)
-                {
-                    ptr = ptr->right.get();
-                }
-                else
-                {
-                    ptr->right.reset(new Node<pair_type>{std::forward<O>(x), ptr});
-                    return std::make_pair<iterator, bool>(iterator{ptr->right.get()}, true);
-                }
-            }
-            else
-            {
-                return std::make_pair<iterator, bool>(iterator{ptr}, false);
-            }
-        }
-        head.reset(new Node<pair_type>{std::forward<O>(x), nullptr});
-        return std::make_pair<iterator, bool>(iterator{head.get()}, true);
+        return range_helper<iterator>(*this, a, b);
+    }
+
+    iterator_range<constant_iterator> range(const key_type &a, const key_type &b) const
+    {
+        return range_helper<constant_iterator>(*this, a, b);
     }
 
     /**
-     * @brief Helper private function that uses forwarding references for the subscript operator.
-     * @param x Forwarding reference, to be forwarded using `std::forward<O>(x)`
-     * @see @ref operator[]
+     * @brief Heterogeneous version of @ref range(). Available only if `OP::is_transparent` exists.
      */
-    template <typename O> //forwarding reference
-    value_type &subscript_helper(O &&x)
+    template <typename K, if_transparent<K> = 0>
+    iterator_range<iterator> range(const K &a, const K &b)
     {
-        auto isfound = find_helper(std::forward<O>(x));
-        if (isfound)
-        {
-            return isfound->data.second;
-        }
-        else
-        { //key not found in tree
-            auto a = pair_type{std::forward<O>(x), value_type{}};
-            return insert(a).first->second; //l-value semantic used since a is a named object
-        }
+        return range_helper<iterator>(*this, a, b);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    iterator_range<constant_iterator> range(const K &a, const K &b) const
+    {
+        return range_helper<constant_iterator>(*this, a, b);
     }
 
-public:
     /**
-     * @brief Default constructor for the tree.
+     * @brief Looks up every key in [first,last) and writes, in the same order, an @ref iterator to its Node (or @ref end() if it's missing) to out.
+     * The lookups are interleaved in groups of `group` keys (see @ref find_batch_helper), which pays off when the tree doesn't fit in the cache. Keys of another type are compared as they are if the comparator is transparent, and converted to key_type once each otherwise, as @ref find() would do. Returns the output iterator past the last element written.
      */
-    bst() : comp{}, head{nullptr} {}
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt find_batch(ForwardIt first, ForwardIt last, OutputIt out, std::size_t group = 16)
+    {
+        find_batch_helper(first, last, group, [this, &out](node_type *ptn) { *out++ = make_iterator(ptn); }, batch_as_is<ForwardIt>{});
+        return out;
+    }
 
     /**
-     * @brief Move constructor. Avoiding the default-generated one for didactit purposes.
+     * @brief Const version of @ref find_batch(), writing @ref constant_iterator.
      */
-    bst(bst &&t) noexcept : comp{std::move(t.comp)}, head{std::move(t.head)}
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt find_batch(ForwardIt first, ForwardIt last, OutputIt out, std::size_t group = 16) const
     {
-        //        t.clear();
+        find_batch_helper(first, last, group, [this, &out](node_type *ptn) { *out++ = make_iterator(ptn); }, batch_as_is<ForwardIt>{});
+        return out;
     }
 
     /**
-     * @brief Move assignment. Avoiding the default-generated one for didactit purposes.
+     * @brief Erase the @ref Node with key x, if any. Returns the number of Nodes erased (0 or 1).
+     * @param x constant reference to a key
+     * The @ref Node is unlinked by relinking its neighbours (its in-order successor takes its place if it has two children): nothing is allocated and no pair is copied.
      */
-    bst &operator=(bst &&t) noexcept
+    std::size_t erase(const key_type &x)
     {
-        comp = std::move(t.comp);
-        head = std::move(t.head);
-        //        t.clear();
-        return *this;
+        return erase_helper(find_helper(x));
     }
 
-    /* Uncomment to use the default-generated (and recommended) version
-     bst(bst&& t) noexcept  = default;
-     
-     bst& operator=(bst&& t) noexcept = default; */
-
     /**
-     * @brief Copy constructor.
+     * @brief Heterogeneous version of @ref erase(). Available only if `OP::is_transparent` exists.
+     * @param x Object comparable with the keys
      */
-    explicit bst(const bst &tree) : comp{tree.comp}
+    template <typename K, if_transparent<K> = 0>
+    std::size_t erase(const K &x)
     {
-        //        head=std::make_unique<Node<pair_type>>(tree.head,nullptr);
-        head = std::unique_ptr<Node<pair_type>>(new Node<pair_type>(tree.head, nullptr)); //call to recursive function in Node.h
+        return erase_helper(find_helper(x));
     }
 
     /**
-     * @brief Copy assignment.
+     * @brief Erase the @ref Node pointed by pos, which must be a valid and dereferenceable iterator of this tree. Returns an @ref iterator to the following Node (or @ref end()).
+     * The iterators to the other Nodes stay valid.
      */
-    bst &operator=(const bst &tree)
+    iterator erase(iterator pos)
     {
-        this->clear();
-        this->comp = tree.comp;
-        this->head = std::make_unique<Node<pair_type>>(tree.head, nullptr);
-        return *this;
+        return erase(constant_iterator{pos.current, &bounds});
     }
 
-    //    explicit bst(const bst& tree): comp{tree.comp},head{std::unique_ptr<Node<pair_type>> (new Node<pair_type>(tree.head.get()->data,nullptr))  } {
-    //        if (tree.head.get()->left) {
-    //            copy_helper(tree.head.get()->left);
-    //        }
-    //        if (tree.head.get()->right) {
-    //            copy_helper(tree.head.get()->right);
-    //        }
-    //    }
-
-    //    bst& operator=(const bst& tree) {
-    ////        std::cout << "Call to copy assignment";
-    //        this->clear();
-    //        this->insert(tree.head.get()->data);
-    //        if (tree.head.get()->left) {
-    //            copy_helper(tree.head.get()->left);
-    //        }
-    //        if (tree.head.get()->right) {
-    //            copy_helper(tree.head.get()->right);
-    //        }
-    //        return *this;
-    //    }
+    iterator erase(constant_iterator pos)
+    {
+        auto ptn = pos.current;
+        ++pos; //the successor is not moved by the unlinking, so pos stays valid
+        destroy_node(unlink_helper(ptn));
+        return make_iterator(pos.current);
+    }
 
     /**
-     * @brief Returns an @ref Iterator to the first @ref Node of the tree, which is the leftmost.
+     * @brief Erase the Nodes in [first,last). Returns last as an @ref iterator.
      */
-    iterator begin() noexcept
+    iterator erase(constant_iterator first, constant_iterator last)
     {
-        //        std::cout << "Calling begin" <<"\n";
-        if (!head)
-        {
-            return iterator{nullptr};
-        }
-        auto ptr{head.get()};
-        while (ptr->left)
+        while (first != last)
         {
-            ptr = ptr->left.get();
+            first = constant_iterator{erase(first).current, &bounds};
         }
-        return iterator{ptr};
+        return make_iterator(last.current);
     }
 
     /**
-     * @brief Returns a @ref constant_iterator to the first @ref Node of the tree. It's automatically applied when the tree is const-qualified and I call @ref begin()
+     * @brief Moves into the tree every @ref Node of source whose key is missing, without copying or allocating any @ref Node. The Nodes whose key is already in the tree stay in source, as with `std::map::merge()`.
+     * All the Nodes of source are unlinked at once, in key order, and each one is then either linked here, after a search that mostly revisits the Nodes of the previous one, or kept aside. The kept Nodes are finally relinked into a balanced source. It costs O(m log(n + m)) comparisons and O(m) extra memory.
+     * If the two allocators compare different, the pairs are copied into new Nodes and those of source are destroyed. If that, or a comparison, throws, the Nodes not moved yet are given back to source.
      */
-
-    constant_iterator begin() const noexcept
+    void merge(bst &source)
     {
-        //        std::cout << "Calling const begin" <<"\n";
-        if (!head)
+        if (&source == this || source.empty())
         {
-            return constant_iterator{nullptr};
+            return;
         }
-        auto ptr{head.get()};
-        while (ptr->left)
+        const bool steal{alloc == source.alloc};
+        if (empty() && steal)
         {
-            ptr = ptr->left.get();
+            head = std::move(source.head);
+            bounds = source.bounds;
+            source.bounds = {nullptr, nullptr, 0};
+            return;
         }
-        return constant_iterator{ptr};
-    }
-
-    /**
-     * @brief Returns a @ref constant_iterator to the first @ref Node of the tree. It must be used unconditionally when the tree is const-qualified.
-     */
-    constant_iterator cbegin() const noexcept
-    {
-        //        std::cout << "Calling cbegin" <<"\n";
-        if (!head)
+        std::vector<node_type *> kept{};
+        kept.reserve(source.bounds.count);
+        auto nodes = source.release_nodes_helper();
+        std::size_t i{0};
+        try
         {
-            return constant_iterator{nullptr};
+            for (; i < nodes.size(); ++i)
+            {
+                auto ptn = nodes[i];
+                auto found = locate_helper(ptn->data.first);
+                if (found.second)
+                {
+                    kept.push_back(ptn);
+                }
+                else if (steal)
+                {
+                    ptn->subtree_size = 1; //link_node_helper() expects a fresh Node
+                    link_node_helper(found.first, ptn);
+                }
+                else
+                {
+                    link_node_helper(found.first, create_node(ptn->data, nullptr));
+                    source.destroy_node(ptn);
+                }
+            }
         }
-        auto ptr{head.get()};
-        while (ptr->left)
+        catch (...)
         {
-            ptr = ptr->left.get();
+            kept.insert(kept.end(), nodes.begin() + i, nodes.end()); //fits in the reserved room
+            source.relink_helper(kept);
+            throw;
         }
-        return constant_iterator{ptr};
+        source.relink_helper(kept);
+    }
+
+    void merge(bst &&source)
+    {
+        merge(source);
     }
 
     /**
-     * @brief Returns a constant @ref Iterator to one-past-the-last @ref Node of the tree.
+     * @brief Returns a balanced tree with the keys that are in a or in b. If a key is in both trees, its pair is copied from a.
+     * The two trees are walked in order at once, so it costs O(m + n) and no comparison is spent on building the result. Found by argument-dependent lookup: call it as `set_union(a, b)`.
      */
-    iterator end() noexcept
+    friend bst set_union(const bst &a, const bst &b)
     {
-        //        std::cout << "Calling end" <<"\n";
-        return iterator{nullptr};
+        bst result{Alloc(node_traits::select_on_container_copy_construction(a.alloc))};
+        result.comp = a.comp;
+        result.set_operation_helper(a, b, true, true, true);
+        return result;
     }
 
     /**
-     * @brief Returns a @ref constant_iterator to one-past-the-last @ref Node of the tree. It's automatically applied when the tree is const-qualified and I call @ref end.
+     * @brief Returns a balanced tree with the keys that are both in a and in b, with the pairs of a. O(m + n), see @ref set_union().
      */
-    constant_iterator end() const noexcept
+    friend bst set_intersection(const bst &a, const bst &b)
     {
-        //        std::cout <<"Calling  const end"<< "\n";
-        return constant_iterator{nullptr};
+        bst result{Alloc(node_traits::select_on_container_copy_construction(a.alloc))};
+        result.comp = a.comp;
+        result.set_operation_helper(a, b, false, true, false);
+        return result;
     }
 
     /**
-     * @brief Returns a constant @ref Iterator to one-past-the-last @ref Node of the tree. It must be used unconditionally when the tree is const-qualified.
+     * @brief Returns a balanced tree with the pairs of a whose keys are not in b. O(m + n), see @ref set_union().
      */
-    constant_iterator cend() const noexcept
+    friend bst set_difference(const bst &a, const bst &b)
     {
-        //        std::cout <<"Calling cend"<< "\n";
-        return constant_iterator{nullptr};
+        bst result{Alloc(node_traits::select_on_container_copy_construction(a.alloc))};
+        result.comp = a.comp;
+        result.set_operation_helper(a, b, true, false, false);
+        return result;
     }
 
     /**
-     *
-     * @brief Insert a new @ref Node in the tree with pair x
-     * @param x Const l-value reference to a pair with a key and a value
-     * Returns a std::pair with an @ref _iterator and a bool which is true if the node has been inserted, false otherwise.
+     * @brief Moves the Nodes with keys not less than x into a new tree, which is returned, and keeps the others. Nothing is copied or allocated, apart from a vector as long as the height: the pointers and the references to the pairs stay valid.
+     * Both trees are balanced according to the policy. It needs the @ref order_statistics policy, which gives the sizes of the two trees from their roots: without it they could only be counted by a walk over the smaller tree. The cut costs O(height) over `unbalanced` and `avl`, and O(height^2) over `red_black`, which counts the black levels at every join.
      */
-    std::pair<iterator, bool> insert(const pair_type &x)
+    bst split(const key_type &x)
     {
-        //    std::cout <<"l-value insert"<<"\n";
-        return insert_helper(x);
+        bst result{get_allocator()};
+        result.comp = comp;
+        split_into_helper(x, result);
+        return result;
     }
 
     /**
-     * @brief Insert a new @ref Node in the tree with pair x
-     * @param x r-value reference to a pair with a node and a value
-     * Returns a std::pair with an @ref _iterator and a bool which is true if the node has been inserted, false otherwise.
+     * @brief Heterogeneous version of @ref split(). Available only if `OP::is_transparent` exists.
+     * @param x Object comparable with the keys
      */
-
-    std::pair<iterator, bool> insert(pair_type &&x)
+    template <typename K, if_transparent<K> = 0>
+    bst split(const K &x)
     {
-        //    std::cout <<"r-value insert"<<"\n";
-        return insert_helper(std::move(x));
+        bst result{get_allocator()};
+        result.comp = comp;
+        split_into_helper(x, result);
+        return result;
     }
 
     /**
-     * @brief Inserts a new element into the container constructed in-place with the given args if there is no element with the key in the container.
-     * @param args arguments to be *unpacked*
-     * It's like if we apply ‘std::forward<Types>(args)‘ to each element of the pair.
+     * @brief Joins two trees, where every key of left is less than every key of right, reusing all their Nodes. right is left empty.
+     * The smallest @ref Node of right is unlinked and then used to join the two trees by `Balance::join()`, so it costs O(height) (O(height^2) with `red_black`). If the allocators compare different the Nodes can't be shared, and the pairs of right are moved by `left.merge(right)`. Throws `std::invalid_argument`, leaving both trees untouched, if the ranges of the keys overlap (use `merge()` for that).
      */
-    template <class... Types> //packing all the arguments
-    std::pair<iterator, bool> emplace(Types &&...args)
-    { //forwarding reference
-        //verbose, but possibly clearer
-        //        pair_type to_be_inserted{pair_type{std::forward<Types>(args)...}};
-        //        return insert(to_be_inserted); //call to l-value!
-        return insert(pair_type{std::forward<Types>(args)...});
+    friend bst join(bst &&left, bst &&right)
+    {
+        if (right.empty())
+        {
+            return std::move(left);
+        }
+        if (!left.empty() && !left.comp(left.bounds.rightmost->data.first, right.bounds.leftmost->data.first))
+        {
+            throw std::invalid_argument{"bst::join: the keys of left must all be less than the keys of right"};
+        }
+        if (!(left.alloc == right.alloc))
+        { //no key of right is in left, so right ends empty
+            left.merge(right);
+            return std::move(left);
+        }
+        if (left.empty())
+        {
+            return std::move(right);
+        }
+        const std::size_t count{left.bounds.count + right.bounds.count};
+        auto middle = right.unlink_helper(right.bounds.leftmost);
+        middle->subtree_size = 1;
+        const tree_header<pair_type, Alloc> joined{left.bounds.leftmost, right.empty() ? middle : right.bounds.rightmost, count};
+        left.head = Balance::join(std::move(left.head), middle, std::move(right.head));
+        left.bounds = joined;
+        right.bounds = {nullptr, nullptr, 0};
+        return std::move(left);
     }
 
     /**
-     * @brief Find a given key. If it's present, returns a @ref _iterator to the node with that key, otherwise @ref end(). It uses the helper function @ref find_helper to avoid code duplication
-     * @param x The key to be searched in the tree.
+     * @brief Writes the tree to os in a binary format: a header with a magic number, the byte order, the tags of the key and value types (see @ref serializer) and the number of pairs, then the pairs in key order, and finally a checksum of all the bytes before it.
+     * Trivially copyable keys and values are written in blocks of many pairs at once, other types through their @ref serializer. The checksum comes last, so that os doesn't need to be seekable. Throws `std::runtime_error` if a write fails.
      */
-    iterator find(const key_type &x)
+    void save(std::ostream &os) const
     {
-        return iterator{find_helper(x)};
+        serial_writer out{os};
+        out.write_value(std::uint64_t{serial_format::magic});
+        out.write_value(std::uint32_t{serial_format::byte_order});
+        out.write_value(std::uint32_t{0}); //reserved
+        out.write_value(std::uint64_t{serializer<key_type>::tag});
+        out.write_value(std::uint64_t{serializer<value_type>::tag});
+        out.write_value(static_cast<std::uint64_t>(bounds.count));
+        save_pairs_helper(out, std::integral_constant<bool, serializer<key_type>::bulk && serializer<value_type>::bulk>{});
+        out.write_checksum();
     }
 
     /**
-     * @brief Find a given key in a constant tree. If it's present, returns a @ref iterator to the node with that key, otherwise @ref end(). It uses the helper function @ref find_helper to avoid code duplication
-     * @param x The key to be searched in the tree.
+     * @brief Writes the tree to the file at path (see @ref save(std::ostream &)), replacing its content.
      */
-    constant_iterator find(const key_type &x) const
+    void save(const std::string &path) const
     {
-        // std::cout << "Call to constant find" << "\n";
-        return constant_iterator{find_helper(x)};
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        if (!file)
+        {
+            throw std::runtime_error{"bst::save: can't open " + path};
+        }
+        save(file);
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error{"bst::save: write error on " + path};
+        }
     }
 
     /**
-     * @brief Erase a @ref Node in the tree
-     * @param x constant reference to a key
+     * @brief Replaces the content of the tree with the pairs written by @ref save().
+     * The pairs are already in key order, so the Nodes are created in order and linked in O(n) as by the sorted range constructor, without any comparison. Throws `std::runtime_error` if the input is not a saved tree, was saved with other key or value types or on a machine with the other byte order, is truncated, or doesn't match its checksum: in all these cases the tree is left untouched.
      */
-
-    void erase(const key_type &x)
+    void load(std::istream &is)
     {
-        auto it{find(x)};
-        node_type *locator{it.current};
-        if (!(it).current)
+        serial_reader in{is};
+        if (in.read_value<std::uint64_t>() != serial_format::magic || in.read_value<std::uint32_t>() != serial_format::byte_order)
         {
-            throw key_not_found{"Couldn't find a Node with key = " + std::to_string(x)};
+            throw std::runtime_error{"bst::load: not a saved tree, or saved with another byte order"};
         }
-
-        if (locator == head.get())
+        in.read_value<std::uint32_t>(); //reserved
+        const auto key_tag = in.read_value<std::uint64_t>();
+        const auto value_tag = in.read_value<std::uint64_t>();
+        if (key_tag != serializer<key_type>::tag || value_tag != serializer<value_type>::tag)
         {
-            if (!locator->right && !locator->left)
-            { //no child case
-                head.reset(nullptr);
-            }
-            else if (!(!locator->left) != !(!locator->right))
-            { // 1 child only
-                if (locator->right)
-                { //child is the right one
-                    head.reset(locator->right.release());
-                    locator->right->parent = nullptr;
-                }
-                else
-                { //child is the left one
-                    head.reset(locator->left.release());
-                    locator->left->parent = nullptr;
-                }
-            }
-            else
-            { //2 children case
-                auto successor = (++it).current;
-                auto DN = std::unique_ptr<Node<pair_type>>(new Node<pair_type>(successor->data, nullptr));
-                DN->left.reset(locator->left.release());
-                DN->left->parent = DN.get();
-                if (successor == locator->right.get())
-                {
-                    DN->right.reset(successor->right.release());
-                    if (DN->right)
-                    { //if successor has a right chidl
-                        DN->right->parent = DN.get();
-                    }
-                }
-                else
-                { //successor is NOT the next one
-                    DN->right.reset(locator->right.release());
-                    DN->right->parent = DN.get();
-                    if (successor->right)
-                    { //successor has right child
-                        successor->right->parent = successor->parent;
-                        successor->parent->left.reset(successor->right.release());
-                    }
-                    else
-                    { //successor is a leaf
-                        successor->parent->left.reset();
-                    }
-                }
-
-                head.reset(DN.release());
-            }
+            throw std::runtime_error{"bst::load: saved with other key or value types"};
         }
-        else
-        { //the node to be deleted is not the head
-
-            if (!(locator->left) && !(locator->right))
-            {
-                if (locator == locator->parent->left.get())
-                {
-                    locator->parent->left.reset();
-                }
-                else
-                {
-                    locator->parent->right.reset();
-                }
-            }
-            else if (!(!locator->left) != !(!locator->right))
+        const auto count = in.read_value<std::uint64_t>();
+        bst loaded{get_allocator()}; //shares the allocator, so that clearing this tree can't release the new Nodes
+        loaded.comp = comp;
+        std::vector<node_type *> vec_nodes{};
+        vec_nodes.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, std::uint64_t{1} << 20))); //a corrupted count can't reserve more than this
+        try
+        {
+            loaded.load_pairs_helper(in, count, vec_nodes, std::integral_constant<bool, serializer<key_type>::bulk && serializer<value_type>::bulk>{});
+            in.check_checksum();
+        }
+        catch (...)
+        {
+            for (auto ptn : vec_nodes)
             {
-                if (locator->left)
-                {
-                    locator->left->parent = locator->parent;
-                    if (locator == locator->parent->left.get())
-                    {
-                        locator->parent->left.reset(locator->left.release());
-                    }
-                    else
-                    {
-                        locator->parent->right.reset(locator->left.release());
-                    }
-                }
-                else
+                if (ptn)
                 {
-                    locator->right->parent = locator->parent;
-                    if (locator == locator->parent->left.get())
-                    {
-                        locator->parent->left.reset(locator->right.release());
-                    }
-                    else
-                    {
-                        locator->parent->right.reset(locator->right.release());
-                    }
+                    loaded.destroy_node(ptn);
                 }
             }
-            else
-            {
-                ++it;
-                node_type *successor{it.current};
-
-                if (successor != locator->right.get())
-                {
-                    auto DNP{locator->parent};                                                            // DNP := the pointer to the parent of the node to be deleted
-                    auto DN{std::unique_ptr<Node<pair_type>>(new Node<pair_type>(successor->data, DNP))}; // DN := the unique pointer to the newly created node which contains the successor's data
-                    erase(successor->data.first);
-
-                    DN->left.reset(locator->left.release()); // locator := the pointer to the node to be deleted
-                    DN->left->parent = DN.get();
-                    DN->right.reset(locator->right.release());
-                    DN->right->parent = DN.get();
+            throw;
+        }
+        loaded.relink_helper(vec_nodes);
+        *this = std::move(loaded);
+    }
 
-                    if (locator == DNP->left.get())
-                    {
-                        DNP->left.reset(DN.release());
-                    }
-                    else
-                    {
-                        DNP->right.reset(DN.release());
-                    }
-                }
-                else
-                {
-                    successor->left.reset(locator->left.release());
-                    successor->left->parent = successor;
-                    erase(locator->data.first);
-                }
-            }
+    /**
+     * @brief Replaces the content of the tree with the one saved in the file at path (see @ref load(std::istream &)).
+     */
+    void load(const std::string &path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        if (!file)
+        {
+            throw std::runtime_error{"bst::load: can't open " + path};
         }
-        // std::cout << "LOCATION OF LOCATOR " << &locator << "\n";
+        load(file);
     }
 
     // void erase(const key_type &x)
@@ -763,7 +2695,7 @@ public:
     //             }
     //         }else{ //two children
     //             auto in_order_succ{(++it).current};
-    //             auto dumb = std::unique_ptr<node_type>( new node_type(in_order_succ->data,nullptr));
+    //             auto dumb = node_owner( new node_type(in_order_succ->data,nullptr));
     //             dumb->left.reset(tmp->left.release());
     //             dumb->left->parent = dumb.get();
     //             if (in_order_succ==tmp->right.get()) {
@@ -816,7 +2748,7 @@ public:
     //         }else{ //two child case
 
     //             auto in_order_succ{(++it).current};
-    //             auto dumb{std::unique_ptr<node_type>(new node_type(in_order_succ->data,ptparent))};
+    //             auto dumb{node_owner(new node_type(in_order_succ->data,ptparent))};
     //             dumb->left.reset(tmp->left.release());
     //             dumb->left->parent = dumb.get();
     //             if(in_order_succ==tmp->right.get()){ //successor is the right child of current node
@@ -859,13 +2791,13 @@ public:
     /**
      * @brief Returns a reference to the value that is mapped to a key equivalent to x, performing an insertion if such key does not already exist.
      * @param x constant l-value ref. to a key
-     * @see insert()
+     * A single descent finds the key or the place where it has to be linked.
+     * @see find_or_insert()
      */
 
     value_type &operator[](const key_type &x)
     {
-        std::cout << "Calling l-value subscripting"
-                  << "\n";
+        BST_TRACE("Calling l-value subscripting");
         /*auto insertion{insert(pair_type{x,value_type{}})}; //pair with an iterator to the node and a bool
          return insertion.first->second; //take the iterator and access the value
          */
@@ -887,8 +2819,7 @@ public:
 
     value_type &operator[](key_type &&x)
     {
-        // std::cout << "Calling move subscripting"
-        //           << "\n";
+        BST_TRACE("Calling r-value subscripting");
         /*auto insertion{insert(pair_type{std::move(x),value_type{}})};
          return insertion.first->second;*/
         /*std::cout <<"Calling r-value subscripting" <<"\n";
@@ -901,24 +2832,26 @@ public:
         return subscript_helper(std::move(x));
     }
 
+    /**
+     * @brief Heterogeneous version of `[]`: the lookup compares the keys directly with x, and a `key_type` is built from x only if it has to be inserted. Available only if `OP::is_transparent` exists.
+     * @param x Object comparable with the keys, from which a key can be constructed
+     */
+    template <typename K, if_transparent<K> = 0>
+    value_type &operator[](K &&x)
+    {
+        return subscript_helper(std::forward<K>(x));
+    }
+
     /**
      * @brief Balance the tree by using the recursive (helper) function @ref balance_helper()
+     * The existing Nodes are relinked in O(n): no pair is copied and no @ref Node is allocated, the only extra memory is a vector of pointers.
+     * With the `avl` and `red_black` policies the height is already logarithmic, but the tree can still be reshaped into a perfectly balanced one.
      * @see balance_helper()
      */
 
     void balance()
     {
-        std::vector<pair_type> vec_nodes{};
-        auto stop = end();
-        for (auto it = begin(); it != stop; ++it)
-        {
-            vec_nodes.push_back(*it); //store the (ordered) nodes in a vector
-        }
-        clear();
-        int middle{static_cast<int>((vec_nodes.size()) / 2)};
-        this->insert(vec_nodes[middle]);
-        balance_helper(vec_nodes, 0, middle - 1);
-        balance_helper(vec_nodes, middle + 1, vec_nodes.size() - 1);
+        relink_helper(release_nodes_helper()); //store the (ordered) nodes in a vector, unlink them and link them back
     }
 
     /**
@@ -960,15 +2893,23 @@ public:
     }
 
     /**
-     * @brief Clear the tree by applying the method reset() to the head node.
+     * @brief Clear the tree by giving back every @ref Node to the allocator.
+     * If the pairs don't need to be destroyed and the allocator can free all its memory at once (as `pool_allocator` does when it's not shared), the Nodes are not visited at all.
      */
 
     void clear() noexcept
     {
-
-        //        Destroys the object currently managed by the unique_ptr (if any) and takes ownership of p.
-        //        If p is a null pointer (such as a default-initialized pointer), the unique_ptr becomes empty, managing no object after the call
-        head.reset();
+        if (!head)
+        {
+            return;
+        }
+        bounds = {nullptr, nullptr, 0};
+        if (std::is_trivially_destructible<pair_type>::value && release_helper(alloc, 0))
+        {
+            head.release(); //the memory of the Nodes has already been freed
+            return;
+        }
+        destroy_helper(head.release());
     }
 };
 
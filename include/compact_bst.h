@@ -0,0 +1,932 @@
+#ifndef compact_bst_h
+#define compact_bst_h
+
+#include "bst.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bidirectional iterator of a @ref compact_bst. Dereferencing yields a pair of references to the key and the value.
+ */
+template <typename Compact, bool is_const>
+class compact_iterator
+{
+    using tree_pointer = typename std::conditional<is_const, const Compact *, Compact *>::type;
+
+    tree_pointer tree;
+    std::uint32_t i; //slot of the entry, Compact::nil for end()
+
+    friend Compact;
+    friend class compact_iterator<Compact, !is_const>;
+
+public:
+    using value_type = typename std::conditional<is_const, typename Compact::const_reference, typename Compact::reference>::type;
+    using reference = value_type;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * @brief Helper returned by `operator->`, holding the pair by value.
+     */
+    struct pointer
+    {
+        value_type pair;
+        const value_type *operator->() const noexcept { return &pair; }
+    };
+
+    compact_iterator() noexcept : tree{nullptr}, i{Compact::nil} {}
+
+    compact_iterator(tree_pointer _tree, std::uint32_t _i) noexcept : tree{_tree}, i{_i} {}
+
+    /**
+     * @brief An iterator converts to a constant iterator.
+     */
+    template <bool other_const, typename = typename std::enable_if<is_const && !other_const>::type>
+    compact_iterator(const compact_iterator<Compact, other_const> &other) noexcept : tree{other.tree}, i{other.i} {}
+
+    reference operator*() const noexcept
+    {
+        return reference{tree->keys[i], tree->values[i]};
+    }
+
+    pointer operator->() const noexcept
+    {
+        return pointer{**this};
+    }
+
+    compact_iterator &operator++() noexcept
+    {
+        i = tree->next_helper(i);
+        return *this;
+    }
+
+    compact_iterator operator++(int) noexcept
+    {
+        auto tmp{*this};
+        ++(*this);
+        return tmp;
+    }
+
+    /**
+     * @brief Goes to the previous entry. Decrementing end() gives the last entry.
+     */
+    compact_iterator &operator--() noexcept
+    {
+        i = tree->previous_helper(i);
+        return *this;
+    }
+
+    compact_iterator operator--(int) noexcept
+    {
+        auto tmp{*this};
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const compact_iterator &other) const noexcept { return i == other.i; }
+    bool operator!=(const compact_iterator &other) const noexcept { return i != other.i; }
+};
+
+/**
+ * @brief Red-black tree whose entries live in contiguous arrays and are linked by 32-bit indices instead of pointers.
+ *
+ * The keys, the values and the links are three parallel vectors indexed by slot: a lookup only touches the keys and the links, and there is one allocation per vector instead of one per entry. The slots of erased entries go in a free list and are reused by the next insertions, so iterators stay valid until their own entry is erased.
+ * The key and the value of an erased entry are replaced at once by value-initialized ones, which releases what they own, if the types have a default constructor and a move assignment that don't throw. Otherwise they stay until the slot is reused, or until @ref clear() or the destructor.
+ * At most 2^32 - 1 entries can be stored.
+ */
+template <typename key_type, typename value_type, typename OP = std::less<key_type>>
+class compact_bst
+{
+    /**
+     * @brief Links of a slot. A free slot is chained to the next free one through `left`.
+     */
+    struct links
+    {
+        std::uint32_t left;
+        std::uint32_t right;
+        std::uint32_t parent;
+        std::uint32_t colour;
+    };
+
+    static constexpr std::uint32_t red = 0;
+    static constexpr std::uint32_t black = 1;
+
+    std::vector<key_type> keys;
+    std::vector<value_type> values;
+    std::vector<links> nodes;
+
+    std::uint32_t root;
+
+    /**
+     * @brief First slot of the free list.
+     */
+    std::uint32_t free_slot;
+
+    std::size_t entries;
+
+    OP comp;
+
+    std::uint32_t &left(std::uint32_t i) noexcept { return nodes[i].left; }
+    std::uint32_t &right(std::uint32_t i) noexcept { return nodes[i].right; }
+    std::uint32_t &parent(std::uint32_t i) noexcept { return nodes[i].parent; }
+
+    bool is_red(std::uint32_t i) const noexcept
+    {
+        return i != nil && nodes[i].colour == red;
+    }
+
+    std::uint32_t leftmost_helper(std::uint32_t i) const noexcept
+    {
+        while (i != nil && nodes[i].left != nil)
+        {
+            i = nodes[i].left;
+        }
+        return i;
+    }
+
+    std::uint32_t rightmost_helper(std::uint32_t i) const noexcept
+    {
+        while (i != nil && nodes[i].right != nil)
+        {
+            i = nodes[i].right;
+        }
+        return i;
+    }
+
+    /**
+     * @brief In-order successor of slot i, or @ref nil.
+     */
+    std::uint32_t next_helper(std::uint32_t i) const noexcept
+    {
+        if (nodes[i].right != nil)
+        {
+            return leftmost_helper(nodes[i].right);
+        }
+        auto p = nodes[i].parent;
+        while (p != nil && i == nodes[p].right)
+        {
+            i = p;
+            p = nodes[p].parent;
+        }
+        return p;
+    }
+
+    /**
+     * @brief In-order predecessor of slot i. The predecessor of @ref nil is the last entry.
+     */
+    std::uint32_t previous_helper(std::uint32_t i) const noexcept
+    {
+        if (i == nil)
+        {
+            return rightmost_helper(root);
+        }
+        if (nodes[i].left != nil)
+        {
+            return rightmost_helper(nodes[i].left);
+        }
+        auto p = nodes[i].parent;
+        while (p != nil && i == nodes[p].left)
+        {
+            i = p;
+            p = nodes[p].parent;
+        }
+        return p;
+    }
+
+    template <typename K>
+    std::uint32_t find_helper(const K &x) const noexcept
+    {
+        auto i = root;
+        while (i != nil)
+        {
+            if (comp(x, keys[i]))
+            {
+                i = nodes[i].left;
+            }
+            else if (comp(keys[i], x))
+            {
+                i = nodes[i].right;
+            }
+            else
+            {
+                return i;
+            }
+        }
+        return nil;
+    }
+
+    /**
+     * @brief Slot of the first key not less than x (greater than x if strict), or @ref nil.
+     */
+    template <typename K>
+    std::uint32_t bound_helper(const K &x, bool strict) const noexcept
+    {
+        auto i = root;
+        auto candidate = nil;
+        while (i != nil)
+        {
+            if (strict ? comp(x, keys[i]) : !comp(keys[i], x))
+            {
+                candidate = i;
+                i = nodes[i].left;
+            }
+            else
+            {
+                i = nodes[i].right;
+            }
+        }
+        return candidate;
+    }
+
+    /**
+     * @brief Same gate as `bst::if_transparent`: the lookups take probes of other types only with a transparent OP.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+    /**
+     * @brief Takes a slot from the free list, or appends a new one, and stores the entry there.
+     */
+    template <typename K, typename... Args>
+    std::uint32_t allocate_helper(K &&k, Args &&...args)
+    {
+        if (free_slot != nil)
+        {
+            auto i = free_slot;
+            values[i] = value_type(std::forward<Args>(args)...);
+            keys[i] = std::forward<K>(k);
+            free_slot = nodes[i].left;
+            return i;
+        }
+        if (nodes.size() >= nil)
+        {
+            throw std::length_error{"compact_bst: too many entries for 32-bit links"};
+        }
+        nodes.push_back(links{nil, nil, nil, red});
+        try
+        {
+            values.emplace_back(std::forward<Args>(args)...);
+            try
+            {
+                keys.emplace_back(std::forward<K>(k));
+            }
+            catch (...)
+            {
+                values.pop_back();
+                throw;
+            }
+        }
+        catch (...)
+        { //keep the three arrays of the same size
+            nodes.pop_back();
+            throw;
+        }
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+
+    /**
+     * @brief Finds the key or links a new red leaf holding it, constructing the value from args only in that case.
+     */
+    template <typename K, typename... Args>
+    std::pair<std::uint32_t, bool> try_emplace_helper(K &&k, Args &&...args)
+    {
+        auto p = nil;
+        auto i = root;
+        bool go_left{false};
+        while (i != nil)
+        {
+            p = i;
+            if (comp(k, keys[i]))
+            {
+                go_left = true;
+                i = nodes[i].left;
+            }
+            else if (comp(keys[i], k))
+            {
+                go_left = false;
+                i = nodes[i].right;
+            }
+            else
+            {
+                return std::make_pair(i, false);
+            }
+        }
+        auto n = allocate_helper(std::forward<K>(k), std::forward<Args>(args)...);
+        nodes[n] = links{nil, nil, p, red};
+        if (p == nil)
+        {
+            root = n;
+        }
+        else if (go_left)
+        {
+            left(p) = n;
+        }
+        else
+        {
+            right(p) = n;
+        }
+        ++entries;
+        insert_fixup(n);
+        return std::make_pair(n, true);
+    }
+
+    /**
+     * @brief Left rotation around x. The right child of x takes its place and x becomes its left child.
+     */
+    void rotate_left(std::uint32_t x) noexcept
+    {
+        auto y = right(x);
+        right(x) = left(y);
+        if (left(y) != nil)
+        {
+            parent(left(y)) = x;
+        }
+        replace_helper(x, y);
+        left(y) = x;
+        parent(x) = y;
+    }
+
+    /**
+     * @brief Right rotation around x. The left child of x takes its place and x becomes its right child.
+     */
+    void rotate_right(std::uint32_t x) noexcept
+    {
+        auto y = left(x);
+        left(x) = right(y);
+        if (right(y) != nil)
+        {
+            parent(right(y)) = x;
+        }
+        replace_helper(x, y);
+        right(y) = x;
+        parent(x) = y;
+    }
+
+    /**
+     * @brief Puts v (possibly @ref nil) in the position of u, as child of the parent of u.
+     */
+    void replace_helper(std::uint32_t u, std::uint32_t v) noexcept
+    {
+        auto p = parent(u);
+        if (p == nil)
+        {
+            root = v;
+        }
+        else if (u == left(p))
+        {
+            left(p) = v;
+        }
+        else
+        {
+            right(p) = v;
+        }
+        if (v != nil)
+        {
+            parent(v) = p;
+        }
+    }
+
+    /**
+     * @brief Same fixup as `red_black::after_insert`, on indices.
+     */
+    void insert_fixup(std::uint32_t n) noexcept
+    {
+        while (is_red(parent(n)))
+        {
+            auto p = parent(n);
+            auto g = parent(p); //exists, since the root is always black
+            if (p == left(g))
+            {
+                auto u = right(g);
+                if (is_red(u))
+                {
+                    nodes[p].colour = black;
+                    nodes[u].colour = black;
+                    nodes[g].colour = red;
+                    n = g;
+                }
+                else
+                {
+                    if (n == right(p))
+                    {
+                        n = p;
+                        rotate_left(n);
+                        p = parent(n);
+                    }
+                    nodes[p].colour = black;
+                    nodes[g].colour = red;
+                    rotate_right(g);
+                }
+            }
+            else
+            {
+                auto u = left(g);
+                if (is_red(u))
+                {
+                    nodes[p].colour = black;
+                    nodes[u].colour = black;
+                    nodes[g].colour = red;
+                    n = g;
+                }
+                else
+                {
+                    if (n == left(p))
+                    {
+                        n = p;
+                        rotate_right(n);
+                        p = parent(n);
+                    }
+                    nodes[p].colour = black;
+                    nodes[g].colour = red;
+                    rotate_left(g);
+                }
+            }
+        }
+        nodes[root].colour = black;
+    }
+
+    /**
+     * @brief Utility function used for @ref erase_helper(): replaces the entry of a freed slot with a value-initialized one, so that what it owns (e.g. the buffer of a `std::string`) is released now rather than when the slot is reused. Done only if that can't throw, and if the type owns anything.
+     */
+    template <typename T>
+    static void release_helper(T &x) noexcept
+    {
+        release_helper(x, std::integral_constant<bool, !std::is_trivially_destructible<T>::value && std::is_nothrow_default_constructible<T>::value && std::is_nothrow_move_assignable<T>::value>{});
+    }
+
+    template <typename T>
+    static void release_helper(T &x, std::true_type) noexcept
+    {
+        x = T{};
+    }
+
+    template <typename T>
+    static void release_helper(T &, std::false_type) noexcept {}
+
+    /**
+     * @brief Unlinks slot z, rebalances and puts the slot in the free list, releasing what its key and value own.
+     */
+    void erase_helper(std::uint32_t z) noexcept
+    {
+        auto removed_colour = nodes[z].colour;
+        std::uint32_t x, x_parent;
+        if (left(z) == nil || right(z) == nil)
+        {
+            x = left(z) != nil ? left(z) : right(z);
+            x_parent = parent(z);
+            replace_helper(z, x);
+        }
+        else
+        { //the successor of z takes its place, with its colour
+            auto y = leftmost_helper(right(z));
+            removed_colour = nodes[y].colour;
+            x = right(y);
+            if (parent(y) == z)
+            {
+                x_parent = y;
+            }
+            else
+            {
+                x_parent = parent(y);
+                replace_helper(y, x);
+                right(y) = right(z);
+                parent(right(y)) = y;
+            }
+            replace_helper(z, y);
+            left(y) = left(z);
+            parent(left(y)) = y;
+            nodes[y].colour = nodes[z].colour;
+        }
+        if (removed_colour == black)
+        {
+            erase_fixup(x, x_parent);
+        }
+        nodes[z] = links{free_slot, nil, nil, black};
+        free_slot = z;
+        --entries;
+        release_helper(keys[z]);
+        release_helper(values[z]);
+    }
+
+    /**
+     * @brief Same fixup as `red_black::after_erase`, on indices.
+     */
+    void erase_fixup(std::uint32_t x, std::uint32_t x_parent) noexcept
+    {
+        while (x != root && !is_red(x))
+        {
+            if (x == left(x_parent))
+            {
+                auto w = right(x_parent);
+                if (is_red(w))
+                {
+                    nodes[w].colour = black;
+                    nodes[x_parent].colour = red;
+                    rotate_left(x_parent);
+                    w = right(x_parent);
+                }
+                if (!is_red(left(w)) && !is_red(right(w)))
+                {
+                    nodes[w].colour = red;
+                    x = x_parent;
+                    x_parent = parent(x);
+                }
+                else
+                {
+                    if (!is_red(right(w)))
+                    {
+                        nodes[left(w)].colour = black;
+                        nodes[w].colour = red;
+                        rotate_right(w);
+                        w = right(x_parent);
+                    }
+                    nodes[w].colour = nodes[x_parent].colour;
+                    nodes[x_parent].colour = black;
+                    nodes[right(w)].colour = black;
+                    rotate_left(x_parent);
+                    x = root;
+                }
+            }
+            else
+            {
+                auto w = left(x_parent);
+                if (is_red(w))
+                {
+                    nodes[w].colour = black;
+                    nodes[x_parent].colour = red;
+                    rotate_right(x_parent);
+                    w = left(x_parent);
+                }
+                if (!is_red(left(w)) && !is_red(right(w)))
+                {
+                    nodes[w].colour = red;
+                    x = x_parent;
+                    x_parent = parent(x);
+                }
+                else
+                {
+                    if (!is_red(left(w)))
+                    {
+                        nodes[right(w)].colour = black;
+                        nodes[w].colour = red;
+                        rotate_left(w);
+                        w = left(x_parent);
+                    }
+                    nodes[w].colour = nodes[x_parent].colour;
+                    nodes[x_parent].colour = black;
+                    nodes[left(w)].colour = black;
+                    rotate_right(x_parent);
+                    x = root;
+                }
+            }
+        }
+        if (x != nil)
+        {
+            nodes[x].colour = black;
+        }
+    }
+
+    /**
+     * @brief Utility function used for @ref is_red_black(): number of black slots on every path from i down to a leaf, or -1 if the paths differ, a red slot has a red child or a parent link is wrong. p is the expected parent of i.
+     */
+    int black_height_helper(std::uint32_t i, std::uint32_t p) const noexcept
+    {
+        if (i == nil)
+        {
+            return 0;
+        }
+        if (nodes[i].parent != p || (is_red(i) && (is_red(nodes[i].left) || is_red(nodes[i].right))))
+        {
+            return -1;
+        }
+        const int l{black_height_helper(nodes[i].left, i)};
+        const int r{black_height_helper(nodes[i].right, i)};
+        if (l < 0 || l != r)
+        {
+            return -1;
+        }
+        return l + (is_red(i) ? 0 : 1);
+    }
+
+    /**
+     * @brief Links the sorted slots [lo,hi) into a perfectly balanced subtree under p and returns its root. As in `red_black::after_rebuild`, only the deepest level is red.
+     */
+    std::uint32_t build_helper(std::uint32_t lo, std::uint32_t hi, std::uint32_t p, int level, int deepest) noexcept
+    {
+        if (lo == hi)
+        {
+            return nil;
+        }
+        auto mid = lo + (hi - lo) / 2;
+        nodes[mid].parent = p;
+        nodes[mid].colour = (level == deepest && level > 1) ? red : black;
+        nodes[mid].left = build_helper(lo, mid, mid, level + 1, deepest);
+        nodes[mid].right = build_helper(mid + 1, hi, mid, level + 1, deepest);
+        return mid;
+    }
+
+public:
+    using mapped_type = value_type;
+    using reference = std::pair<const key_type &, value_type &>;
+    using const_reference = std::pair<const key_type &, const value_type &>;
+    using iterator = compact_iterator<compact_bst, false>;
+    using const_iterator = compact_iterator<compact_bst, true>;
+
+    friend class compact_iterator<compact_bst, false>;
+    friend class compact_iterator<compact_bst, true>;
+
+    /**
+     * @brief Index used as null link.
+     */
+    static constexpr std::uint32_t nil = 0xFFFFFFFF;
+
+    /**
+     * @brief Default constructor: an empty tree.
+     */
+    compact_bst() : keys{}, values{}, nodes{}, root{nil}, free_slot{nil}, entries{0}, comp{} {}
+
+    explicit compact_bst(const OP &_comp) : keys{}, values{}, nodes{}, root{nil}, free_slot{nil}, entries{0}, comp{_comp} {}
+
+    /**
+     * @brief Builds a balanced tree in O(n) from the pairs in [first,last), which must be strictly increasing by key. The entries are stored in key order, so iterating visits the slots sequentially.
+     * @param first,last Forward iterators to pairs with a `first` and a `second` member
+     * @param _comp The comparison operator, which must be the one used to sort the range
+     */
+    template <typename ForwardIt>
+    compact_bst(sorted_unique_t, ForwardIt first, ForwardIt last, const OP &_comp = OP{}) : compact_bst{_comp}
+    {
+        for (; first != last; ++first)
+        {
+            if (nodes.size() >= nil)
+            {
+                throw std::length_error{"compact_bst: too many entries for 32-bit links"};
+            }
+            keys.push_back((*first).first);
+            values.push_back((*first).second);
+            nodes.push_back(links{nil, nil, nil, black});
+        }
+        entries = nodes.size();
+        int deepest{0};
+        for (auto n = entries; n; n >>= 1)
+        {
+            ++deepest;
+        }
+        root = build_helper(0, static_cast<std::uint32_t>(entries), nil, 1, deepest);
+    }
+
+    /**
+     * @brief Inserts a pair. If the key is already present the tree is left untouched.
+     * @return A pair with an @ref iterator to the entry with that key and true if the insertion took place
+     */
+    template <typename Pair>
+    std::pair<iterator, bool> insert(Pair &&x)
+    {
+        auto r = try_emplace_helper(std::forward<Pair>(x).first, std::forward<Pair>(x).second);
+        return std::make_pair(iterator{this, r.first}, r.second);
+    }
+
+    /**
+     * @brief Inserts the key with a value constructed from args, only if the key is missing.
+     */
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K &&k, Args &&...args)
+    {
+        auto r = try_emplace_helper(std::forward<K>(k), std::forward<Args>(args)...);
+        return std::make_pair(iterator{this, r.first}, r.second);
+    }
+
+    /**
+     * @brief Returns a reference to the value of the key, inserting a value-initialized one if the key is missing.
+     */
+    value_type &operator[](const key_type &x)
+    {
+        return values[try_emplace_helper(x).first];
+    }
+
+    value_type &operator[](key_type &&x)
+    {
+        return values[try_emplace_helper(std::move(x)).first];
+    }
+
+    /**
+     * @brief Find a given key. If it's present, returns an @ref iterator to it, otherwise @ref end().
+     */
+    iterator find(const key_type &x) noexcept
+    {
+        return iterator{this, find_helper(x)};
+    }
+
+    /**
+     * @brief Heterogeneous versions of @ref find(), and below of the other lookups and of @ref erase(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    iterator find(const K &x) noexcept
+    {
+        return iterator{this, find_helper(x)};
+    }
+
+    const_iterator find(const key_type &x) const noexcept
+    {
+        return const_iterator{this, find_helper(x)};
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const_iterator find(const K &x) const noexcept
+    {
+        return const_iterator{this, find_helper(x)};
+    }
+
+    /**
+     * @brief Returns 1 if the key is present, 0 otherwise.
+     */
+    std::size_t count(const key_type &x) const noexcept
+    {
+        return find_helper(x) != nil ? 1 : 0;
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    std::size_t count(const K &x) const noexcept
+    {
+        return find_helper(x) != nil ? 1 : 0;
+    }
+
+    /**
+     * @brief Returns an @ref iterator to the first key not less than x, or @ref end().
+     */
+    iterator lower_bound(const key_type &x) noexcept
+    {
+        return iterator{this, bound_helper(x, false)};
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    iterator lower_bound(const K &x) noexcept
+    {
+        return iterator{this, bound_helper(x, false)};
+    }
+
+    const_iterator lower_bound(const key_type &x) const noexcept
+    {
+        return const_iterator{this, bound_helper(x, false)};
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const_iterator lower_bound(const K &x) const noexcept
+    {
+        return const_iterator{this, bound_helper(x, false)};
+    }
+
+    /**
+     * @brief Returns an @ref iterator to the first key greater than x, or @ref end().
+     */
+    iterator upper_bound(const key_type &x) noexcept
+    {
+        return iterator{this, bound_helper(x, true)};
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    iterator upper_bound(const K &x) noexcept
+    {
+        return iterator{this, bound_helper(x, true)};
+    }
+
+    const_iterator upper_bound(const key_type &x) const noexcept
+    {
+        return const_iterator{this, bound_helper(x, true)};
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const_iterator upper_bound(const K &x) const noexcept
+    {
+        return const_iterator{this, bound_helper(x, true)};
+    }
+
+    /**
+     * @brief Erases the entry with the given key, if any. Returns the number of erased entries (0 or 1).
+     */
+    std::size_t erase(const key_type &x) noexcept
+    {
+        auto i = find_helper(x);
+        if (i == nil)
+        {
+            return 0;
+        }
+        erase_helper(i);
+        return 1;
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    std::size_t erase(const K &x) noexcept
+    {
+        auto i = find_helper(x);
+        if (i == nil)
+        {
+            return 0;
+        }
+        erase_helper(i);
+        return 1;
+    }
+
+    /**
+     * @brief Erases the entry pointed by pos, which must be dereferenceable. Returns an @ref iterator to the following entry.
+     */
+    iterator erase(const_iterator pos) noexcept
+    {
+        auto next = next_helper(pos.i);
+        erase_helper(pos.i);
+        return iterator{this, next};
+    }
+
+    iterator erase(iterator pos) noexcept
+    {
+        return erase(const_iterator{pos});
+    }
+
+    /**
+     * @brief Removes every entry and releases the slots.
+     */
+    void clear() noexcept
+    {
+        keys.clear();
+        values.clear();
+        nodes.clear();
+        root = nil;
+        free_slot = nil;
+        entries = 0;
+    }
+
+    /**
+     * @brief Reserves room for n slots in the three arrays.
+     */
+    void reserve(std::size_t n)
+    {
+        keys.reserve(n);
+        values.reserve(n);
+        nodes.reserve(n);
+    }
+
+    /**
+     * @brief Number of slots, used or in the free list.
+     */
+    std::size_t slot_count() const noexcept { return nodes.size(); }
+
+    /**
+     * @brief Checks the whole structure in O(n): the parent links, the order of the keys, the number of entries and the red-black invariants (black root, no red slot with a red child, as many black slots on every path). Meant for tests.
+     */
+    bool is_red_black() const noexcept
+    {
+        if (is_red(root) || black_height_helper(root, nil) < 0)
+        {
+            return false;
+        }
+        std::size_t n{0};
+        for (auto i = leftmost_helper(root); i != nil; i = next_helper(i))
+        {
+            const auto next = next_helper(i);
+            if (next != nil && !comp(keys[i], keys[next]))
+            {
+                return false;
+            }
+            ++n;
+        }
+        return n == entries;
+    }
+
+    iterator begin() noexcept { return iterator{this, leftmost_helper(root)}; }
+    const_iterator begin() const noexcept { return const_iterator{this, leftmost_helper(root)}; }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return iterator{this, nil}; }
+    const_iterator end() const noexcept { return const_iterator{this, nil}; }
+    const_iterator cend() const noexcept { return end(); }
+
+    std::size_t size() const noexcept { return entries; }
+
+    bool empty() const noexcept { return entries == 0; }
+
+    OP key_comp() const { return comp; }
+};
+
+template <typename key_type, typename value_type, typename OP>
+constexpr std::uint32_t compact_bst<key_type, value_type, OP>::nil;
+
+template <typename key_type, typename value_type, typename OP>
+constexpr std::uint32_t compact_bst<key_type, value_type, OP>::red;
+
+template <typename key_type, typename value_type, typename OP>
+constexpr std::uint32_t compact_bst<key_type, value_type, OP>::black;
+
+/**
+ * @brief Copies a @ref bst into a balanced @ref compact_bst with the same keys, values and comparison operator. The tree is left untouched.
+ */
+template <typename key_type, typename value_type, typename OP, typename Balance, typename Alloc>
+compact_bst<typename std::remove_const<key_type>::type, value_type, OP> compact(const bst<key_type, value_type, OP, Balance, Alloc> &tree)
+{
+    return compact_bst<typename std::remove_const<key_type>::type, value_type, OP>{sorted_unique, tree.cbegin(), tree.cend(), tree.key_comp()};
+}
+
+#endif /* compact_bst_h */
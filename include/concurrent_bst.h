@@ -0,0 +1,420 @@
+#ifndef concurrent_bst_h
+#define concurrent_bst_h
+
+#include "bst.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Node of a @ref concurrent_bst: the same parent/child links as @ref Node, plus the mutex that guards all of its fields and a flag for logical deletion.
+ */
+template <typename T>
+struct concurrent_node
+{
+    T data;
+    std::unique_ptr<concurrent_node> left;
+    std::unique_ptr<concurrent_node> right;
+    concurrent_node *parent;
+
+    /**
+     * @brief False once the key has been erased while the Node still had two children: the Node keeps routing the searches until the key is inserted again, or until one of its children goes away and it can be unlinked too.
+     */
+    bool present;
+
+    std::mutex m;
+
+    template <typename... Args>
+    explicit concurrent_node(concurrent_node *_parent, Args &&...args) : data(std::forward<Args>(args)...), left{nullptr}, right{nullptr}, parent{_parent}, present{true}, m{} {}
+
+    /**
+     * @brief Destroys the subtrees with constant stack usage, rotating left children up as `Node::destroy_subtree()` does.
+     */
+    ~concurrent_node() noexcept
+    {
+        destroy_subtree(left.release());
+        destroy_subtree(right.release());
+    }
+
+    static void destroy_subtree(concurrent_node *n) noexcept
+    {
+        while (n)
+        {
+            if (n->left)
+            {
+                auto l = n->left.release();
+                n->left.reset(l->right.release());
+                l->right.reset(n);
+                n = l;
+            }
+            else
+            {
+                auto r = n->right.release();
+                delete n;
+                n = r;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Unbalanced search tree that many threads can update at once, with hand-over-hand locking.
+ *
+ * Every operation descends from the root hand over hand: it locks a @ref concurrent_node, then releases the parent. Lookups and insertions hold at most two locks. @ref erase() holds up to four, all on one path: the Node, its parent and grandparent, and the child that takes its place. @ref for_each() holds up to three. Operations on disjoint key regions only meet near the root, where each lock is held for one comparison. All the operations are linearizable: each one takes effect while it holds the lock of the Node it reads or modifies.
+ * A key erased from a Node with two children is only marked as missing (logical deletion), since moving its successor would need locks further down the tree. Leaves and Nodes with one child are unlinked and freed at once, which is safe because no other thread can reach a Node without holding the lock of its parent. Such a marked Node is unlinked as soon as it's left with one child: @ref erase() keeps the lock of the grandparent as well, so it can splice out the parent of the leaf it removes. Every marked Node has then two children, and at most half of the Nodes are marked.
+ * As with the @ref unbalanced policy, the shape depends on the insertion order: the keys should not arrive sorted.
+ */
+template <typename key_type, typename value_type, typename OP = std::less<key_type>>
+class concurrent_bst
+{
+public:
+    using pair_type = std::pair<const key_type, value_type>;
+
+private:
+    using node_type = concurrent_node<pair_type>;
+    using lock_type = std::unique_lock<std::mutex>;
+
+    std::unique_ptr<node_type> head;
+
+    /**
+     * @brief Guards @ref head, playing the role of the lock of the parent of the root.
+     */
+    mutable std::mutex head_mutex;
+
+    std::atomic<std::size_t> count;
+
+    OP comp;
+
+    /**
+     * @brief Where a hand-over-hand descent stopped: the slot that owns the Node with the key, or where it would be linked, with the lock of its owner.
+     */
+    struct position
+    {
+        lock_type grandparent_lock; //of the owner of parent_slot, kept only if asked for
+        std::unique_ptr<node_type> *parent_slot;
+        lock_type parent_lock;
+        node_type *parent;
+        std::unique_ptr<node_type> *slot;
+        lock_type lock; //of *slot, if not empty
+    };
+
+    /**
+     * @brief Hand-over-hand descent towards x. On return the owner of the slot is locked, and so is the Node in the slot if there is one.
+     * @param keep_grandparent Whether the owner of the parent stays locked as well, so that the parent can be unlinked
+     */
+    template <typename K>
+    position locate_helper(const K &x, bool keep_grandparent = false) const
+    {
+        position p{lock_type{}, nullptr, lock_type{head_mutex}, nullptr, const_cast<std::unique_ptr<node_type> *>(&head), lock_type{}};
+        while (*p.slot)
+        {
+            auto n = p.slot->get();
+            p.lock = lock_type{n->m};
+            std::unique_ptr<node_type> *next{nullptr};
+            if (comp(x, n->data.first))
+            {
+                next = &n->left;
+            }
+            else if (comp(n->data.first, x))
+            {
+                next = &n->right;
+            }
+            else
+            {
+                return p;
+            }
+            if (keep_grandparent)
+            {
+                p.grandparent_lock = std::move(p.parent_lock); //releases the lock of the old grandparent
+                p.parent_slot = p.slot;
+            }
+            p.parent_lock = std::move(p.lock); //releases the lock of the old parent, unless it has just been kept
+            p.parent = n;
+            p.slot = next;
+        }
+        return p;
+    }
+
+    template <typename P>
+    bool insert_helper(P &&x, bool assign)
+    {
+        auto p = locate_helper(x.first);
+        if (*p.slot)
+        {
+            auto n = p.slot->get();
+            if (n->present && !assign)
+            {
+                return false;
+            }
+            n->data.second = std::forward<P>(x).second;
+            if (n->present)
+            {
+                return false;
+            }
+            n->present = true; //revives a logically deleted key
+        }
+        else
+        {
+            *p.slot = std::unique_ptr<node_type>{new node_type{p.parent, std::forward<P>(x)}};
+        }
+        ++count;
+        return true;
+    }
+
+    /**
+     * @brief Hand-over-hand descent to the Node with the smallest key greater than *last, or with the smallest key if last is null. Besides the Node it's at and its parent, it keeps locked the best candidate found so far, which is an ancestor of both, so it never holds more than three locks.
+     * @param found Set to the Node found, or to null if there's none
+     * @return The lock of the Node found
+     */
+    lock_type successor_helper(const key_type *last, node_type *&found) const
+    {
+        lock_type up{head_mutex};
+        lock_type candidate{};
+        found = nullptr;
+        auto n = head.get();
+        while (n)
+        {
+            lock_type lock{n->m};
+            if (up.owns_lock())
+            {
+                up.unlock(); //unless the parent is the candidate, whose lock has been moved
+            }
+            if (!last || comp(*last, n->data.first))
+            {
+                found = n;
+                candidate = std::move(lock); //releases the lock of the old candidate
+                n = n->left.get();
+            }
+            else
+            {
+                up = std::move(lock);
+                n = n->right.get();
+            }
+        }
+        return candidate;
+    }
+
+    template <typename K>
+    std::size_t erase_helper(const K &x)
+    {
+        auto p = locate_helper(x, true);
+        auto n = p.slot->get();
+        if (!n || !n->present)
+        {
+            return 0;
+        }
+        --count;
+        if (n->left && n->right)
+        {
+            n->present = false;
+            return 1;
+        }
+        unlink_helper(p.slot, p.parent, p.lock);
+        if (!*p.slot && p.parent && !p.parent->present)
+        { //a leaf went away under a marked parent, which is left with one child: unlink it as well
+            unlink_helper(p.parent_slot, p.parent->parent, p.parent_lock);
+        }
+        return 1;
+    }
+
+    /**
+     * @brief Unlinks and frees the Node in slot, which has at most one child and is held by lock. The owner of the slot, parent, must be locked too. The child, if any, takes the place of the Node.
+     */
+    static void unlink_helper(std::unique_ptr<node_type> *slot, node_type *parent, lock_type &lock)
+    {
+        std::unique_ptr<node_type> victim{std::move(*slot)};
+        auto &child = victim->left ? victim->left : victim->right;
+        if (child)
+        {
+            std::lock_guard<std::mutex> child_lock{child->m};
+            child->parent = parent;
+            *slot = std::move(child);
+        }
+        lock.unlock(); //nobody else can be waiting for it, since we hold the lock of the parent
+        victim.reset();
+    }
+
+    template <typename K>
+    bool contains_helper(const K &x) const
+    {
+        auto p = locate_helper(x);
+        return *p.slot && (*p.slot)->present;
+    }
+
+    template <typename K>
+    bool get_helper(const K &x, value_type &out) const
+    {
+        auto p = locate_helper(x);
+        if (!*p.slot || !(*p.slot)->present)
+        {
+            return false;
+        }
+        out = (*p.slot)->data.second;
+        return true;
+    }
+
+    template <typename K, typename F>
+    bool update_helper(const K &x, F &f)
+    {
+        auto p = locate_helper(x);
+        auto n = p.slot->get();
+        if (!n || !n->present)
+        {
+            return false;
+        }
+        p.parent_lock.unlock(); //the Node can't be unlinked while we hold its own lock
+        f(n->data.second);
+        return true;
+    }
+
+    /**
+     * @brief Same gate as `bst::if_transparent`.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+public:
+    /**
+     * @brief Default constructor: an empty tree.
+     */
+    concurrent_bst() : head{nullptr}, head_mutex{}, count{0}, comp{} {}
+
+    explicit concurrent_bst(const OP &_comp) : head{nullptr}, head_mutex{}, count{0}, comp{_comp} {}
+
+    concurrent_bst(const concurrent_bst &) = delete;
+    concurrent_bst &operator=(const concurrent_bst &) = delete;
+
+    /**
+     * @brief Inserts a pair if the key is missing.
+     * @return true if the insertion took place
+     */
+    bool insert(const pair_type &x)
+    {
+        return insert_helper(x, false);
+    }
+
+    bool insert(pair_type &&x)
+    {
+        return insert_helper(std::move(x), false);
+    }
+
+    /**
+     * @brief Inserts a pair, or assigns the value if the key is already present.
+     * @return true if a new key has been inserted
+     */
+    bool insert_or_assign(const pair_type &x)
+    {
+        return insert_helper(x, true);
+    }
+
+    bool insert_or_assign(pair_type &&x)
+    {
+        return insert_helper(std::move(x), true);
+    }
+
+    /**
+     * @brief Erases a key. Returns the number of erased keys (0 or 1).
+     */
+    std::size_t erase(const key_type &x)
+    {
+        return erase_helper(x);
+    }
+
+    /**
+     * @brief Heterogeneous versions of @ref erase(), and below of the lookups and of @ref update(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    std::size_t erase(const K &x)
+    {
+        return erase_helper(x);
+    }
+
+    /**
+     * @brief Whether the key is present.
+     */
+    bool contains(const key_type &x) const
+    {
+        return contains_helper(x);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    bool contains(const K &x) const
+    {
+        return contains_helper(x);
+    }
+
+    /**
+     * @brief Copies the value of a key into out.
+     * @return false, leaving out untouched, if the key is missing
+     */
+    bool get(const key_type &x, value_type &out) const
+    {
+        return get_helper(x, out);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    bool get(const K &x, value_type &out) const
+    {
+        return get_helper(x, out);
+    }
+
+    /**
+     * @brief Calls f on the value of a key, while holding the lock of its Node, so that read-modify-write updates are atomic.
+     * @return false if the key is missing, and f has not been called
+     */
+    template <typename F>
+    bool update(const key_type &x, F f)
+    {
+        return update_helper(x, f);
+    }
+
+    template <typename K, typename F, if_transparent<K> = 0>
+    bool update(const K &x, F f)
+    {
+        return update_helper(x, f);
+    }
+
+    /**
+     * @brief Calls f on every pair, in key order, while holding the lock of its Node only. The next pair is found by a new descent from the root to the successor of the key just visited (see @ref successor_helper()), so the writers are never stalled by the visit as a whole, but the visit costs O(h) per key.
+     * Each key present during the whole call is visited once. A key inserted or erased meanwhile may or may not be, depending on whether the visit has already gone past it.
+     */
+    template <typename F>
+    void for_each(F f) const
+    {
+        std::unique_ptr<key_type> last{};
+        for (;;)
+        {
+            node_type *n{nullptr};
+            auto lock = successor_helper(last.get(), n);
+            if (!n)
+            {
+                return;
+            }
+            if (n->present)
+            {
+                f(static_cast<const pair_type &>(n->data));
+            }
+            if (last)
+            {
+                *last = n->data.first;
+            }
+            else
+            {
+                last.reset(new key_type{n->data.first});
+            }
+        }
+    }
+
+    /**
+     * @brief Number of present keys. With concurrent updates, it's the value at some point during the call.
+     */
+    std::size_t size() const noexcept { return count.load(); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    OP key_comp() const { return comp; }
+};
+
+#endif /* concurrent_bst_h */
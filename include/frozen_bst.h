@@ -0,0 +1,323 @@
+#ifndef frozen_bst_h
+#define frozen_bst_h
+
+#include "bst.h"
+#include <algorithm> //std::min
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Branchless descent on n keys in Eytzinger order: returns the (1-based) position of the first key not less than x, or 0 if there is none.
+ */
+template <typename key_type, typename K, typename OP>
+std::size_t eytzinger_lower_bound(const key_type *base, std::size_t n, const K &x, const OP &comp) noexcept
+{
+    std::size_t k{1};
+    while (k <= n)
+    {
+        BST_PREFETCH(base + std::min(16 * k, n - 1)); //four levels below, without going past the end
+        k = 2 * k + static_cast<std::size_t>(comp(base[k - 1], x));
+    }
+    //the last left turn is where we stopped going right: drop the trailing right turns and that left turn
+#if defined(__GNUC__) || defined(__clang__)
+    k >>= __builtin_ffsll(static_cast<long long>(~k));
+#else
+    while (k & 1)
+    {
+        k >>= 1;
+    }
+    k >>= 1;
+#endif
+    return k;
+}
+
+/**
+ * @brief Read-only iterator of a @ref frozen_bst. Dereferencing yields a pair of references to the key and the value.
+ */
+template <typename Frozen>
+class frozen_iterator
+{
+    const Frozen *tree;
+    std::size_t k; //1-based Eytzinger position, 0 for end()
+
+public:
+    using value_type = typename Frozen::reference;
+    using reference = value_type;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * @brief Helper returned by `operator->`, holding the pair by value.
+     */
+    struct pointer
+    {
+        value_type pair;
+        const value_type *operator->() const noexcept { return &pair; }
+    };
+
+    frozen_iterator() noexcept : tree{nullptr}, k{0} {}
+
+    frozen_iterator(const Frozen *_tree, std::size_t _k) noexcept : tree{_tree}, k{_k} {}
+
+    reference operator*() const noexcept
+    {
+        return reference{tree->keys[k - 1], tree->values[k - 1]};
+    }
+
+    pointer operator->() const noexcept
+    {
+        return pointer{**this};
+    }
+
+    /**
+     * @brief Goes to the next key: the leftmost position of the right subtree, or the first ancestor reached from a left child.
+     */
+    frozen_iterator &operator++() noexcept
+    {
+        const std::size_t n{tree->keys.size()};
+        if (2 * k + 1 <= n)
+        {
+            k = 2 * k + 1;
+            while (2 * k <= n)
+            {
+                k = 2 * k;
+            }
+        }
+        else
+        {
+            while (k & 1)
+            {
+                k >>= 1; //coming from a right child
+            }
+            k >>= 1;
+        }
+        return *this;
+    }
+
+    frozen_iterator operator++(int) noexcept
+    {
+        auto tmp{*this};
+        ++(*this);
+        return tmp;
+    }
+
+    /**
+     * @brief Goes to the previous key. Decrementing end() gives the last key.
+     */
+    frozen_iterator &operator--() noexcept
+    {
+        const std::size_t n{tree->keys.size()};
+        if (k == 0)
+        {
+            k = n ? 1 : 0;
+            while (k && 2 * k + 1 <= n)
+            {
+                k = 2 * k + 1;
+            }
+        }
+        else if (2 * k <= n)
+        {
+            k = 2 * k;
+            while (2 * k + 1 <= n)
+            {
+                k = 2 * k + 1;
+            }
+        }
+        else
+        {
+            while (k > 1 && !(k & 1))
+            {
+                k >>= 1; //coming from a left child
+            }
+            k >>= 1;
+        }
+        return *this;
+    }
+
+    frozen_iterator operator--(int) noexcept
+    {
+        auto tmp{*this};
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const frozen_iterator &other) const noexcept { return k == other.k; }
+    bool operator!=(const frozen_iterator &other) const noexcept { return k != other.k; }
+};
+
+/**
+ * @brief Immutable, contiguous snapshot of a @ref bst for read-heavy workloads.
+ *
+ * The keys are stored in Eytzinger (BFS) order: the children of the key in position k (1-based) are in positions 2k and 2k+1. A lookup is a branchless descent on a single array, with the keys a few levels below prefetched while the current one is compared. The values are stored in a parallel array, in the same order.
+ * Iteration visits the keys in increasing order by walking the implicit tree. Neither the keys nor the values can be `bool`, since the arrays are `std::vector`s and dereferencing an iterator gives references into them.
+ */
+template <typename key_type, typename value_type, typename OP = std::less<key_type>>
+class frozen_bst
+{
+    static_assert(!std::is_same<key_type, bool>::value && !std::is_same<value_type, bool>::value, "frozen_bst can't store bool, since std::vector<bool> can't hand out references: use char");
+
+    /**
+     * @brief Keys in Eytzinger order. The key in (1-based) position k is `keys[k - 1]`.
+     */
+    std::vector<key_type> keys;
+
+    /**
+     * @brief Values, parallel to @ref keys.
+     */
+    std::vector<value_type> values;
+
+    OP comp;
+
+    /**
+     * @brief Fills rank[k] with the position, in increasing order, of the key that goes in Eytzinger position k: an in-order visit of the implicit tree.
+     */
+    static void rank_helper(std::vector<std::size_t> &rank, std::size_t k, std::size_t &next) noexcept
+    {
+        if (k >= rank.size())
+        {
+            return;
+        }
+        rank_helper(rank, 2 * k, next);
+        rank[k] = next++;
+        rank_helper(rank, 2 * k + 1, next);
+    }
+
+    template <typename K>
+    std::size_t lower_bound_helper(const K &x) const noexcept
+    {
+        return eytzinger_lower_bound(keys.data(), keys.size(), x, comp);
+    }
+
+    /**
+     * @brief Eytzinger position of the key equal to x, or 0 if it's missing.
+     */
+    template <typename K>
+    std::size_t find_helper(const K &x) const noexcept
+    {
+        auto k = lower_bound_helper(x);
+        return k && !comp(x, keys[k - 1]) ? k : 0;
+    }
+
+    /**
+     * @brief Same gate as `bst::if_transparent`.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+public:
+    using mapped_type = value_type;
+    using reference = std::pair<const key_type &, const value_type &>;
+    using const_iterator = frozen_iterator<frozen_bst>;
+    using iterator = const_iterator;
+
+    friend class frozen_iterator<frozen_bst>;
+
+    /**
+     * @brief Default constructor: an empty snapshot.
+     */
+    frozen_bst() : keys{}, values{}, comp{} {}
+
+    /**
+     * @brief Builds the snapshot from the pairs in [first,last), which must be strictly increasing by key.
+     * @param first,last Forward iterators to pairs with a `first` and a `second` member
+     * @param _comp The comparison operator, which must be the one used to sort the range
+     */
+    template <typename ForwardIt>
+    frozen_bst(sorted_unique_t, ForwardIt first, ForwardIt last, const OP &_comp = OP{}) : keys{}, values{}, comp{_comp}
+    {
+        std::vector<ForwardIt> sorted{};
+        for (; first != last; ++first)
+        {
+            sorted.push_back(first);
+        }
+        const std::size_t n{sorted.size()};
+        std::vector<std::size_t> rank(n + 1);
+        std::size_t next{0};
+        rank_helper(rank, 1, next);
+        keys.reserve(n);
+        values.reserve(n);
+        for (std::size_t k = 1; k <= n; ++k)
+        {
+            keys.push_back((*sorted[rank[k]]).first);
+            values.push_back((*sorted[rank[k]]).second);
+        }
+    }
+
+    /**
+     * @brief Find a given key. If it's present, returns a @ref const_iterator to it, otherwise @ref end().
+     */
+    const_iterator find(const key_type &x) const noexcept
+    {
+        return const_iterator{this, find_helper(x)};
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref find(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    const_iterator find(const K &x) const noexcept
+    {
+        return const_iterator{this, find_helper(x)};
+    }
+
+    /**
+     * @brief Returns a @ref const_iterator to the first key not less than x, or @ref end().
+     */
+    const_iterator lower_bound(const key_type &x) const noexcept
+    {
+        return const_iterator{this, lower_bound_helper(x)};
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const_iterator lower_bound(const K &x) const noexcept
+    {
+        return const_iterator{this, lower_bound_helper(x)};
+    }
+
+    /**
+     * @brief Returns 1 if the key is present, 0 otherwise.
+     */
+    std::size_t count(const key_type &x) const noexcept
+    {
+        return find_helper(x) ? 1 : 0;
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    std::size_t count(const K &x) const noexcept
+    {
+        return find_helper(x) ? 1 : 0;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        std::size_t k{keys.empty() ? 0u : 1u};
+        while (k && 2 * k <= keys.size())
+        {
+            k = 2 * k;
+        }
+        return const_iterator{this, k};
+    }
+
+    const_iterator end() const noexcept { return const_iterator{this, 0}; }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    std::size_t size() const noexcept { return keys.size(); }
+
+    bool empty() const noexcept { return keys.empty(); }
+};
+
+/**
+ * @brief Freezes a @ref bst into a @ref frozen_bst with the same keys, values and comparison operator. The tree is left untouched.
+ */
+template <typename key_type, typename value_type, typename OP, typename Balance, typename Alloc>
+frozen_bst<typename std::remove_const<key_type>::type, value_type, OP> freeze(const bst<key_type, value_type, OP, Balance, Alloc> &tree)
+{
+    return frozen_bst<typename std::remove_const<key_type>::type, value_type, OP>{sorted_unique, tree.cbegin(), tree.cend(), tree.key_comp()};
+}
+
+#endif /* frozen_bst_h */
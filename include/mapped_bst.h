@@ -0,0 +1,401 @@
+#ifndef mapped_bst_h
+#define mapped_bst_h
+
+#include "Serializer.h"
+#include "frozen_bst.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>    //std::memcpy
+#include <fcntl.h>    //open
+#include <fstream>    //std::ofstream
+#include <stdexcept>  //std::runtime_error
+#include <string>
+#include <sys/mman.h> //mmap, munmap
+#include <sys/stat.h> //fstat
+#include <type_traits>
+#include <unistd.h> //close
+#include <vector>
+
+/**
+ * @brief Header at the start of a file written by @ref write_mapped(). The keys start at `keys_offset` and the values at `values_offset`, both multiples of @ref mapped_format::alignment.
+ */
+struct mapped_header
+{
+    std::uint64_t magic;
+    std::uint32_t byte_order;
+    std::uint32_t reserved;
+    std::uint64_t key_tag;
+    std::uint64_t value_tag;
+    std::uint64_t count;
+    std::uint64_t keys_offset;
+    std::uint64_t values_offset;
+
+    /**
+     * @brief Checksum of the keys and the values, checked only by @ref mapped_bst::verify().
+     */
+    std::uint64_t checksum;
+};
+
+/**
+ * @brief Constants of the format written by @ref write_mapped().
+ */
+struct mapped_format
+{
+    static constexpr std::uint64_t magic = 0x3170616d74736272ULL; //"rbstmap1" on little-endian machines
+    static constexpr std::uint32_t byte_order = 0x01020304;
+
+    /**
+     * @brief Alignment of the two arrays in the file, a cache line.
+     */
+    static constexpr std::uint64_t alignment = 64;
+
+    static constexpr std::uint64_t align(std::uint64_t offset) noexcept
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+};
+
+/**
+ * @brief Read-only array inside a mapped file, with the part of the `std::vector` interface used by @ref frozen_iterator.
+ */
+template <typename T>
+class mapped_array
+{
+    const T *base;
+    std::size_t n;
+
+public:
+    mapped_array() noexcept : base{nullptr}, n{0} {}
+
+    mapped_array(const T *_base, std::size_t _n) noexcept : base{_base}, n{_n} {}
+
+    const T &operator[](std::size_t i) const noexcept { return base[i]; }
+
+    const T *data() const noexcept { return base; }
+
+    std::size_t size() const noexcept { return n; }
+
+    bool empty() const noexcept { return n == 0; }
+};
+
+/**
+ * @brief Read-only view of a tree saved by @ref write_mapped(), searched directly in the memory-mapped file.
+ *
+ * The file holds the keys and the values in two arrays in Eytzinger order, the layout of @ref frozen_bst, so the positions of the children are computed and the file needs no pointers or offsets to fix up. Opening it only maps the file and checks the header: the pages are read by the operating system the first time a lookup touches them, and are shared by all the processes that map the same file.
+ * Only keys and values whose @ref serializer copies them in bulk can be stored: arithmetic and enumeration types, and trivially copyable classes with a @ref trivial_serializer. The header holds their tags. The file uses the byte order of the machine that wrote it, and needs a POSIX system.
+ */
+template <typename key_type, typename value_type, typename OP = std::less<key_type>>
+class mapped_bst
+{
+    static_assert(serializer<key_type>::bulk && serializer<value_type>::bulk, "mapped_bst needs keys and values stored in bulk by their serializer");
+
+    void *address;
+    std::size_t length;
+
+    /**
+     * @brief Keys in Eytzinger order, inside the mapping.
+     */
+    mapped_array<key_type> keys;
+
+    /**
+     * @brief Values, parallel to @ref keys.
+     */
+    mapped_array<value_type> values;
+
+    std::uint64_t checksum;
+
+    OP comp;
+
+    template <typename K>
+    std::size_t lower_bound_helper(const K &x) const noexcept
+    {
+        return eytzinger_lower_bound(keys.data(), keys.size(), x, comp);
+    }
+
+    /**
+     * @brief Eytzinger position of the key equal to x, or 0 if it's missing.
+     */
+    template <typename K>
+    std::size_t find_helper(const K &x) const noexcept
+    {
+        auto k = lower_bound_helper(x);
+        return k && !comp(x, keys[k - 1]) ? k : 0;
+    }
+
+    /**
+     * @brief Same gate as `bst::if_transparent`.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+    void unmap_helper() noexcept
+    {
+        if (address)
+        {
+            munmap(address, length);
+        }
+        address = nullptr;
+        length = 0;
+        keys = mapped_array<key_type>{};
+        values = mapped_array<value_type>{};
+    }
+
+    /**
+     * @brief Checks the header against the types of the tree and the size of the file, and sets up the two arrays.
+     */
+    void validate_helper()
+    {
+        mapped_header h;
+        std::memcpy(&h, address, sizeof(h));
+        if (h.magic != mapped_format::magic || h.byte_order != mapped_format::byte_order)
+        {
+            throw std::runtime_error{"mapped_bst: not a mapped tree, or written with another byte order"};
+        }
+        if (h.key_tag != serializer<key_type>::tag || h.value_tag != serializer<value_type>::tag)
+        {
+            throw std::runtime_error{"mapped_bst: the file holds other key or value types"};
+        }
+        const std::uint64_t max_count{length / (sizeof(key_type) + sizeof(value_type))};
+        if (h.count > max_count || h.keys_offset != mapped_format::align(sizeof(mapped_header)) || h.values_offset != mapped_format::align(h.keys_offset + h.count * sizeof(key_type)) || h.values_offset + h.count * sizeof(value_type) > length)
+        {
+            throw std::runtime_error{"mapped_bst: truncated or corrupted file"};
+        }
+        auto base = static_cast<const char *>(address);
+        const std::size_t n{static_cast<std::size_t>(h.count)};
+        keys = mapped_array<key_type>{reinterpret_cast<const key_type *>(base + h.keys_offset), n};
+        values = mapped_array<value_type>{reinterpret_cast<const value_type *>(base + h.values_offset), n};
+        checksum = h.checksum;
+    }
+
+public:
+    using mapped_type = value_type;
+    using reference = std::pair<const key_type &, const value_type &>;
+    using const_iterator = frozen_iterator<mapped_bst>;
+    using iterator = const_iterator;
+
+    friend class frozen_iterator<mapped_bst>;
+
+    /**
+     * @brief Default constructor: an empty view, with no file.
+     */
+    mapped_bst() noexcept : address{nullptr}, length{0}, keys{}, values{}, checksum{0}, comp{} {}
+
+    /**
+     * @brief Maps the file written by @ref write_mapped() at the given path.
+     * @param _comp The comparison operator, which must be the one of the saved tree
+     * @throw std::runtime_error if the file can't be mapped, or its header doesn't match the types of the tree or the size of the file
+     */
+    explicit mapped_bst(const std::string &path, const OP &_comp = OP{}) : address{nullptr}, length{0}, keys{}, values{}, checksum{0}, comp{_comp}
+    {
+        const int fd{open(path.c_str(), O_RDONLY)};
+        if (fd < 0)
+        {
+            throw std::runtime_error{"mapped_bst: cannot open " + path};
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            close(fd);
+            throw std::runtime_error{"mapped_bst: cannot read the size of " + path};
+        }
+        if (static_cast<std::size_t>(info.st_size) < sizeof(mapped_header))
+        {
+            close(fd);
+            throw std::runtime_error{"mapped_bst: file too short"};
+        }
+        length = static_cast<std::size_t>(info.st_size);
+        void *p{mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0)};
+        close(fd); //the mapping keeps the file open
+        if (p == MAP_FAILED)
+        {
+            length = 0;
+            throw std::runtime_error{"mapped_bst: cannot map " + path};
+        }
+        address = p;
+        try
+        {
+            validate_helper();
+        }
+        catch (...)
+        {
+            unmap_helper();
+            throw;
+        }
+    }
+
+    mapped_bst(const mapped_bst &) = delete;
+    mapped_bst &operator=(const mapped_bst &) = delete;
+
+    mapped_bst(mapped_bst &&other) noexcept : address{other.address}, length{other.length}, keys{other.keys}, values{other.values}, checksum{other.checksum}, comp{std::move(other.comp)}
+    {
+        other.address = nullptr;
+        other.unmap_helper();
+    }
+
+    mapped_bst &operator=(mapped_bst &&other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap_helper();
+            address = other.address;
+            length = other.length;
+            keys = other.keys;
+            values = other.values;
+            checksum = other.checksum;
+            comp = std::move(other.comp);
+            other.address = nullptr;
+            other.unmap_helper();
+        }
+        return *this;
+    }
+
+    ~mapped_bst() noexcept { unmap_helper(); }
+
+    /**
+     * @brief Find a given key. If it's present, returns a @ref const_iterator to it, otherwise @ref end().
+     */
+    const_iterator find(const key_type &x) const noexcept
+    {
+        return const_iterator{this, find_helper(x)};
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref find(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    const_iterator find(const K &x) const noexcept
+    {
+        return const_iterator{this, find_helper(x)};
+    }
+
+    /**
+     * @brief Returns a @ref const_iterator to the first key not less than x, or @ref end().
+     */
+    const_iterator lower_bound(const key_type &x) const noexcept
+    {
+        return const_iterator{this, lower_bound_helper(x)};
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const_iterator lower_bound(const K &x) const noexcept
+    {
+        return const_iterator{this, lower_bound_helper(x)};
+    }
+
+    /**
+     * @brief Returns 1 if the key is present, 0 otherwise.
+     */
+    std::size_t count(const key_type &x) const noexcept
+    {
+        return find_helper(x) ? 1 : 0;
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    std::size_t count(const K &x) const noexcept
+    {
+        return find_helper(x) ? 1 : 0;
+    }
+
+    /**
+     * @brief Compares the keys and the values with the checksum in the header. It reads the whole file, so it's not done when the file is mapped.
+     */
+    bool verify() const noexcept
+    {
+        stream_checksum sum{};
+        sum.update(keys.data(), keys.size() * sizeof(key_type));
+        sum.update(values.data(), values.size() * sizeof(value_type));
+        return sum.value() == checksum;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        std::size_t k{keys.empty() ? 0u : 1u};
+        while (k && 2 * k <= keys.size())
+        {
+            k = 2 * k;
+        }
+        return const_iterator{this, k};
+    }
+
+    const_iterator end() const noexcept { return const_iterator{this, 0}; }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    std::size_t size() const noexcept { return keys.size(); }
+
+    bool empty() const noexcept { return keys.empty(); }
+};
+
+/**
+ * @brief Stores in at[k] the pairs visited in order, for every Eytzinger position k of the implicit tree rooted in k.
+ */
+template <typename P, typename It>
+void mapped_order_helper(std::vector<const P *> &at, std::size_t k, It &it)
+{
+    if (k >= at.size())
+    {
+        return;
+    }
+    mapped_order_helper(at, 2 * k, it);
+    at[k] = &*it;
+    ++it;
+    mapped_order_helper(at, 2 * k + 1, it);
+}
+
+/**
+ * @brief Writes a @ref bst to a file that @ref mapped_bst can map: a @ref mapped_header, then the keys and the values in two arrays in Eytzinger order. The tree is left untouched.
+ * @throw std::runtime_error if the file can't be written
+ */
+template <typename key_type, typename value_type, typename OP, typename Balance, typename Alloc>
+void write_mapped(const bst<key_type, value_type, OP, Balance, Alloc> &tree, const std::string &path)
+{
+    using K = typename std::remove_const<key_type>::type;
+    using P = std::pair<const K, value_type>;
+    static_assert(serializer<K>::bulk && serializer<value_type>::bulk, "write_mapped() needs keys and values stored in bulk by their serializer");
+
+    std::vector<const P *> at(tree.size() + 1);
+    auto it = tree.cbegin();
+    mapped_order_helper(at, 1, it);
+    const std::uint64_t n{tree.size()};
+
+    mapped_header h{};
+    h.magic = mapped_format::magic;
+    h.byte_order = mapped_format::byte_order;
+    h.key_tag = serializer<K>::tag;
+    h.value_tag = serializer<value_type>::tag;
+    h.count = n;
+    h.keys_offset = mapped_format::align(sizeof(mapped_header));
+    h.values_offset = mapped_format::align(h.keys_offset + n * sizeof(K));
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    stream_checksum sum{};
+    const char padding[mapped_format::alignment]{};
+    auto write = [&out](const void *data, std::size_t bytes) {
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+    };
+    write(&h, sizeof(h)); //the checksum is filled in at the end
+    write(padding, h.keys_offset - sizeof(h));
+    for (std::size_t k = 1; k <= n; ++k)
+    {
+        sum.update(&at[k]->first, sizeof(K));
+        write(&at[k]->first, sizeof(K));
+    }
+    write(padding, h.values_offset - (h.keys_offset + n * sizeof(K)));
+    for (std::size_t k = 1; k <= n; ++k)
+    {
+        sum.update(&at[k]->second, sizeof(value_type));
+        write(&at[k]->second, sizeof(value_type));
+    }
+    h.checksum = sum.value();
+    out.seekp(0);
+    write(&h, sizeof(h));
+    out.close();
+    if (!out)
+    {
+        throw std::runtime_error{"write_mapped: cannot write " + path};
+    }
+}
+
+#endif /* mapped_bst_h */
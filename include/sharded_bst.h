@@ -0,0 +1,431 @@
+#ifndef sharded_bst_h
+#define sharded_bst_h
+
+#include "bst.h"
+#include <algorithm> //std::upper_bound
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex> //std::shared_timed_mutex, std::shared_lock
+#include <stdexcept>    //std::out_of_range
+#include <string>       //std::to_string
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Input iterator visiting all the shards of a @ref sharded_bst in key order.
+ *
+ * It holds a shared lock on the routing table and the lock of the shard it's in, so the shards it visits can't be modified or re-split meanwhile. It's move-only; the same thread must not update the map while it holds one that isn't at the end.
+ */
+template <typename Sharded>
+class sharded_iterator
+{
+    using tree_iterator = decltype(std::declval<const typename Sharded::tree_type &>().cbegin());
+
+    const Sharded *owner;
+    std::shared_lock<std::shared_timed_mutex> table_lock;
+    std::unique_lock<std::mutex> shard_lock;
+    std::size_t shard;
+    tree_iterator current;
+
+    friend Sharded;
+
+    /**
+     * @brief Moves to the first pair of the first non-empty shard from the current one on, or becomes the end iterator.
+     */
+    void skip_empty_shards()
+    {
+        for (; shard < owner->shards.size(); ++shard)
+        {
+            shard_lock = std::unique_lock<std::mutex>{owner->shards[shard]->m};
+            current = owner->shards[shard]->tree.cbegin();
+            if (current != owner->shards[shard]->tree.cend())
+            {
+                return;
+            }
+        }
+        shard_lock = std::unique_lock<std::mutex>{};
+        table_lock = std::shared_lock<std::shared_timed_mutex>{};
+        current = tree_iterator{};
+        owner = nullptr;
+    }
+
+    explicit sharded_iterator(const Sharded *_owner) : owner{_owner}, table_lock{_owner->table}, shard_lock{}, shard{0}, current{}
+    {
+        skip_empty_shards();
+    }
+
+public:
+    using value_type = typename Sharded::pair_type;
+    using reference = const value_type &;
+    using pointer = const value_type *;
+    using iterator_category = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * @brief The end iterator, holding no lock.
+     */
+    sharded_iterator() noexcept : owner{nullptr}, table_lock{}, shard_lock{}, shard{0}, current{} {}
+
+    sharded_iterator(sharded_iterator &&) = default;
+    sharded_iterator &operator=(sharded_iterator &&) = default;
+
+    reference operator*() const noexcept { return *current; }
+
+    pointer operator->() const noexcept { return &*current; }
+
+    sharded_iterator &operator++()
+    {
+        ++current;
+        if (current == owner->shards[shard]->tree.cend())
+        {
+            ++shard;
+            skip_empty_shards();
+        }
+        return *this;
+    }
+
+    bool operator==(const sharded_iterator &other) const noexcept
+    {
+        return owner == other.owner && (!owner || (shard == other.shard && current == other.current));
+    }
+
+    bool operator!=(const sharded_iterator &other) const noexcept { return !(*this == other); }
+};
+
+/**
+ * @brief Map split by key ranges into independent @ref bst shards, each with its own lock, so that threads working on different ranges don't wait for each other.
+ *
+ * Shard i holds the keys in [splitters[i-1], splitters[i]). Every operation takes a shared lock on the routing table, finds the shard with a binary search on the splitters and locks that shard only. @ref split_shard() finds the median key of a shard while the other shards keep working, and takes the exclusive lock on the table only to cut the shard there with `bst::split()`, which relinks its Nodes. The shards use the @ref order_statistics policy by default, which makes both steps O(height), so the other shards are only stopped for a few microseconds.
+ * The values can't be handed out by reference, since they would outlive the lock: @ref get() copies them, and @ref update() runs a function on them under the lock.
+ */
+template <typename key_type, typename value_type, typename OP = std::less<key_type>, typename Balance = order_statistics<red_black>>
+class sharded_bst
+{
+public:
+    using tree_type = bst<key_type, value_type, OP, Balance>;
+    using pair_type = std::pair<const key_type, value_type>;
+    using const_iterator = sharded_iterator<sharded_bst>;
+    using iterator = const_iterator;
+
+    friend class sharded_iterator<sharded_bst>;
+
+private:
+    struct shard
+    {
+        std::mutex m;
+        tree_type tree;
+
+        /**
+         * @brief Number of operations routed here, to spot hot shards.
+         */
+        std::atomic<std::size_t> hits;
+
+        shard() : m{}, tree{}, hits{0} {}
+    };
+
+    /**
+     * @brief Guards @ref splitters and @ref shards: shared for the operations, exclusive to add a shard.
+     */
+    mutable std::shared_timed_mutex table;
+
+    std::vector<key_type> splitters;
+    std::vector<std::unique_ptr<shard>> shards;
+
+    OP comp;
+
+    template <typename K>
+    shard &route_helper(const K &x) const
+    {
+        auto i = std::upper_bound(splitters.begin(), splitters.end(), x, comp) - splitters.begin();
+        auto &s = *shards[i];
+        ++s.hits;
+        return s;
+    }
+
+    /**
+     * @brief Shard i, with the table locked. Throws `std::out_of_range` if there is no such shard.
+     */
+    shard &shard_at_helper(std::size_t i) const
+    {
+        if (i >= shards.size())
+        {
+            throw std::out_of_range{"sharded_bst: no shard " + std::to_string(i)};
+        }
+        return *shards[i];
+    }
+
+    /**
+     * @brief Copy of the median key of tree, the smallest one of its upper half, or `nullptr` if tree has fewer than two keys. O(height), by `bst::select()`.
+     */
+    static std::unique_ptr<key_type> median_helper(const tree_type &tree)
+    {
+        const auto n = tree.size();
+        if (n < 2)
+        {
+            return nullptr;
+        }
+        return std::unique_ptr<key_type>{new key_type(tree.select(n / 2)->first)};
+    }
+
+    template <typename K>
+    std::size_t erase_helper(const K &x)
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = route_helper(x);
+        std::lock_guard<std::mutex> lock{s.m};
+        return s.tree.erase(x);
+    }
+
+    template <typename K>
+    bool contains_helper(const K &x) const
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = route_helper(x);
+        std::lock_guard<std::mutex> lock{s.m};
+        return s.tree.find(x) != s.tree.cend();
+    }
+
+    template <typename K>
+    bool get_helper(const K &x, value_type &out) const
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = route_helper(x);
+        std::lock_guard<std::mutex> lock{s.m};
+        auto it = s.tree.find(x);
+        if (it == s.tree.cend())
+        {
+            return false;
+        }
+        out = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Same gate as `bst::if_transparent`.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+public:
+    /**
+     * @brief Builds an empty map with one shard per key range.
+     * @param _splitters Strictly increasing keys that separate the shards: n splitters give n + 1 shards
+     */
+    explicit sharded_bst(std::vector<key_type> _splitters = {}) : table{}, splitters{std::move(_splitters)}, shards{}, comp{}
+    {
+        for (std::size_t i = 0; i <= splitters.size(); ++i)
+        {
+            shards.emplace_back(new shard{});
+        }
+    }
+
+    sharded_bst(const sharded_bst &) = delete;
+    sharded_bst &operator=(const sharded_bst &) = delete;
+
+    /**
+     * @brief Inserts a pair if the key is missing.
+     * @return true if the insertion took place
+     */
+    bool insert(const pair_type &x)
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = route_helper(x.first);
+        std::lock_guard<std::mutex> lock{s.m};
+        return s.tree.insert(x).second;
+    }
+
+    bool insert(pair_type &&x)
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = route_helper(x.first);
+        std::lock_guard<std::mutex> lock{s.m};
+        return s.tree.insert(std::move(x)).second;
+    }
+
+    /**
+     * @brief Inserts a pair, or assigns the value if the key is already present.
+     * @return true if a new key has been inserted
+     */
+    template <typename M>
+    bool insert_or_assign(const key_type &k, M &&v)
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = route_helper(k);
+        std::lock_guard<std::mutex> lock{s.m};
+        return s.tree.insert_or_assign(k, std::forward<M>(v)).second;
+    }
+
+    /**
+     * @brief Erases a key. Returns the number of erased keys (0 or 1).
+     */
+    std::size_t erase(const key_type &x)
+    {
+        return erase_helper(x);
+    }
+
+    /**
+     * @brief Heterogeneous versions of @ref erase(), and below of the lookups. Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    std::size_t erase(const K &x)
+    {
+        return erase_helper(x);
+    }
+
+    bool contains(const key_type &x) const
+    {
+        return contains_helper(x);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    bool contains(const K &x) const
+    {
+        return contains_helper(x);
+    }
+
+    /**
+     * @brief Copies the value of a key into out.
+     * @return false, leaving out untouched, if the key is missing
+     */
+    bool get(const key_type &x, value_type &out) const
+    {
+        return get_helper(x, out);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    bool get(const K &x, value_type &out) const
+    {
+        return get_helper(x, out);
+    }
+
+    /**
+     * @brief Calls f on `tree[k]` of the right shard, under its lock: the thread-safe form of `f(map[k])`, inserting a value-initialized value if the key is missing.
+     */
+    template <typename F>
+    void update(const key_type &k, F f)
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = route_helper(k);
+        std::lock_guard<std::mutex> lock{s.m};
+        f(s.tree[k]);
+    }
+
+    /**
+     * @brief Returns a copy of the value of the key, inserting a value-initialized one if the key is missing.
+     */
+    value_type operator[](const key_type &k)
+    {
+        value_type result{};
+        update(k, [&result](value_type &v) { result = v; });
+        return result;
+    }
+
+    /**
+     * @brief Cuts shard i at its median key. The upper half goes into a new shard i + 1.
+     *
+     * The median key is found by `bst::select()` under the lock of the shard only, so the other shards keep working. The exclusive lock on the table is then taken to cut the shard there with `bst::split()`, which relinks the Nodes without copying them and reads the sizes of the halves from their roots. If the shard has changed meanwhile so that the key no longer cuts it in two, the median is looked up again under the exclusive lock. All of it is O(height), which is why it needs the @ref order_statistics policy.
+     * @return false if the shard has fewer than two keys
+     * @throws std::out_of_range if i is not smaller than @ref shard_count()
+     */
+    bool split_shard(std::size_t i)
+    {
+        static_assert(Balance::counts_subtrees::value, "split_shard() needs shards with the order_statistics policy, the default one");
+        std::unique_ptr<key_type> cut{};
+        {
+            std::shared_lock<std::shared_timed_mutex> table_lock{table};
+            auto &s = shard_at_helper(i);
+            std::lock_guard<std::mutex> lock{s.m};
+            cut = median_helper(s.tree);
+        }
+        if (!cut)
+        {
+            return false;
+        }
+        std::unique_ptr<shard> upper{new shard{}};
+        std::unique_lock<std::shared_timed_mutex> table_lock{table}; //no shard lock is held by anyone now
+        auto &s = shard_at_helper(i);
+        const bool cuts{!s.tree.empty() && comp(s.tree.cbegin()->first, *cut) && s.tree.lower_bound(*cut) != s.tree.cend()};
+        if (!cuts && !(cut = median_helper(s.tree)))
+        {
+            return false;
+        }
+        upper->tree = s.tree.split(*cut);
+        splitters.insert(splitters.begin() + i, std::move(*cut));
+        shards.insert(shards.begin() + i + 1, std::move(upper));
+        return true;
+    }
+
+    /**
+     * @brief Splits the shard that received the most operations since the last split, and resets the counters.
+     * @return false if that shard has fewer than two keys
+     */
+    bool split_hottest()
+    {
+        std::size_t hottest{0};
+        {
+            std::shared_lock<std::shared_timed_mutex> table_lock{table};
+            for (std::size_t i = 1; i < shards.size(); ++i)
+            {
+                if (shards[i]->hits > shards[hottest]->hits)
+                {
+                    hottest = i;
+                }
+            }
+            for (auto &s : shards)
+            {
+                s->hits = 0;
+            }
+        }
+        return split_shard(hottest);
+    }
+
+    std::size_t shard_count() const
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        return shards.size();
+    }
+
+    /**
+     * @brief Number of keys in shard i. Throws `std::out_of_range` if there is no such shard.
+     */
+    std::size_t shard_size(std::size_t i) const
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        auto &s = shard_at_helper(i);
+        std::lock_guard<std::mutex> lock{s.m};
+        return s.tree.size();
+    }
+
+    /**
+     * @brief Total number of keys. With concurrent updates, each shard is counted at a different moment.
+     */
+    std::size_t size() const
+    {
+        std::shared_lock<std::shared_timed_mutex> table_lock{table};
+        std::size_t n{0};
+        for (auto &s : shards)
+        {
+            std::lock_guard<std::mutex> lock{s->m};
+            n += s->tree.size();
+        }
+        return n;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Iterator to the smallest key of all the shards. See @ref sharded_iterator for the locks it holds.
+     */
+    const_iterator begin() const { return const_iterator{this}; }
+
+    const_iterator end() const noexcept { return const_iterator{}; }
+
+    const_iterator cbegin() const { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+};
+
+#endif /* sharded_bst_h */
@@ -0,0 +1,718 @@
+#ifndef snapshot_bst_h
+#define snapshot_bst_h
+
+#include "bst.h"
+#include <algorithm> //std::max
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional> //std::hash
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread> //std::this_thread::get_id
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Immutable Node of a @ref snapshot_bst. Once published it's never modified: an update copies the path from the root to the changed Node and shares every other subtree with the previous versions.
+ */
+template <typename T>
+struct persistent_node
+{
+    using pointer = std::shared_ptr<const persistent_node>;
+
+    T data;
+    pointer left;
+    pointer right;
+    int height; //of the subtree rooted here, as in avl
+
+    template <typename... Args>
+    persistent_node(pointer _left, pointer _right, Args &&...args) : data(std::forward<Args>(args)...), left{std::move(_left)}, right{std::move(_right)}, height{1 + std::max(height_of(left.get()), height_of(right.get()))} {}
+
+    static int height_of(const persistent_node *n) noexcept
+    {
+        return n ? n->height : 0;
+    }
+};
+
+/**
+ * @brief Forward iterator over a version of a @ref snapshot_bst. It keeps the path of the Nodes whose left subtree is being visited, the current one on top.
+ */
+template <typename Node>
+class snapshot_iterator
+{
+    std::vector<const Node *> path;
+
+    template <typename, typename, typename>
+    friend class tree_snapshot;
+
+    void push_leftmost(const Node *n)
+    {
+        for (; n; n = n->left.get())
+        {
+            path.push_back(n);
+        }
+    }
+
+public:
+    using value_type = decltype(Node::data);
+    using reference = const value_type &;
+    using pointer = const value_type *;
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    snapshot_iterator() = default;
+
+    reference operator*() const noexcept { return path.back()->data; }
+
+    pointer operator->() const noexcept { return &**this; }
+
+    snapshot_iterator &operator++()
+    {
+        auto n = path.back();
+        path.pop_back();
+        push_leftmost(n->right.get());
+        return *this;
+    }
+
+    snapshot_iterator operator++(int)
+    {
+        auto tmp{*this};
+        ++(*this);
+        return tmp;
+    }
+
+    bool operator==(const snapshot_iterator &other) const noexcept
+    {
+        return path.empty() ? other.path.empty() : !other.path.empty() && path.back() == other.path.back();
+    }
+
+    bool operator!=(const snapshot_iterator &other) const noexcept { return !(*this == other); }
+};
+
+/**
+ * @brief Read-only view of one version of a @ref snapshot_bst, returned by `snapshot_bst::snapshot()`. It keeps its version alive, and nothing the writer does afterwards is visible through it.
+ */
+template <typename key_type, typename value_type, typename OP>
+class tree_snapshot
+{
+public:
+    using pair_type = std::pair<const key_type, value_type>;
+    using node_type = persistent_node<pair_type>;
+    using const_iterator = snapshot_iterator<node_type>;
+    using iterator = const_iterator;
+
+    /**
+     * @brief A published version: the root and the number of Nodes.
+     */
+    struct version
+    {
+        typename node_type::pointer root;
+        std::size_t size;
+    };
+
+private:
+    std::shared_ptr<const version> current;
+    OP comp;
+
+    template <typename K>
+    const_iterator bound_helper(const K &x, bool strict) const
+    {
+        const_iterator it{};
+        auto n = current->root.get();
+        while (n)
+        {
+            if (strict ? comp(x, n->data.first) : !comp(n->data.first, x))
+            {
+                it.path.push_back(n); //n is a candidate, and what follows it is on the path
+                n = n->left.get();
+            }
+            else
+            {
+                n = n->right.get();
+            }
+        }
+        return it;
+    }
+
+    template <typename K>
+    const value_type *get_helper(const K &x) const noexcept
+    {
+        auto n = current->root.get();
+        while (n)
+        {
+            if (comp(x, n->data.first))
+            {
+                n = n->left.get();
+            }
+            else if (comp(n->data.first, x))
+            {
+                n = n->right.get();
+            }
+            else
+            {
+                return &n->data.second;
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename K>
+    const_iterator find_helper(const K &x) const
+    {
+        auto it = bound_helper(x, false);
+        if (it != end() && comp(x, it->first))
+        {
+            return end();
+        }
+        return it;
+    }
+
+    template <typename K>
+    iterator_range<const_iterator> range_helper(const K &a, const K &b) const
+    {
+        auto first = bound_helper(a, false);
+        auto last = first == end() || !comp(first->first, b) ? first : bound_helper(b, false);
+        return iterator_range<const_iterator>{first, last};
+    }
+
+    /**
+     * @brief Same gate as `bst::if_transparent`.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+public:
+    tree_snapshot(std::shared_ptr<const version> _current, const OP &_comp) : current{std::move(_current)}, comp{_comp} {}
+
+    /**
+     * @brief Find a given key. If it's present, returns a @ref const_iterator to it, otherwise @ref end().
+     */
+    const_iterator find(const key_type &x) const
+    {
+        return find_helper(x);
+    }
+
+    /**
+     * @brief Heterogeneous versions of @ref find(), and below of the other lookups. Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    const_iterator find(const K &x) const
+    {
+        return find_helper(x);
+    }
+
+    /**
+     * @brief Pointer to the value of a key, or `nullptr` if the key is missing. Unlike @ref find(), it doesn't allocate.
+     */
+    const value_type *get(const key_type &x) const noexcept
+    {
+        return get_helper(x);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const value_type *get(const K &x) const noexcept
+    {
+        return get_helper(x);
+    }
+
+    std::size_t count(const key_type &x) const noexcept
+    {
+        return get_helper(x) ? 1 : 0;
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    std::size_t count(const K &x) const noexcept
+    {
+        return get_helper(x) ? 1 : 0;
+    }
+
+    const_iterator lower_bound(const key_type &x) const
+    {
+        return bound_helper(x, false);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const_iterator lower_bound(const K &x) const
+    {
+        return bound_helper(x, false);
+    }
+
+    const_iterator upper_bound(const key_type &x) const
+    {
+        return bound_helper(x, true);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    const_iterator upper_bound(const K &x) const
+    {
+        return bound_helper(x, true);
+    }
+
+    /**
+     * @brief The Nodes with keys in [a,b).
+     */
+    iterator_range<const_iterator> range(const key_type &a, const key_type &b) const
+    {
+        return range_helper(a, b);
+    }
+
+    template <typename K, if_transparent<K> = 0>
+    iterator_range<const_iterator> range(const K &a, const K &b) const
+    {
+        return range_helper(a, b);
+    }
+
+    const_iterator begin() const
+    {
+        const_iterator it{};
+        it.push_leftmost(current->root.get());
+        return it;
+    }
+
+    const_iterator end() const noexcept { return const_iterator{}; }
+
+    const_iterator cbegin() const { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    std::size_t size() const noexcept { return current->size; }
+
+    bool empty() const noexcept { return current->size == 0; }
+};
+
+/**
+ * @brief Map for one writer and many concurrent readers, with read-copy-update.
+ *
+ * The tree is a persistent AVL tree of immutable @ref persistent_node: an update builds a new version that shares all the untouched subtrees with the previous one, and publishes it by swapping an atomic pointer to a @ref publication. A reader calls @ref snapshot() and runs its lookups, range queries and iterations on that version.
+ * Taking a snapshot is lock-free and doesn't write to any memory shared with the other readers. The reader claims a free @ref reader_slot, announces there the publication it reads (a hazard pointer, so that the writer doesn't free it meanwhile), and hands out the pointer pinned in the slot, which has a reference count of its own: the count of the version is only touched once per slot and version. The writer frees a replaced publication once no slot announces it, and drops the pins of the idle slots on older versions. A Node is freed when the last version holding it goes away, so the reference counts play the role of epochs.
+ * The updates are serialized by a mutex, so more writers are safe, but they don't run in parallel. Each update allocates O(log n) Nodes and copies their pairs.
+ */
+template <typename key_type, typename value_type, typename OP = std::less<key_type>>
+class snapshot_bst
+{
+public:
+    using snapshot_type = tree_snapshot<key_type, value_type, OP>;
+    using pair_type = typename snapshot_type::pair_type;
+
+private:
+    using node_type = typename snapshot_type::node_type;
+    using node_pointer = typename node_type::pointer;
+    using version = typename snapshot_type::version;
+
+    /**
+     * @brief A published version with its number. It never changes, and it's freed by the writer once it has been replaced and no reader announces it (see @ref reclaim_helper()).
+     */
+    struct publication
+    {
+        std::shared_ptr<const version> v;
+        std::uint64_t epoch;
+    };
+
+    /**
+     * @brief Where a reader takes its snapshot. A reader claims a free slot, starting from one chosen by its thread id, so readers only share a slot if their ids collide, and then just move on to the next one.
+     */
+    struct reader_slot
+    {
+        std::atomic<bool> busy;
+
+        /**
+         * @brief The publication the reader in the slot is reading, which the writer must not free.
+         */
+        std::atomic<const publication *> hazard;
+
+        /**
+         * @brief Number of the version in @ref pin.
+         */
+        std::uint64_t epoch;
+
+        /**
+         * @brief Copy of the pointer to a version, with a reference count of its own: the snapshots taken from the slot share the version through it, by the aliasing constructor of `std::shared_ptr`.
+         */
+        std::shared_ptr<const std::shared_ptr<const version>> pin;
+
+        char padding[64]; //keeps the fields of different slots on different cache lines
+
+        reader_slot() : busy{false}, hazard{nullptr}, epoch{0}, pin{}, padding{} {}
+    };
+
+    static constexpr std::size_t reader_slots{64};
+
+    /**
+     * @brief The latest publication. Replaced by the writer, read by the readers through their @ref reader_slot.
+     */
+    std::atomic<const publication *> current;
+
+    mutable std::array<reader_slot, reader_slots> slots;
+
+    /**
+     * @brief Replaced publications that a reader may still be reading. Only accessed by the writer.
+     */
+    std::vector<const publication *> retired;
+
+    /**
+     * @brief Number of the latest publication. Only accessed by the writer.
+     */
+    std::uint64_t epoch;
+
+    std::atomic<std::size_t> published_size;
+
+    /**
+     * @brief Serializes the writers.
+     */
+    mutable std::mutex writer;
+
+    OP comp;
+
+    template <typename... Args>
+    static node_pointer make_node(node_pointer left, node_pointer right, Args &&...args)
+    {
+        return std::make_shared<node_type>(std::move(left), std::move(right), std::forward<Args>(args)...);
+    }
+
+    static int height(const node_pointer &n) noexcept
+    {
+        return node_type::height_of(n.get());
+    }
+
+    /**
+     * @brief New Node with the pair of n between the subtrees l and r, whose heights differ at most by two, rotating as `avl::rebalance` does.
+     */
+    static node_pointer rebalance(node_pointer l, node_pointer r, const node_type &n)
+    {
+        if (height(l) > height(r) + 1)
+        {
+            if (height(l->left) >= height(l->right))
+            {
+                return make_node(l->left, make_node(l->right, std::move(r), n.data), l->data);
+            }
+            auto lr = l->right; //left-right case
+            return make_node(make_node(l->left, lr->left, l->data), make_node(lr->right, std::move(r), n.data), lr->data);
+        }
+        if (height(r) > height(l) + 1)
+        {
+            if (height(r->right) >= height(r->left))
+            {
+                return make_node(make_node(std::move(l), r->left, n.data), r->right, r->data);
+            }
+            auto rl = r->left; //right-left case
+            return make_node(make_node(std::move(l), rl->left, n.data), make_node(rl->right, r->right, r->data), rl->data);
+        }
+        return make_node(std::move(l), std::move(r), n.data);
+    }
+
+    /**
+     * @brief Returns the version of the subtree t holding x. If the key is already there, the subtree is returned unchanged unless assign is true.
+     * @param inserted Set to true if a new Node has been created
+     */
+    template <typename P>
+    node_pointer insert_helper(const node_pointer &t, P &&x, bool assign, bool &inserted)
+    {
+        if (!t)
+        {
+            inserted = true;
+            return make_node(nullptr, nullptr, std::forward<P>(x));
+        }
+        if (comp(x.first, t->data.first))
+        {
+            auto l = insert_helper(t->left, std::forward<P>(x), assign, inserted);
+            return l == t->left ? t : rebalance(std::move(l), t->right, *t);
+        }
+        if (comp(t->data.first, x.first))
+        {
+            auto r = insert_helper(t->right, std::forward<P>(x), assign, inserted);
+            return r == t->right ? t : rebalance(t->left, std::move(r), *t);
+        }
+        return assign ? make_node(t->left, t->right, std::forward<P>(x)) : t;
+    }
+
+    /**
+     * @brief Returns the subtree t without its leftmost Node, which is stored in min.
+     */
+    static node_pointer erase_min_helper(const node_pointer &t, node_pointer &min)
+    {
+        if (!t->left)
+        {
+            min = t;
+            return t->right;
+        }
+        return rebalance(erase_min_helper(t->left, min), t->right, *t);
+    }
+
+    template <typename K>
+    node_pointer erase_helper(const node_pointer &t, const K &x)
+    {
+        if (!t)
+        {
+            return t;
+        }
+        if (comp(x, t->data.first))
+        {
+            auto l = erase_helper(t->left, x);
+            return l == t->left ? t : rebalance(std::move(l), t->right, *t);
+        }
+        if (comp(t->data.first, x))
+        {
+            auto r = erase_helper(t->right, x);
+            return r == t->right ? t : rebalance(t->left, std::move(r), *t);
+        }
+        if (!t->left || !t->right)
+        {
+            return t->left ? t->left : t->right;
+        }
+        node_pointer min{};
+        auto r = erase_min_helper(t->right, min);
+        return rebalance(t->left, std::move(r), *min); //the successor takes the place of t
+    }
+
+    /**
+     * @brief The latest version, for the writer, which is the only one that replaces it.
+     */
+    const std::shared_ptr<const version> &latest() const noexcept
+    {
+        return current.load(std::memory_order_relaxed)->v;
+    }
+
+    void publish(node_pointer root, std::size_t size)
+    {
+        std::unique_ptr<const publication> p{new publication{std::make_shared<version>(version{std::move(root), size}), epoch + 1}};
+        retired.reserve(retired.size() + 1); //nothing throws after the swap
+        ++epoch;
+        retired.push_back(current.exchange(p.release()));
+        published_size = size;
+        reclaim_helper();
+    }
+
+    /**
+     * @brief Frees the retired publications that no slot announces, and drops the pins of the idle slots that hold an older version, so that a version goes away with its last snapshot. O(number of slots) per update.
+     * A reader announces a publication and then checks that it's still the current one, while the writer replaces it and then reads the announcements: so either the writer sees the announcement, or the reader sees the new publication and retries.
+     */
+    void reclaim_helper() noexcept
+    {
+        std::size_t kept{0};
+        for (auto p : retired)
+        {
+            bool announced{false};
+            for (const auto &s : slots)
+            {
+                announced = announced || s.hazard.load() == p;
+            }
+            if (announced)
+            {
+                retired[kept++] = p;
+            }
+            else
+            {
+                delete p;
+            }
+        }
+        retired.resize(kept);
+        for (auto &s : slots)
+        {
+            bool expected{false};
+            if (!s.busy.load(std::memory_order_relaxed) && s.busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                if (s.epoch != epoch)
+                {
+                    s.pin.reset();
+                }
+                s.busy.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    /**
+     * @brief Claims a free @ref reader_slot, starting from the one of the calling thread.
+     */
+    reader_slot &claim_helper() const noexcept
+    {
+        for (auto i = std::hash<std::thread::id>{}(std::this_thread::get_id());; ++i)
+        {
+            auto &s = slots[i % reader_slots];
+            bool expected{false};
+            if (!s.busy.load(std::memory_order_relaxed) && s.busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return s;
+            }
+        }
+    }
+
+    /**
+     * @brief Pointer to the latest version taken from the slot s, which must be claimed: the pin of s is replaced first if it's older.
+     */
+    std::shared_ptr<const version> pinned_helper(reader_slot &s) const
+    {
+        const publication *p{current.load()};
+        s.hazard = p;
+        while (current.load() != p) //replaced before it was announced: it may be gone
+        {
+            p = current.load();
+            s.hazard = p;
+        }
+        if (!s.pin || s.epoch != p->epoch)
+        {
+            try
+            {
+                s.pin = std::make_shared<const std::shared_ptr<const version>>(p->v);
+            }
+            catch (...)
+            {
+                s.hazard = nullptr;
+                throw;
+            }
+            s.epoch = p->epoch;
+        }
+        s.hazard = nullptr;
+        return std::shared_ptr<const version>{s.pin, s.pin->get()};
+    }
+
+    template <typename P>
+    bool update_helper(P &&x, bool assign)
+    {
+        std::lock_guard<std::mutex> lock{writer};
+        auto old = latest();
+        bool inserted{false};
+        auto root = insert_helper(old->root, std::forward<P>(x), assign, inserted);
+        if (root != old->root)
+        {
+            publish(std::move(root), old->size + (inserted ? 1 : 0));
+        }
+        return inserted;
+    }
+
+    template <typename K>
+    std::size_t erase_key_helper(const K &x)
+    {
+        std::lock_guard<std::mutex> lock{writer};
+        auto old = latest();
+        auto root = erase_helper(old->root, x);
+        if (root == old->root)
+        {
+            return 0;
+        }
+        publish(std::move(root), old->size - 1);
+        return 1;
+    }
+
+    /**
+     * @brief Same gate as `bst::if_transparent`.
+     */
+    template <typename K, typename C = OP>
+    using if_transparent = if_transparent_probe<K, key_type, C>;
+
+public:
+    /**
+     * @brief Default constructor: an empty tree.
+     */
+    snapshot_bst() : snapshot_bst{OP{}} {}
+
+    explicit snapshot_bst(const OP &_comp) : current{new publication{std::make_shared<version>(version{nullptr, 0}), 0}}, slots{}, retired{}, epoch{0}, published_size{0}, writer{}, comp{_comp} {}
+
+    snapshot_bst(const snapshot_bst &) = delete;
+    snapshot_bst &operator=(const snapshot_bst &) = delete;
+
+    ~snapshot_bst() noexcept
+    {
+        delete current.load();
+        for (auto p : retired)
+        {
+            delete p;
+        }
+    }
+
+    /**
+     * @brief Returns the latest published version. It never waits, neither for the writer nor for the other readers (see the class comment), and the result stays valid and unchanged for as long as it's kept.
+     */
+    snapshot_type snapshot() const
+    {
+        auto &s = claim_helper();
+        std::shared_ptr<const version> v{};
+        try
+        {
+            v = pinned_helper(s);
+        }
+        catch (...)
+        {
+            s.busy.store(false, std::memory_order_release);
+            throw;
+        }
+        s.busy.store(false, std::memory_order_release);
+        return snapshot_type{std::move(v), comp};
+    }
+
+    /**
+     * @brief Inserts a pair and publishes the new version. If the key is already present nothing changes.
+     * @return true if the insertion took place
+     */
+    bool insert(const pair_type &x)
+    {
+        return update_helper(x, false);
+    }
+
+    bool insert(pair_type &&x)
+    {
+        return update_helper(std::move(x), false);
+    }
+
+    /**
+     * @brief Inserts a pair, or replaces the value if the key is already present, and publishes the new version.
+     * @return true if a new key has been inserted
+     */
+    bool insert_or_assign(const pair_type &x)
+    {
+        return update_helper(x, true);
+    }
+
+    bool insert_or_assign(pair_type &&x)
+    {
+        return update_helper(std::move(x), true);
+    }
+
+    /**
+     * @brief Erases a key and publishes the new version. Returns the number of erased Nodes (0 or 1).
+     */
+    std::size_t erase(const key_type &x)
+    {
+        return erase_key_helper(x);
+    }
+
+    /**
+     * @brief Heterogeneous version of @ref erase(). Available only if `OP::is_transparent` exists.
+     */
+    template <typename K, if_transparent<K> = 0>
+    std::size_t erase(const K &x)
+    {
+        return erase_key_helper(x);
+    }
+
+    /**
+     * @brief Publishes an empty version. The Nodes are freed when the last snapshot holding them goes away.
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock{writer};
+        publish(nullptr, 0);
+    }
+
+    /**
+     * @brief Size of the latest version.
+     */
+    std::size_t size() const
+    {
+        return published_size;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    OP key_comp() const { return comp; }
+};
+
+template <typename key_type, typename value_type, typename OP>
+constexpr std::size_t snapshot_bst<key_type, value_type, OP>::reader_slots;
+
+#endif /* snapshot_bst_h */
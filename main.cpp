@@ -20,13 +20,13 @@ int main()
     Node<intpair> parent_node{parent_pair, nullptr};
     std::pair<int, int> elf_pair{11, 11};
 
-    parent_node.right = std::unique_ptr<Node<intpair>>{new Node<intpair>{elf_pair, &parent_node}};
+    parent_node.right = Node<intpair>::owner{new Node<intpair>{elf_pair, &parent_node}};
     std::pair<int, int> nine_pair{9, 9};
     std::pair<int, int> ten_pair{10, 10};
     std::pair<int, int> frteen_pair{14, 14};
 
-    parent_node.right->right = std::unique_ptr<Node<intpair>>{new Node<intpair>{frteen_pair, parent_node.right.get()}};
-    parent_node.right->left = std::unique_ptr<Node<intpair>>{new Node<intpair>{ten_pair, parent_node.right.get()}};
+    parent_node.right->right = Node<intpair>::owner{new Node<intpair>{frteen_pair, parent_node.right.get()}};
+    parent_node.right->left = Node<intpair>::owner{new Node<intpair>{ten_pair, parent_node.right.get()}};
     parent_node.right->left->left.reset(new Node<intpair>{nine_pair, parent_node.right->left.get()});
 
     parent_node.print();
@@ -199,14 +199,11 @@ int main()
     auto ert7{erasure_test3.insert(intpair(7, 7))};
     //    auto ert6{erasure_test3.insert(intpair(12,12))};
 
-    try
+    erasure_test3.erase(8);
+    if (!erasure_test3.erase(60))
     {
-        erasure_test3.erase(8);
-        erasure_test3.erase(60);
-    }
-    catch (const key_not_found &s)
-    {
-        std::cerr << s.what() << "\n";
+        std::cerr << "Couldn't find a Node with key = 60"
+                  << "\n";
     }
 
     std::cout << "Let's build another tree where the successor is the next one and has NO child"
@@ -1,5 +1,8 @@
 #include "../include/bst.h"
+#include <algorithm>
 #include <gtest/gtest.h>
+#include <random>
+#include <string>
 
 template <typename key_type, typename value_type>
 void tree_generator(bst<key_type, value_type> &tree)
@@ -164,4 +167,832 @@ TEST(Tree_Tests, erasure_test_two_children)
     EXPECT_EQ(it2->first, 11);
     EXPECT_EQ((++it2)->first, 12);
     EXPECT_EQ((++it2)->first, 15);
-}
\ No newline at end of file
+}
+TEST(Balancing_Tests, avl_sorted_insertion)
+{
+    bst<int, int, std::less<int>, avl> tree{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    EXPECT_TRUE(tree.is_balanced()); //no need to call balance()
+    int expected{0};
+    for (const auto &p : tree)
+    {
+        EXPECT_EQ(p.first, expected++);
+    }
+    EXPECT_EQ(expected, 1000);
+}
+
+TEST(Balancing_Tests, avl_erasure)
+{
+    bst<int, int, std::less<int>, avl> tree{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    for (int i = 0; i < 1000; i += 3)
+    {
+        tree.erase(i);
+    }
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.find(3), tree.end());
+    EXPECT_EQ(tree.find(4)->second, 4);
+}
+
+TEST(Balancing_Tests, red_black_reverse_insertion_and_erasure)
+{
+    bst<int, int, std::less<int>, red_black> tree{};
+    for (int i = 1000; i > 0; --i)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    for (int i = 2; i <= 1000; i += 2)
+    {
+        tree.erase(i);
+    }
+    int expected{1};
+    for (const auto &p : tree)
+    {
+        EXPECT_EQ(p.first, expected);
+        expected += 2;
+    }
+    EXPECT_EQ(expected, 1001);
+    tree.balance(); //still allowed, it rebuilds a perfectly balanced shape
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.find(501)->second, 501);
+}
+
+struct copy_counter
+{
+    static int copies;
+    int value;
+    copy_counter(int v = 0) : value{v} {}
+    copy_counter(const copy_counter &other) : value{other.value} { ++copies; }
+    copy_counter(copy_counter &&other) noexcept : value{other.value} {}
+    copy_counter &operator=(const copy_counter &other)
+    {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+};
+int copy_counter::copies = 0;
+
+TEST(TreeTests, balance_relinks_nodes)
+{
+    bst<int, copy_counter> tree{};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree.insert(std::pair<const int, copy_counter>{i, copy_counter{i}});
+    }
+    auto address = &tree.find(42)->second;
+    copy_counter::copies = 0;
+    tree.balance();
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(copy_counter::copies, 0);         //no pair has been copied
+    EXPECT_EQ(&tree.find(42)->second, address); //the Node is still the same
+    int expected{0};
+    for (const auto &p : tree)
+    {
+        EXPECT_EQ(p.second.value, expected++);
+    }
+
+    bst<int, int> empty{};
+    empty.balance(); //nothing to do
+    EXPECT_EQ(empty.begin(), empty.end());
+}
+
+TEST(TreeTests, sorted_range_constructor)
+{
+    std::vector<std::pair<int, copy_counter>> v{};
+    for (int i = 0; i < 100; ++i)
+    {
+        v.emplace_back(i, copy_counter{i});
+    }
+    copy_counter::copies = 0;
+    bst<int, copy_counter> tree{sorted_unique, std::make_move_iterator(v.begin()), std::make_move_iterator(v.end())};
+    EXPECT_EQ(copy_counter::copies, 0); //values have been moved
+    EXPECT_TRUE(tree.is_balanced());
+    int expected{0};
+    for (const auto &p : tree)
+    {
+        EXPECT_EQ(p.second.value, expected++);
+    }
+    EXPECT_EQ(expected, 100);
+}
+
+TEST(TreeTests, unsorted_range_constructor_and_assign)
+{
+    std::vector<std::pair<int, int>> v{{5, 5}, {1, 1}, {9, 9}, {5, 50}, {3, 3}, {7, 7}};
+    bst<int, int, std::less<int>, red_black> tree{v.begin(), v.end()};
+    EXPECT_EQ(tree.find(5)->second, 5); //first occurrence wins, as with insert
+    std::vector<int> keys{};
+    for (const auto &p : tree)
+    {
+        keys.push_back(p.first);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{1, 3, 5, 7, 9}));
+
+    std::vector<std::pair<const int, int>> sorted{{10, 10}, {20, 20}, {30, 30}};
+    tree.assign(sorted.begin(), sorted.end()); //detected as sorted
+    EXPECT_EQ(tree.find(5), tree.end());
+    EXPECT_EQ(tree.find(20)->second, 20);
+    EXPECT_TRUE(tree.is_balanced());
+
+    tree.assign(sorted.end(), sorted.end());
+    EXPECT_EQ(tree.begin(), tree.end());
+}
+
+TEST(TreeTests, clear_degenerate_tree)
+{
+    bst<int, int> tree{};
+    for (int i = 0; i < 5000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, i}); //linked-list-shaped tree
+    }
+    bst<int, int> other{};
+    other.insert(std::pair<const int, int>{1, 1});
+    other = tree; //copy assignment clears other first
+    EXPECT_EQ(other.find(4999)->second, 4999);
+    tree.clear();
+    EXPECT_EQ(tree.begin(), tree.end());
+    tree.insert(std::pair<const int, int>{3, 3}); //the tree can be used again
+    EXPECT_EQ(tree.find(3)->second, 3);
+}
+
+TEST(TreeTests, copy_empty_tree)
+{
+    bst<int, int> tree{};
+    bst<int, int> copy{tree};
+    EXPECT_EQ(copy.begin(), copy.end());
+    copy.insert(std::pair<const int, int>{1, 1});
+    EXPECT_EQ(tree.find(1), tree.end());
+}
+
+TEST(TreeTests, parallel_copy)
+{
+    std::vector<std::pair<int, int>> v{};
+    for (int i = 0; i < 10000; ++i)
+    {
+        v.emplace_back(i, 2 * i);
+    }
+    bst<int, int, std::less<int>, avl> tree{sorted_unique, v.begin(), v.end()};
+    for (unsigned int threads : {1u, 3u, 8u})
+    {
+        bst<int, int, std::less<int>, avl> copy{tree, parallel_copy{threads}};
+        auto original_it = tree.cbegin();
+        for (auto it = copy.cbegin(); it != copy.cend(); ++it, ++original_it)
+        {
+            EXPECT_EQ(it->second, original_it->second);
+        }
+        EXPECT_EQ(original_it, tree.cend());
+        copy.erase(5000);
+        EXPECT_EQ(tree.find(5000)->second, 10000); //the copy is deep
+        EXPECT_TRUE(copy.is_balanced());
+    }
+}
+
+TEST(TreeTests, parallel_build)
+{
+    std::vector<std::pair<int, int>> v{};
+    std::mt19937 gen{11};
+    for (int i = 0; i < 20000; ++i)
+    {
+        v.emplace_back(static_cast<int>(gen() % 5000), i); //with duplicate keys
+    }
+    bst<int, int, std::less<int>, avl> sequential{v.begin(), v.end()};
+    for (unsigned int threads : {1u, 3u, 4u, 7u})
+    {
+        bst<int, int, std::less<int>, order_statistics<red_black>> tree{v.begin(), v.end(), parallel_build{threads}};
+        EXPECT_EQ(tree.size(), sequential.size());
+        auto expected = sequential.cbegin();
+        for (const auto &p : tree)
+        {
+            EXPECT_EQ(p.first, expected->first);
+            EXPECT_EQ(p.second, expected->second); //the first pair with each key wins
+            ++expected;
+        }
+        EXPECT_TRUE(tree.is_balanced());
+        EXPECT_EQ(tree.rank(tree.select(1000)->first), 1000u);
+        EXPECT_EQ((--tree.end())->first, (--sequential.end())->first);
+        tree.insert(std::pair<const int, int>{-1, 0});
+        EXPECT_EQ(tree.begin()->first, -1);
+    }
+    bst<int, int, std::less<int>, avl, pool_allocator<std::pair<const int, int>>> pooled{v.begin(), v.end(), parallel_build{4}}; //sequential linking
+    EXPECT_EQ(pooled.size(), sequential.size());
+    std::vector<std::pair<int, int>> empty{};
+    bst<int, int> none{empty.begin(), empty.end(), parallel_build{4}};
+    EXPECT_EQ(none.begin(), none.end());
+}
+
+TEST(TreeTests, merge)
+{
+    using tree_type = bst<int, int, std::less<int>, order_statistics<red_black>>;
+    tree_type a{};
+    tree_type b{};
+    for (int i = 0; i < 3000; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            a.insert(std::pair<const int, int>{i, 1});
+        }
+        if (i % 3 == 0)
+        {
+            b.insert(std::pair<const int, int>{i, 2});
+        }
+    }
+    auto moved = &b.find(3)->second;
+    a.merge(b);
+    EXPECT_EQ(a.size(), 2000u);
+    EXPECT_EQ(&a.find(3)->second, moved); //the Node has been spliced, not copied
+    EXPECT_EQ(a.find(6)->second, 1);      //the Node of a wins
+    EXPECT_EQ(b.size(), 500u);            //multiples of 6 stay in b
+    for (const auto &p : b)
+    {
+        EXPECT_EQ(p.first % 6, 0);
+    }
+    int previous{-1};
+    for (const auto &p : a)
+    {
+        EXPECT_LT(previous, p.first);
+        previous = p.first;
+    }
+    EXPECT_TRUE(b.is_balanced()); //rebuilt from the Nodes left behind
+    EXPECT_EQ(a.rank(2997), 1998u);
+    EXPECT_EQ(b.select(10)->first, 60);
+    EXPECT_EQ((--a.end())->first, 2998);
+
+    tree_type delta{};
+    delta.insert(std::pair<const int, int>{-5, 3});
+    delta.insert(std::pair<const int, int>{1001, 3});
+    delta.insert(std::pair<const int, int>{4000, 3});
+    delta.insert(std::pair<const int, int>{1000, 3});
+    moved = &delta.find(1001)->second;
+    a.merge(std::move(delta));
+    EXPECT_EQ(a.size(), 2003u);
+    EXPECT_EQ(&a.find(1001)->second, moved);
+    EXPECT_EQ(a.begin()->first, -5);
+    EXPECT_EQ((--a.end())->first, 4000);
+    EXPECT_EQ(a.rank(1001), 669u);
+    EXPECT_EQ(delta.size(), 1u);
+    EXPECT_EQ(delta.begin()->first, 1000);
+    a.merge(a);
+    EXPECT_EQ(a.size(), 2003u);
+
+    using pool_tree = bst<int, int, std::less<int>, avl, pool_allocator<std::pair<const int, int>>>;
+    pool_tree c{};
+    pool_tree d{}; //another arena: the pairs are copied
+    for (int i = 0; i < 100; ++i)
+    {
+        c.insert(std::pair<const int, int>{2 * i, 0});
+        d.insert(std::pair<const int, int>{3 * i, 1});
+    }
+    c.merge(d);
+    EXPECT_EQ(c.size(), 166u);
+    EXPECT_EQ(d.size(), 34u);
+    EXPECT_EQ(c.find(3)->second, 1);
+    EXPECT_TRUE(d.is_balanced());
+    pool_tree e{c.get_allocator()};
+    e.merge(c); //same arena: an empty tree takes the Nodes as they are
+    EXPECT_EQ(e.size(), 166u);
+    EXPECT_EQ(c.size(), 0u);
+    EXPECT_EQ((--e.end())->first, 297);
+}
+
+TEST(TreeTests, set_operations)
+{
+    bst<int, int, std::less<int>, red_black> a{};
+    bst<int, int, std::less<int>, red_black> b{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        a.insert(std::pair<const int, int>{2 * i, 1});
+        b.insert(std::pair<const int, int>{3 * i, 2});
+    }
+    auto u = set_union(a, b);
+    auto n = set_intersection(a, b);
+    auto d = set_difference(a, b);
+    EXPECT_EQ(u.size(), 1666u);
+    EXPECT_EQ(n.size(), 334u);
+    EXPECT_EQ(d.size(), 666u);
+    EXPECT_EQ(u.find(6)->second, 1); //pairs of a win
+    EXPECT_EQ(u.find(9)->second, 2);
+    EXPECT_EQ(n.begin()->first, 0);
+    EXPECT_EQ((--n.end())->first, 1998);
+    EXPECT_TRUE(d.find(6) == d.end());
+    EXPECT_TRUE(d.find(4) != d.end());
+    EXPECT_TRUE(u.is_balanced());
+    EXPECT_TRUE(n.is_balanced());
+    EXPECT_TRUE(d.is_balanced());
+    for (const auto &p : u)
+    {
+        EXPECT_TRUE(p.first % 2 == 0 || p.first % 3 == 0);
+    }
+    u.insert(std::pair<const int, int>{1, 0}); //the policy keeps working on the result
+    EXPECT_EQ(u.begin()->first, 0);
+    EXPECT_EQ(std::next(u.begin())->first, 1);
+
+    bst<int, int, std::less<int>, red_black> empty{};
+    EXPECT_EQ(set_union(a, empty).size(), a.size());
+    EXPECT_EQ(set_intersection(empty, b).size(), 0u);
+    EXPECT_EQ(set_difference(a, empty).size(), a.size());
+    EXPECT_EQ(set_difference(a, a).size(), 0u);
+}
+
+TEST(TreeTests, split_and_join)
+{
+    bst<int, int, std::less<int>, order_statistics<red_black>> tree{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{(i * 7919) % 1000, i});
+    }
+    auto kept = &tree.find(499)->second;
+    auto moved = &tree.find(500)->second;
+    auto recent = tree.split(500);
+    EXPECT_EQ(tree.size(), 500u);
+    EXPECT_EQ(recent.size(), 500u);
+    EXPECT_EQ(&tree.find(499)->second, kept); //the Nodes are reused
+    EXPECT_EQ(&recent.find(500)->second, moved);
+    EXPECT_EQ((--tree.end())->first, 499);
+    EXPECT_EQ(recent.begin()->first, 500);
+    EXPECT_EQ(recent.rbegin()->first, 999);
+    EXPECT_TRUE(tree.find(500) == tree.end());
+    int expected{500};
+    for (const auto &p : recent)
+    {
+        EXPECT_EQ(p.first, expected++);
+    }
+    tree.insert(std::pair<const int, int>{-1, 0}); //both trees keep working
+    recent.erase(999);
+
+    auto whole = join(std::move(tree), std::move(recent));
+    EXPECT_EQ(whole.size(), 1000u);
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_EQ(recent.size(), 0u);
+    EXPECT_EQ(whole.begin()->first, -1);
+    EXPECT_EQ(whole.rbegin()->first, 998);
+    EXPECT_EQ(&whole.find(500)->second, moved);
+
+    auto none = whole.split(-5); //everything goes to the returned tree
+    EXPECT_EQ(whole.size(), 0u);
+    EXPECT_EQ(none.size(), 1000u);
+    auto all = none.split(5000);
+    EXPECT_EQ(none.size(), 1000u);
+    EXPECT_EQ(all.begin(), all.end());
+
+    bst<int, int, std::less<int>, order_statistics<avl>> ranked{};
+    for (int i = 0; i < 300; ++i)
+    {
+        ranked.insert(std::pair<const int, int>{i, i});
+    }
+    auto upper = ranked.split(100);
+    EXPECT_EQ(ranked.size(), 100u);
+    EXPECT_EQ(upper.size(), 200u);
+    EXPECT_EQ(upper.rank(150), 50u);
+    EXPECT_EQ(upper.select(0)->first, 100);
+    bst<int, int, std::less<int>, order_statistics<avl>> overlapping{};
+    overlapping.insert(std::pair<const int, int>{50, -1});
+    overlapping.insert(std::pair<const int, int>{1000, -1});
+    EXPECT_THROW(join(std::move(upper), std::move(overlapping)), std::invalid_argument);
+    EXPECT_EQ(upper.size(), 200u); //both untouched
+    EXPECT_EQ(overlapping.size(), 2u);
+    overlapping.erase(50);
+    auto joined = join(std::move(upper), std::move(overlapping));
+    EXPECT_EQ(joined.size(), 201u);
+    EXPECT_EQ(joined.rank(1000), 200u);
+    EXPECT_TRUE(overlapping.empty());
+
+    bst<int, int, std::less<int>, red_black> low{}; //join needs no subtree sizes
+    bst<int, int, std::less<int>, red_black> high{};
+    for (int i = 0; i < 100; ++i)
+    {
+        (i < 30 ? low : high).insert(std::pair<const int, int>{i, i});
+    }
+    auto both = join(std::move(low), std::move(high));
+    EXPECT_EQ(both.size(), 100u);
+    int next{0};
+    for (const auto &p : both)
+    {
+        EXPECT_EQ(p.first, next++);
+    }
+    EXPECT_EQ(next, 100);
+}
+
+TEST(TreeTests, bidirectional_iteration)
+{
+    bst<int, int> tree{};
+    tree_generator(tree);
+    auto last = tree.end();
+    --last;
+    EXPECT_EQ(last->first, 15);
+    EXPECT_EQ(std::prev(tree.end(), 3)->first, 11);
+
+    std::vector<int> last_three{};
+    for (auto it = tree.rbegin(); it != tree.rend() && last_three.size() < 3; ++it)
+    {
+        last_three.push_back(it->first);
+    }
+    EXPECT_EQ(last_three, (std::vector<int>{15, 12, 11}));
+
+    tree.erase(15); //the cached rightmost Node must follow
+    tree.erase(1);  //and so the leftmost
+    EXPECT_EQ(tree.rbegin()->first, 12);
+    EXPECT_EQ(tree.begin()->first, 2);
+    tree.insert(std::pair<const int, int>{0, 0});
+    EXPECT_EQ(tree.begin()->first, 0);
+
+    const bst<int, int> copy{tree};
+    EXPECT_EQ(copy.crbegin()->first, 12);
+    EXPECT_EQ(std::prev(copy.cend())->first, 12);
+
+    bst<int, int> empty{};
+    EXPECT_EQ(empty.begin(), empty.end());
+    EXPECT_EQ(empty.rbegin(), empty.rend());
+}
+
+/**
+ * @brief Key that counts the conversions from int, to see how often a probe is converted.
+ */
+struct tracked_key
+{
+    static int conversions;
+    int v;
+    tracked_key(int x) : v{x} { ++conversions; }
+    bool operator<(const tracked_key &other) const { return v < other.v; }
+};
+
+int tracked_key::conversions{0};
+
+TEST(TreeTests, find_batch)
+{
+    bst<int, int, std::less<int>, avl> tree{};
+    for (int i = 0; i < 200; i += 2)
+    {
+        tree.insert(std::pair<const int, int>{i, i * 10});
+    }
+    std::vector<int> keys{};
+    for (int i = 0; i < 101; ++i)
+    {
+        keys.push_back((i * 37) % 203); //present and missing keys, mixed
+    }
+    for (std::size_t group : {0u, 1u, 7u, 16u, 200u})
+    {
+        std::vector<decltype(tree.end())> found{};
+        tree.find_batch(keys.begin(), keys.end(), std::back_inserter(found), group);
+        ASSERT_EQ(found.size(), keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            EXPECT_EQ(found[i], tree.find(keys[i]));
+        }
+    }
+
+    const auto &const_tree = tree;
+    std::vector<decltype(const_tree.find(0))> found(3);
+    const int some_keys[]{4, 5, 198};
+    auto out = const_tree.find_batch(std::begin(some_keys), std::end(some_keys), found.begin());
+    EXPECT_EQ(out, found.end());
+    EXPECT_EQ(found[0]->second, 40);
+    EXPECT_EQ(found[1], const_tree.cend());
+    EXPECT_EQ(found[2]->second, 1980);
+
+    bst<tracked_key, int, std::less<tracked_key>, avl> tracked{};
+    for (int i = 0; i < 100; ++i)
+    {
+        tracked.insert(std::pair<const tracked_key, int>{i, i});
+    }
+    tracked_key::conversions = 0;
+    std::vector<decltype(tracked.end())> tracked_found{};
+    tracked.find_batch(keys.begin(), keys.end(), std::back_inserter(tracked_found), 7);
+    EXPECT_EQ(tracked_key::conversions, static_cast<int>(keys.size())); //not transparent: one conversion per key, not per level
+    EXPECT_EQ(tracked_found[1]->second, 37);
+}
+
+TEST(TreeTests, heterogeneous_lookup)
+{
+    bst<std::string, int, std::less<>> tree{};
+    tree.insert(std::pair<const std::string, int>{"a rather long key, longer than the small string buffer", 1});
+    tree.insert(std::pair<const std::string, int>{"b", 2});
+
+    const char *probe{"a rather long key, longer than the small string buffer"};
+    EXPECT_EQ(tree.find(probe)->second, 1);
+    EXPECT_EQ(tree.find("c"), tree.end());
+    const auto &const_tree = tree;
+    EXPECT_EQ(const_tree.find("b")->second, 2);
+
+    tree["b"] = 20;     //already there
+    tree["c"] = 3;      //inserted, building the key from the const char*
+    EXPECT_EQ(tree.find(std::string{"b"})->second, 20);
+    EXPECT_EQ(tree.find("c")->second, 3);
+
+    const char *probes[]{"c", "d", probe}; //compared as const char*, no std::string is built
+    std::vector<decltype(tree.end())> found{};
+    tree.find_batch(std::begin(probes), std::end(probes), std::back_inserter(found));
+    EXPECT_EQ(found[0]->second, 3);
+    EXPECT_EQ(found[1], tree.end());
+    EXPECT_EQ(found[2]->second, 1);
+
+    EXPECT_EQ(tree.erase("b"), 1u);
+    EXPECT_EQ(tree.find("b"), tree.end());
+    EXPECT_EQ(tree.erase("b"), 0u);
+    EXPECT_FALSE((is_transparent_comparator<std::less<std::string>>::value));
+    EXPECT_TRUE((is_transparent_comparator<std::less<>>::value));
+}
+
+TEST(TreeTests, bounds_and_ranges)
+{
+    bst<int, int, std::less<int>, red_black> tree{};
+    for (int i = 0; i < 100; i += 10)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    EXPECT_EQ(tree.lower_bound(20)->first, 20);
+    EXPECT_EQ(tree.lower_bound(21)->first, 30);
+    EXPECT_EQ(tree.upper_bound(20)->first, 30);
+    EXPECT_EQ(tree.lower_bound(-5), tree.begin());
+    EXPECT_EQ(tree.lower_bound(91), tree.end());
+    EXPECT_EQ(tree.upper_bound(90), tree.end());
+
+    auto found = tree.equal_range(40);
+    EXPECT_EQ(found.first->first, 40);
+    EXPECT_EQ(found.second->first, 50);
+    auto missing = tree.equal_range(45);
+    EXPECT_EQ(missing.first, missing.second);
+    EXPECT_EQ(missing.first->first, 50);
+
+    std::vector<int> window{};
+    for (const auto &p : tree.range(15, 50))
+    {
+        window.push_back(p.first);
+    }
+    EXPECT_EQ(window, (std::vector<int>{20, 30, 40}));
+    EXPECT_TRUE(tree.range(50, 50).empty());
+    EXPECT_TRUE(tree.range(60, 20).empty());
+    for (auto &p : tree.range(0, 20))
+    {
+        p.second = -1;
+    }
+    EXPECT_EQ(tree.find(10)->second, -1);
+
+    const auto &const_tree = tree;
+    EXPECT_EQ(const_tree.upper_bound(85)->first, 90);
+    EXPECT_EQ(std::distance(const_tree.range(0, 100).begin(), const_tree.range(0, 100).end()), 10);
+
+    bst<std::string, int, std::less<>> names{};
+    names.insert(std::pair<const std::string, int>{"apple", 1});
+    names.insert(std::pair<const std::string, int>{"banana", 2});
+    names.insert(std::pair<const std::string, int>{"cherry", 3});
+    EXPECT_EQ(names.lower_bound("b")->first, "banana");
+    EXPECT_EQ(names.upper_bound("banana")->first, "cherry");
+    EXPECT_EQ(names.equal_range("cherry").first->second, 3);
+    EXPECT_EQ(std::distance(names.range("a", "c").begin(), names.range("a", "c").end()), 2);
+}
+
+TEST(Balancing_Tests, only_order_statistics_counts)
+{
+    EXPECT_FALSE(red_black::counts_subtrees::value);
+    EXPECT_FALSE(avl::counts_subtrees::value);
+    EXPECT_TRUE(order_statistics<avl>::counts_subtrees::value);
+
+    using node = Node<int>;
+    node::owner root{new node{1}};
+    root->right.reset(new node{2});
+    root->right->parent = root.get();
+    root->subtree_size = root->right->subtree_size = 7; //stale on purpose
+    avl::rotate_left(root, root.get());
+    EXPECT_EQ(root->data, 2);
+    EXPECT_EQ(root->subtree_size, 7u); //the rotations of a plain policy never write the sizes
+    order_statistics<avl>::rotate_right(root, root.get());
+    EXPECT_EQ(root->data, 1);
+    EXPECT_EQ(root->subtree_size, 2u);
+    EXPECT_EQ(root->right->subtree_size, 1u);
+}
+
+TEST(Balancing_Tests, order_statistics)
+{
+    bst<int, int, std::less<int>, order_statistics<red_black>> tree{};
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_EQ(tree.select(0), tree.end());
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{(i * 7919) % 1000 * 2, i}); //even keys, shuffled
+    }
+    EXPECT_EQ(tree.size(), 1000u);
+    for (int i = 0; i < 1000; i += 3)
+    {
+        tree.erase(2 * i);
+    }
+    EXPECT_EQ(tree.size(), 666u);
+
+    std::size_t position{0};
+    for (auto it = tree.begin(); it != tree.end(); ++it, ++position)
+    {
+        EXPECT_EQ(tree.select(position), it);
+        EXPECT_EQ(tree.rank(it->first), position);
+        EXPECT_EQ(tree.rank(it->first + 1), position + 1); //odd keys are missing
+    }
+    EXPECT_EQ(tree.select(666), tree.end());
+    EXPECT_EQ(tree.rank(-1), 0u);
+    EXPECT_EQ(tree.rank(5000), 666u);
+
+    tree.balance(); //the sizes are rebuilt with the shape
+    EXPECT_EQ(tree.select(333)->first, std::next(tree.begin(), 333)->first);
+    const bst<int, int, std::less<int>, order_statistics<red_black>> copy{tree};
+    EXPECT_EQ(copy.size(), 666u);
+    EXPECT_EQ(copy.select(665)->first, tree.rbegin()->first);
+
+    std::mt19937 gen{42};
+    std::vector<int> hits(666, 0);
+    for (int i = 0; i < 66600; ++i)
+    {
+        ++hits[tree.rank(tree.sample(gen)->first)];
+    }
+    EXPECT_GT(*std::min_element(hits.begin(), hits.end()), 50); //about 100 each
+    EXPECT_LT(*std::max_element(hits.begin(), hits.end()), 160);
+
+    std::vector<std::pair<int, int>> pairs{{1, 1}, {2, 2}, {3, 3}};
+    bst<int, int, std::less<int>, order_statistics<avl>> loaded{sorted_unique, pairs.begin(), pairs.end()};
+    EXPECT_EQ(loaded.size(), 3u);
+    EXPECT_EQ(loaded.select(2)->first, 3);
+    auto moved{std::move(loaded)};
+    EXPECT_EQ(moved.size(), 3u);
+    EXPECT_EQ(loaded.size(), 0u);
+    moved.clear();
+    EXPECT_TRUE(moved.empty());
+    EXPECT_EQ(moved.size(), 0u);
+}
+
+TEST(TreeTests, erase_by_key_and_iterator)
+{
+    bst<std::string, copy_counter, std::less<std::string>, red_black> tree{};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree.insert(std::pair<const std::string, copy_counter>{std::to_string(1000 + i), copy_counter{}});
+    }
+    copy_counter::copies = 0;
+    EXPECT_EQ(tree.erase("1050"), 1u); //string keys compile, and missing keys don't throw
+    EXPECT_EQ(tree.erase("1050"), 0u);
+    EXPECT_EQ(tree.erase(std::string{"nope"}), 0u);
+
+    auto it = tree.find("1020");
+    auto kept = tree.find("1021");
+    auto next = tree.erase(it);
+    EXPECT_EQ(next, kept); //the successor is relinked, not copied: iterators to it stay valid
+    EXPECT_EQ(next->first, "1021");
+
+    for (auto i = tree.begin(); i != tree.end();)
+    {
+        i = (i->first.back() % 2) ? tree.erase(i) : std::next(i); //erase the odd ones while iterating
+    }
+    EXPECT_EQ(tree.size(), 48u); //1020 and 1050 were even
+    for (const auto &p : tree)
+    {
+        EXPECT_EQ(p.first.back() % 2, 0);
+    }
+
+    const auto &const_tree = tree;
+    auto last = tree.erase(const_tree.cbegin(), const_tree.find("1010"));
+    EXPECT_EQ(last->first, "1010");
+    EXPECT_EQ(tree.begin()->first, "1010");
+    EXPECT_EQ(tree.erase(std::prev(tree.end())), tree.end());
+    EXPECT_EQ(copy_counter::copies, 0); //no value has been copied
+}
+
+TEST(TreeTests, emplace_try_emplace_insert_or_assign)
+{
+    bst<int, copy_counter> tree{};
+    copy_counter::copies = 0;
+    EXPECT_TRUE(tree.emplace(1, 10).second); //the pair is built inside the Node
+    EXPECT_TRUE(tree.emplace(std::piecewise_construct, std::forward_as_tuple(2), std::forward_as_tuple(20)).second);
+    EXPECT_FALSE(tree.emplace(2, 30).second);
+    EXPECT_EQ(tree.find(2)->second.value, 20);
+    EXPECT_TRUE(tree.try_emplace(3, 30).second);
+    EXPECT_TRUE(tree.insert_or_assign(4, copy_counter{40}).second);
+    EXPECT_FALSE(tree.insert_or_assign(4, copy_counter{41}).second);
+    EXPECT_EQ(tree.find(4)->second.value, 41);
+    EXPECT_EQ(copy_counter::copies, 1); //only the copy assignment of insert_or_assign(4, 41): the move assignment isn't declared
+    EXPECT_EQ(tree.size(), 4u);
+
+    bst<std::string, std::unique_ptr<int>> owners{}; //move-only values
+    auto p = std::unique_ptr<int>(new int{7});
+    auto inserted = owners.try_emplace("a", std::move(p));
+    EXPECT_TRUE(inserted.second);
+    EXPECT_EQ(*inserted.first->second, 7);
+    EXPECT_EQ(p, nullptr);
+
+    auto q = std::unique_ptr<int>(new int{8});
+    EXPECT_FALSE(owners.try_emplace("a", std::move(q)).second);
+    ASSERT_NE(q, nullptr); //not moved from, since the key was there
+    EXPECT_EQ(*owners.find("a")->second, 7);
+
+    EXPECT_FALSE(owners.insert_or_assign("a", std::move(q)).second);
+    EXPECT_EQ(*owners.find("a")->second, 8);
+    std::string key{"b"};
+    EXPECT_TRUE(owners.insert_or_assign(std::move(key), std::unique_ptr<int>(new int{9})).second);
+    EXPECT_TRUE(owners.emplace("c", std::unique_ptr<int>(new int{10})).second);
+    EXPECT_EQ(*owners.find("c")->second, 10);
+
+    bst<int, int, std::less<int>, order_statistics<avl>> counted{};
+    for (int i = 0; i < 100; ++i)
+    {
+        counted.try_emplace(i, i);
+        counted.emplace(100 + i, i);
+        counted.insert_or_assign(200 + i, i);
+    }
+    EXPECT_EQ(counted.size(), 300u);
+    EXPECT_EQ(counted.select(150)->first, 150);
+    EXPECT_TRUE(counted.is_balanced());
+}
+
+/**
+ * @brief Comparison operator that counts how many times it's called.
+ */
+struct counting_less
+{
+    static int calls;
+    bool operator()(int a, int b) const
+    {
+        ++calls;
+        return a < b;
+    }
+};
+
+int counting_less::calls{0};
+
+TEST(TreeTests, subscript_single_descent)
+{
+    bst<int, int, counting_less> tree{};
+    for (int i = 0; i < 7; ++i)
+    {
+        tree.insert(std::pair<const int, int>{(i * 3) % 7, i}); //0 3 6 2 5 1 4
+    }
+    testing::internal::CaptureStdout();
+    counting_less::calls = 0;
+    tree[10] = 1; //missing: one descent to link it
+    const int missing_calls{counting_less::calls};
+    counting_less::calls = 0;
+    EXPECT_EQ(tree.find(10)->second, 1); //the same path, plus the test for equality at the end
+    EXPECT_LE(missing_calls, counting_less::calls);
+
+    int key{11};
+    ++tree[key];
+    ++tree[key];
+    EXPECT_EQ(tree[std::move(key)], 2);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), ""); //nothing printed
+
+    auto found = tree.find_or_insert(3);
+    EXPECT_FALSE(found.second);
+    EXPECT_EQ(found.first->second, 1);
+    auto inserted = tree.find_or_insert(12);
+    EXPECT_TRUE(inserted.second);
+    EXPECT_EQ(inserted.first->second, 0); //value-initialized
+    EXPECT_EQ(tree.size(), 10u);
+}
+
+TEST(TreeTests, hinted_insertion)
+{
+    bst<int, int, counting_less, avl> tree{};
+    counting_less::calls = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(tree.end(), std::pair<const int, int>{i, i}); //right hint: no descent from the head
+    }
+    EXPECT_LT(counting_less::calls, 2 * 1000);
+    EXPECT_TRUE(tree.is_balanced());
+
+    auto it = tree.insert(tree.find(10), std::pair<const int, int>{10, -1}); //already there
+    EXPECT_EQ(it->second, 10);
+    tree.erase(500);
+    it = tree.insert(tree.find(501), std::pair<const int, int>{500, 5}); //right hint in the middle
+    EXPECT_EQ(it->first, 500);
+    it = tree.emplace_hint(tree.begin(), 2000, 1); //wrong hint: falls back to a normal insertion
+    EXPECT_EQ(it, std::prev(tree.end()));
+    it = tree.emplace_hint(tree.cbegin(), -1, 1); //before the leftmost
+    EXPECT_EQ(it, tree.begin());
+    tree.erase(700);
+    tree.erase(701);
+    it = tree.emplace_hint(tree.find(699), 700, 7); //right after the hint
+    EXPECT_EQ(std::next(tree.find(699)), it);
+    it = tree.emplace_hint(tree.find(702), 701, 7); //right before the hint
+    EXPECT_EQ(std::prev(tree.find(702)), it);
+    EXPECT_EQ(tree.emplace_hint(tree.end(), 3, 0)->second, 3); //already there, wrong hint
+
+    int expected{-1};
+    for (const auto &p : tree)
+    {
+        EXPECT_EQ(p.first, expected);
+        expected = expected == 999 ? 2000 : expected + 1;
+    }
+    EXPECT_EQ(tree.size(), 1002u);
+
+    bst<int, int, std::less<int>, order_statistics<avl>> counted{};
+    for (int i = 0; i < 100; ++i)
+    {
+        counted.insert(counted.cend(), std::pair<const int, int>{2 * i, i});
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        counted.emplace_hint(counted.find(2 * i), 2 * i - 1, i);
+    }
+    EXPECT_EQ(counted.select(100)->first, 99);
+    EXPECT_TRUE(counted.is_balanced());
+}
@@ -0,0 +1,152 @@
+#include "../include/compact_bst.h"
+#include <gtest/gtest.h>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+TEST(CompactTests, same_behaviour_as_std_map)
+{
+    compact_bst<int, std::string> tree{};
+    std::map<int, std::string> reference{};
+    std::mt19937 gen{7};
+    for (int i = 0; i < 20000; ++i)
+    {
+        const int k = gen() % 500;
+        switch (gen() % 3)
+        {
+        case 0:
+            EXPECT_EQ(tree.insert(std::make_pair(k, std::to_string(k))).second, reference.emplace(k, std::to_string(k)).second);
+            break;
+        case 1:
+            tree[k] += "x";
+            reference[k] += "x";
+            break;
+        default:
+            EXPECT_EQ(tree.erase(k), reference.erase(k));
+        }
+    }
+    ASSERT_EQ(tree.size(), reference.size());
+    EXPECT_LE(tree.slot_count(), 500u); //erased slots are reused
+    auto it = reference.begin();
+    for (auto p : tree)
+    {
+        EXPECT_EQ(p.first, it->first);
+        EXPECT_EQ(p.second, it->second);
+        ++it;
+    }
+    EXPECT_EQ(std::distance(tree.begin(), tree.end()), static_cast<std::ptrdiff_t>(reference.size()));
+    EXPECT_EQ((*--tree.end()).first, reference.rbegin()->first);
+}
+
+TEST(CompactTests, fixups_match_red_black)
+{
+    //the fixups of compact_bst repeat those of red_black on slot indices: run both on the same operations
+    compact_bst<int, int> compact_tree{};
+    bst<int, int, std::less<int>, red_black> node_tree{};
+    std::mt19937 gen{11};
+    for (int round = 0; round < 200; ++round)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            const int k = gen() % 1000;
+            if (gen() % 2)
+            {
+                ASSERT_EQ(compact_tree.insert(std::make_pair(k, i)).second, node_tree.insert(std::pair<const int, int>{k, i}).second);
+            }
+            else
+            {
+                ASSERT_EQ(compact_tree.erase(k), node_tree.erase(k));
+            }
+        }
+        ASSERT_TRUE(compact_tree.is_red_black());
+        ASSERT_EQ(compact_tree.size(), node_tree.size());
+        auto it = node_tree.cbegin();
+        for (auto p : compact_tree)
+        {
+            ASSERT_EQ(p.first, it->first);
+            ASSERT_EQ(p.second, it->second);
+            ++it;
+        }
+    }
+    for (int k = 0; k < 1000; ++k) //down to empty
+    {
+        ASSERT_EQ(compact_tree.erase(k), node_tree.erase(k));
+        if (k % 50 == 0)
+        {
+            ASSERT_TRUE(compact_tree.is_red_black());
+        }
+    }
+    EXPECT_TRUE(compact_tree.empty());
+    EXPECT_TRUE(compact_tree.is_red_black());
+}
+
+TEST(CompactTests, bounds_and_erase_by_iterator)
+{
+    compact_bst<int, int> tree{};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree.insert(std::make_pair(2 * i, i));
+    }
+    EXPECT_EQ(tree.lower_bound(7)->first, 8);
+    EXPECT_EQ(tree.upper_bound(8)->first, 10);
+    EXPECT_EQ(tree.lower_bound(199), tree.end());
+    EXPECT_EQ(tree.count(9), 0u);
+
+    auto it = tree.find(50);
+    ASSERT_NE(it, tree.end());
+    it->second = -1;
+    EXPECT_EQ(tree.find(50)->second, -1);
+    it = tree.erase(it);
+    EXPECT_EQ(it->first, 52);
+    EXPECT_EQ(tree.find(50), tree.end());
+    EXPECT_EQ(tree.size(), 99u);
+
+    auto slots = tree.slot_count();
+    tree.try_emplace(51, 3);
+    EXPECT_EQ(tree.slot_count(), slots); //took the slot of 50
+    EXPECT_EQ(tree.find(51)->second, 3);
+
+    tree.clear();
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.begin(), tree.end());
+}
+
+TEST(CompactTests, erase_releases_the_entry)
+{
+    compact_bst<int, std::shared_ptr<int>> tree{};
+    auto token = std::make_shared<int>(7);
+    tree.insert(std::make_pair(1, token));
+    tree.insert(std::make_pair(2, token));
+    EXPECT_EQ(token.use_count(), 3);
+    EXPECT_EQ(tree.erase(1), 1u);
+    EXPECT_EQ(token.use_count(), 2); //not kept alive by the free slot
+    tree.erase(tree.find(2));
+    EXPECT_EQ(token.use_count(), 1);
+    tree.insert(std::make_pair(3, std::shared_ptr<int>{})); //reuses a slot
+    EXPECT_EQ(tree.find(3)->second, nullptr);
+}
+
+TEST(CompactTests, compact_copy_of_a_bst)
+{
+    for (int n : {0, 1, 2, 5, 64, 100})
+    {
+        bst<int, int, std::greater<int>> tree{};
+        for (int i = 0; i < n; ++i)
+        {
+            tree.insert(std::pair<const int, int>{(i * 37) % n, i});
+        }
+        auto compacted = compact(tree);
+        ASSERT_EQ(compacted.size(), static_cast<std::size_t>(n));
+        auto it = tree.cbegin();
+        for (auto p : compacted)
+        {
+            EXPECT_EQ(p.first, it->first);
+            EXPECT_EQ(p.second, it->second);
+            ++it;
+        }
+        compacted.insert(std::make_pair(n, n)); //still a valid red-black tree
+        EXPECT_EQ(compacted.begin()->first, n);
+    }
+}
@@ -0,0 +1,217 @@
+#include "../include/concurrent_bst.h"
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentTests, sequential_semantics)
+{
+    concurrent_bst<int, int> tree{};
+    for (int k : {50, 25, 75, 10, 30, 60, 90})
+    {
+        EXPECT_TRUE(tree.insert({k, k}));
+    }
+    EXPECT_FALSE(tree.insert({25, 0}));
+    EXPECT_EQ(tree.erase(25), 1u); //two children: only marked as erased
+    EXPECT_FALSE(tree.contains(25));
+    EXPECT_EQ(tree.erase(25), 0u);
+    EXPECT_TRUE(tree.insert({25, -25})); //revived
+    int v{0};
+    EXPECT_TRUE(tree.get(25, v));
+    EXPECT_EQ(v, -25);
+    EXPECT_EQ(tree.erase(10), 1u); //leaf
+    EXPECT_EQ(tree.erase(75), 1u);
+    EXPECT_FALSE(tree.insert_or_assign({90, 9}));
+    EXPECT_TRUE(tree.update(90, [](int &x) { x *= 10; }));
+    EXPECT_FALSE(tree.update(75, [](int &x) { x = 0; }));
+
+    std::vector<std::pair<int, int>> seen{};
+    tree.for_each([&seen](const std::pair<const int, int> &p) { seen.emplace_back(p.first, p.second); });
+    std::vector<std::pair<int, int>> expected{{25, -25}, {30, 30}, {50, 50}, {60, 60}, {90, 90}};
+    EXPECT_EQ(seen, expected);
+    EXPECT_EQ(tree.size(), 5u);
+}
+
+/**
+ * @brief Value that counts the live copies, to see when the Nodes are freed.
+ */
+struct counted_value
+{
+    static std::atomic<int> live;
+    counted_value() { ++live; }
+    counted_value(const counted_value &) { ++live; }
+    counted_value &operator=(const counted_value &) = default;
+    ~counted_value() { --live; }
+};
+
+std::atomic<int> counted_value::live{0};
+
+TEST(ConcurrentTests, marked_nodes_are_unlinked)
+{
+    {
+        concurrent_bst<int, counted_value> tree{};
+        for (int k : {50, 25, 75, 10, 30, 60, 90, 5})
+        {
+            tree.insert({k, counted_value{}});
+        }
+        EXPECT_EQ(tree.erase(25), 1u); //two children: marked
+        EXPECT_EQ(tree.erase(50), 1u); //marked too
+        EXPECT_EQ(counted_value::live, 8);
+        EXPECT_EQ(tree.erase(30), 1u); //25 is left with one child, and goes away with it
+        EXPECT_EQ(counted_value::live, 6);
+        EXPECT_EQ(tree.erase(10), 1u); //one child, no splice
+        EXPECT_EQ(tree.erase(5), 1u);  //now 50 is left with one child
+        EXPECT_EQ(counted_value::live, 3);
+        std::vector<int> seen{};
+        tree.for_each([&seen](const std::pair<const int, counted_value> &p) { seen.push_back(p.first); });
+        EXPECT_EQ(seen, (std::vector<int>{60, 75, 90}));
+        EXPECT_FALSE(tree.contains(50));
+        EXPECT_TRUE(tree.insert({50, counted_value{}}));
+        EXPECT_EQ(counted_value::live, 4);
+    }
+    EXPECT_EQ(counted_value::live, 0);
+
+    concurrent_bst<int, counted_value> tree{};
+    std::vector<int> keys(2000);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = static_cast<int>(i);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{5});
+    for (int k : keys)
+    {
+        tree.insert({k, counted_value{}});
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{6});
+    std::vector<std::thread> erasers{};
+    for (int t = 0; t < 4; ++t)
+    {
+        erasers.emplace_back([&keys, &tree, t]() {
+            for (std::size_t i = t; i < keys.size(); i += 4)
+            {
+                tree.erase(keys[i]);
+            }
+        });
+    }
+    for (auto &e : erasers)
+    {
+        e.join();
+    }
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(counted_value::live, 0); //every marked Node has two children, so none is left in an empty tree
+}
+
+TEST(ConcurrentTests, for_each_on_a_deep_tree)
+{
+    concurrent_bst<int, int> tree{};
+    for (int k = 0; k < 2000; ++k)
+    {
+        tree.insert({k, k}); //a list going right
+    }
+    for (int k = 1999; k >= 0; k -= 2)
+    {
+        tree.erase(k);
+    }
+    int expected{0};
+    tree.for_each([&expected](const std::pair<const int, int> &p) {
+        EXPECT_EQ(p.first, expected);
+        expected += 2;
+    });
+    EXPECT_EQ(expected, 2000);
+    EXPECT_THROW(tree.for_each([](const std::pair<const int, int> &p) {
+                     if (p.first == 1000)
+                     {
+                         throw std::runtime_error{"stop"};
+                     }
+                 }),
+                 std::runtime_error);
+    EXPECT_TRUE(tree.insert({1, 1})); //the locks have been released
+}
+
+TEST(ConcurrentTests, for_each_lets_writers_through)
+{
+    concurrent_bst<int, int> tree{};
+    for (int k : {50, 25, 75})
+    {
+        tree.insert({k, k});
+    }
+    std::vector<int> seen{};
+    tree.for_each([&seen, &tree](const std::pair<const int, int> &p) {
+        seen.push_back(p.first);
+        if (p.first == 25)
+        { //only 25 is locked: a writer passing through the root doesn't wait for the end of the visit
+            std::thread{[&tree]() { EXPECT_TRUE(tree.insert({80, 80})); }}.join();
+        }
+        if (p.first == 75)
+        {
+            std::thread{[&tree]() {
+                EXPECT_TRUE(tree.insert({10, 10})); //already behind the visit
+                EXPECT_EQ(tree.erase(50), 1u);
+            }}.join();
+        }
+    });
+    EXPECT_EQ(seen, (std::vector<int>{25, 50, 75, 80}));
+}
+
+TEST(ConcurrentTests, stress_parallel_writers)
+{
+    const int threads{4};
+    const int keys_per_thread{5000};
+    concurrent_bst<int, long int> tree{};
+    std::vector<int> keys(threads * keys_per_thread);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = static_cast<int>(i);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{3});
+
+    std::atomic<int> inserted{0};
+    std::vector<std::thread> writers{};
+    for (int t = 0; t < threads; ++t)
+    {
+        writers.emplace_back([&, t]() {
+            for (int k : keys)
+            {
+                if (tree.insert({k, 0})) //every thread races on every key
+                {
+                    ++inserted;
+                }
+                tree.update(k, [](long int &x) { ++x; });
+            }
+        });
+    }
+    for (auto &w : writers)
+    {
+        w.join();
+    }
+    writers.clear();
+    for (int t = 0; t < threads; ++t)
+    {
+        writers.emplace_back([&, t]() {
+            for (int i = t; i < static_cast<int>(keys.size()); i += threads)
+            {
+                if (keys[i] % 2)
+                {
+                    EXPECT_EQ(tree.erase(keys[i]), 1u); //each odd key erased by one thread only
+                }
+                EXPECT_TRUE(tree.contains(keys[(i + 1) % keys.size()]) || keys[(i + 1) % keys.size()] % 2);
+            }
+        });
+    }
+    for (auto &w : writers)
+    {
+        w.join();
+    }
+    EXPECT_EQ(inserted, threads * keys_per_thread); //each key inserted exactly once
+    EXPECT_EQ(tree.size(), keys.size() / 2);
+    int previous{-2};
+    tree.for_each([&previous, threads](const std::pair<const int, long int> &p) {
+        EXPECT_EQ(p.first, previous + 2);
+        EXPECT_EQ(p.second, threads); //no lost increments
+        previous = p.first;
+    });
+    EXPECT_EQ(previous, threads * keys_per_thread - 2);
+}
@@ -0,0 +1,69 @@
+#include "../include/frozen_bst.h"
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+
+TEST(FrozenTests, find_every_size)
+{
+    for (int n = 0; n <= 70; ++n) //every shape of the last level, up to 6 full levels
+    {
+        bst<int, int, std::less<int>, avl> tree{};
+        for (int i = 0; i < n; ++i)
+        {
+            tree.insert(std::pair<const int, int>{2 * i, i}); //even keys only
+        }
+        auto frozen = freeze(tree);
+        EXPECT_EQ(frozen.size(), static_cast<std::size_t>(n));
+        for (int i = 0; i < n; ++i)
+        {
+            auto it = frozen.find(2 * i);
+            ASSERT_NE(it, frozen.end());
+            EXPECT_EQ(it->first, 2 * i);
+            EXPECT_EQ(it->second, i);
+            EXPECT_EQ(frozen.find(2 * i + 1), frozen.end());
+            EXPECT_EQ(frozen.lower_bound(2 * i - 1)->first, 2 * i);
+        }
+        EXPECT_EQ(frozen.find(-1), frozen.end());
+        EXPECT_EQ(frozen.lower_bound(2 * n), frozen.end());
+    }
+}
+
+TEST(FrozenTests, ordered_iteration)
+{
+    bst<int, std::string> tree{};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree.insert(std::pair<const int, std::string>{(i * 37) % 100, std::to_string(i)});
+    }
+    auto frozen = freeze(tree);
+    auto it = tree.cbegin();
+    for (auto p : frozen)
+    {
+        EXPECT_EQ(p.first, it->first);
+        EXPECT_EQ(p.second, it->second);
+        ++it;
+    }
+    EXPECT_EQ(std::distance(frozen.begin(), frozen.end()), 100);
+
+    int expected{99};
+    for (auto rit = frozen.end(); rit != frozen.begin();)
+    {
+        --rit;
+        EXPECT_EQ((*rit).first, expected--);
+    }
+    EXPECT_EQ(expected, -1);
+}
+
+TEST(FrozenTests, custom_comparison)
+{
+    bst<int, int, std::greater<int>> tree{};
+    for (int i = 0; i < 10; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    auto frozen = freeze(tree);
+    EXPECT_EQ(frozen.begin()->first, 9);
+    EXPECT_EQ(frozen.find(3)->second, 3);
+    EXPECT_EQ(frozen.lower_bound(20)->first, 9);
+    EXPECT_EQ(frozen.count(10), 0u);
+}
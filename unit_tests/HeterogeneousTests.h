@@ -0,0 +1,225 @@
+#include "../include/compact_bst.h"
+#include "../include/concurrent_bst.h"
+#include "../include/frozen_bst.h"
+#include "../include/mapped_bst.h"
+#include "../include/sharded_bst.h"
+#include "../include/snapshot_bst.h"
+#include <cstdio> //std::remove
+#include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Probe that can be compared with int keys, but not converted to int: a lookup with it only compiles through the heterogeneous overloads.
+ */
+struct int_probe
+{
+    int v;
+};
+
+/**
+ * @brief Comparison of int keys with each other and with @ref int_probe.
+ */
+struct plain_probe_less
+{
+    bool operator()(int a, int b) const noexcept { return a < b; }
+    bool operator()(int a, const int_probe &b) const noexcept { return a < b.v; }
+    bool operator()(const int_probe &a, int b) const noexcept { return a.v < b; }
+};
+
+/**
+ * @brief The same comparison, declared transparent.
+ */
+struct probe_less : plain_probe_less
+{
+    using is_transparent = void;
+};
+
+/*
+ * One case per container: how to fill it with the keys, and a lookup that must compile with an
+ * int_probe if and only if the comparator is transparent.
+ */
+struct bst_case
+{
+    template <typename C>
+    using tree = bst<int, int, C>;
+
+    template <typename C>
+    static void fill(tree<C> &t, const std::vector<int> &keys)
+    {
+        for (int k : keys)
+        {
+            t.insert(std::pair<const int, int>{k, -k});
+        }
+    }
+
+    template <typename T, typename P>
+    static auto contains(const T &t, const P &p) -> decltype(t.find(p) != t.end())
+    {
+        return t.find(p) != t.end();
+    }
+};
+
+struct frozen_case
+{
+    template <typename C>
+    using tree = frozen_bst<int, int, C>;
+
+    template <typename C>
+    static void fill(tree<C> &t, const std::vector<int> &keys)
+    {
+        bst_case::tree<C> source{};
+        bst_case::fill(source, keys);
+        t = freeze(source);
+    }
+
+    template <typename T, typename P>
+    static auto contains(const T &t, const P &p) -> decltype(t.find(p) != t.end())
+    {
+        return t.find(p) != t.end();
+    }
+};
+
+struct mapped_case
+{
+    template <typename C>
+    using tree = mapped_bst<int, int, C>;
+
+    template <typename C>
+    static void fill(tree<C> &t, const std::vector<int> &keys)
+    {
+        const std::string path{"heterogeneous_test.bin"};
+        bst_case::tree<C> source{};
+        bst_case::fill(source, keys);
+        write_mapped(source, path);
+        t = tree<C>{path};
+        std::remove(path.c_str()); //the mapping stays valid
+    }
+
+    template <typename T, typename P>
+    static auto contains(const T &t, const P &p) -> decltype(t.find(p) != t.end())
+    {
+        return t.find(p) != t.end();
+    }
+};
+
+struct compact_case
+{
+    template <typename C>
+    using tree = compact_bst<int, int, C>;
+
+    template <typename C>
+    static void fill(tree<C> &t, const std::vector<int> &keys)
+    {
+        for (int k : keys)
+        {
+            t.insert(std::make_pair(k, -k));
+        }
+    }
+
+    template <typename T, typename P>
+    static auto contains(const T &t, const P &p) -> decltype(t.find(p) != t.end())
+    {
+        return t.find(p) != t.end();
+    }
+};
+
+struct snapshot_case
+{
+    template <typename C>
+    using tree = snapshot_bst<int, int, C>;
+
+    template <typename C>
+    static void fill(tree<C> &t, const std::vector<int> &keys)
+    {
+        for (int k : keys)
+        {
+            t.insert({k, -k});
+        }
+    }
+
+    template <typename T, typename P>
+    static auto contains(const T &t, const P &p) -> decltype(t.snapshot().count(p) != 0)
+    {
+        return t.snapshot().count(p) != 0;
+    }
+};
+
+struct concurrent_case
+{
+    template <typename C>
+    using tree = concurrent_bst<int, int, C>;
+
+    template <typename C>
+    static void fill(tree<C> &t, const std::vector<int> &keys)
+    {
+        for (int k : keys)
+        {
+            t.insert({k, -k});
+        }
+    }
+
+    template <typename T, typename P>
+    static auto contains(const T &t, const P &p) -> decltype(t.contains(p))
+    {
+        return t.contains(p);
+    }
+};
+
+struct sharded_case
+{
+    template <typename C>
+    using tree = sharded_bst<int, int, C>;
+
+    template <typename C>
+    static void fill(tree<C> &t, const std::vector<int> &keys)
+    {
+        for (int k : keys)
+        {
+            t.insert({k, -k});
+        }
+        t.split_shard(0); //the probes are routed too
+    }
+
+    template <typename T, typename P>
+    static auto contains(const T &t, const P &p) -> decltype(t.contains(p))
+    {
+        return t.contains(p);
+    }
+};
+
+/**
+ * @brief Whether `Case::contains` compiles for a tree with comparator C and an @ref int_probe.
+ */
+template <typename Case, typename C, typename = void>
+struct finds_probes : std::false_type
+{
+};
+
+template <typename Case, typename C>
+struct finds_probes<Case, C, decltype(void(Case::contains(std::declval<const typename Case::template tree<C> &>(), std::declval<const int_probe &>())))> : std::true_type
+{
+};
+
+template <typename Case>
+class HeterogeneousTests : public ::testing::Test
+{
+};
+
+using lookup_cases = ::testing::Types<bst_case, frozen_case, mapped_case, compact_case, snapshot_case, concurrent_case, sharded_case>;
+TYPED_TEST_SUITE(HeterogeneousTests, lookup_cases);
+
+TYPED_TEST(HeterogeneousTests, probes_need_a_transparent_comparator)
+{
+    static_assert(finds_probes<TypeParam, probe_less>::value, "a transparent comparator takes the probes as they are");
+    static_assert(!finds_probes<TypeParam, plain_probe_less>::value, "without is_transparent the probe would have to be converted to int, which it can't");
+
+    typename TypeParam::template tree<probe_less> t{};
+    TypeParam::fill(t, {10, 20, 30, 40});
+    EXPECT_TRUE(TypeParam::contains(t, int_probe{20}));
+    EXPECT_TRUE(TypeParam::contains(t, int_probe{40}));
+    EXPECT_FALSE(TypeParam::contains(t, int_probe{25}));
+    EXPECT_TRUE(TypeParam::contains(t, 30)); //keys still go through the plain overload
+}
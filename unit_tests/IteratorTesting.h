@@ -69,3 +69,29 @@ TEST(IteratorTests, post_increment)
     auto itpp = it.operator++(1);
     EXPECT_EQ(itpp->first, parent_pair.first);
 }
+
+TEST(IteratorTests, pre_decrement)
+{
+    std::pair<int, int> parent_pair{8, 8};
+    std::pair<int, int> ten_pair{10, 10};
+    std::pair<int, int> frteen_pair{14, 14};
+    Node<std::pair<int, int>> parent_node{parent_pair, nullptr};
+
+    parent_node.right.reset(new Node<std::pair<int, int>>(frteen_pair, &parent_node));
+    parent_node.right->left.reset(new Node<std::pair<int, int>>(ten_pair, parent_node.right.get()));
+
+    auto it = _iterator<std::pair<int, int>, false>(parent_node.right.get());
+    EXPECT_EQ((--it)->first, ten_pair.first);
+    EXPECT_EQ((--it)->first, parent_pair.first);
+    auto itmm = it--;
+    EXPECT_EQ(itmm->first, parent_pair.first);
+    EXPECT_TRUE((it == _iterator<std::pair<int, int>, false>(nullptr))); //before the first Node
+}
+
+TEST(IteratorTests, decrement_end)
+{
+    Node<std::pair<int, int>> node{std::pair<int, int>{8, 8}, nullptr};
+    tree_header<std::pair<int, int>> header{&node, &node, 1};
+    auto end = _iterator<std::pair<int, int>, true>(nullptr, &header);
+    EXPECT_EQ((--end)->first, 8);
+}
@@ -0,0 +1,77 @@
+#include "../include/mapped_bst.h"
+#include <gtest/gtest.h>
+#include <cstdio> //std::remove
+#include <fstream>
+#include <iterator>
+#include <string>
+
+TEST(MappedTests, find_and_iterate)
+{
+    const std::string path{"mapped_test.bin"};
+    for (int n : {0, 1, 2, 5, 8, 1000})
+    {
+        bst<int, double, std::less<int>, red_black> tree{};
+        for (int i = 0; i < n; ++i)
+        {
+            const int k{(i * 37) % 1000};
+            tree.insert(std::pair<const int, double>{2 * k, k * 0.5}); //even keys only
+        }
+        write_mapped(tree, path);
+        mapped_bst<int, double> mapped{path};
+        EXPECT_EQ(mapped.size(), tree.size());
+        EXPECT_TRUE(mapped.verify());
+        EXPECT_EQ(std::distance(mapped.begin(), mapped.end()), n);
+        auto it = mapped.cbegin();
+        for (const auto &p : tree)
+        {
+            EXPECT_EQ(it->first, p.first);
+            EXPECT_EQ(it->second, p.second);
+            EXPECT_EQ(mapped.find(p.first)->second, p.second);
+            EXPECT_EQ(mapped.find(p.first + 1), mapped.end());
+            EXPECT_EQ(mapped.lower_bound(p.first - 1)->first, p.first);
+            ++it;
+        }
+        EXPECT_EQ(mapped.lower_bound(2000), mapped.end());
+        if (n)
+        {
+            EXPECT_EQ((--mapped.end())->first, tree.rbegin()->first);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(MappedTests, rejects_bad_files)
+{
+    const std::string path{"mapped_test.bin"};
+    bst<int, int> tree{};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, -i});
+    }
+    write_mapped(tree, path);
+    EXPECT_THROW((mapped_bst<long int, int>{path}), std::runtime_error);
+    EXPECT_THROW((mapped_bst<int, int>{"no/such/file.bin"}), std::runtime_error);
+
+    mapped_bst<int, int> view{};
+    EXPECT_TRUE(view.empty());
+    {
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(100);
+        file.put('\x7f'); //inside the keys
+    }
+    view = mapped_bst<int, int>{path};
+    EXPECT_EQ(view.size(), 100u);
+    EXPECT_FALSE(view.verify());
+
+    bst<int, int> tree2{};
+    tree2.insert(std::pair<const int, int>{1, 1});
+    write_mapped(tree2, path);
+    std::ifstream in{path, std::ios::binary};
+    std::string bytes{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    in.close();
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 1)); //truncated
+    out.close();
+    EXPECT_THROW((mapped_bst<int, int>{path}), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,127 @@
+#include "../include/bst.h"
+#include <gtest/gtest.h>
+#include <string>
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+
+using pool_tree = bst<int, int, std::less<int>, unbalanced, pool_allocator<std::pair<const int, int>>>;
+
+TEST(NodePoolTests, arena_reuses_freed_blocks)
+{
+    node_arena arena{4};
+    auto a = arena.allocate(sizeof(double));
+    auto b = arena.allocate(sizeof(double));
+    arena.deallocate(a);
+    EXPECT_EQ(arena.allocate(sizeof(double)), a); //the freed block is handed out again
+    EXPECT_NE(b, a);
+    EXPECT_EQ(arena.chunk_count(), 1u);
+    for (int i = 0; i < 3; ++i)
+    {
+        arena.allocate(sizeof(double));
+    }
+    EXPECT_EQ(arena.chunk_count(), 2u); //4 blocks per chunk
+    arena.release();
+    EXPECT_EQ(arena.chunk_count(), 0u);
+}
+
+TEST(NodePoolTests, owners_give_nodes_back_to_the_pool)
+{
+    using node = Node<std::pair<const int, int>, pool_allocator<std::pair<const int, int>>>;
+    pool_allocator<node> alloc{4};
+    auto make = [&alloc](int k) {
+        auto p = alloc.allocate(1);
+        ::new (static_cast<void *>(p)) node{nullptr, k, k};
+        p->left.get_deleter() = p->right.get_deleter() = node::deleter_type{alloc};
+        return p;
+    };
+    node::owner root{make(1), node::deleter_type{alloc}};
+    root->right.reset(make(2));
+    root->right->parent = root.get();
+    node *first{root.get()};
+    node *second{root->right.get()};
+    root.reset(); //the whole subtree goes back to the arena, nothing is deleted
+    node::owner a{make(3), node::deleter_type{alloc}};
+    node::owner b{make(4), node::deleter_type{alloc}};
+    EXPECT_TRUE((a.get() == first && b.get() == second) || (a.get() == second && b.get() == first));
+    EXPECT_EQ(alloc.resource().chunk_count(), 1u);
+}
+
+TEST(NodePoolTests, tree_with_pool_allocator)
+{
+    pool_tree tree{pool_allocator<std::pair<const int, int>>{64}};
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{(i * 7919) % 1000, i});
+    }
+    EXPECT_EQ(tree.get_allocator().resource().chunk_count(), 16u); //1000 Nodes in chunks of 64
+    tree.erase(500);
+    EXPECT_EQ(tree.find(500), tree.end());
+    tree.balance();
+    EXPECT_TRUE(tree.is_balanced());
+    int expected{0};
+    for (const auto &p : tree)
+    {
+        if (expected == 500)
+        {
+            ++expected;
+        }
+        EXPECT_EQ(p.first, expected++);
+    }
+    tree.clear();
+    EXPECT_EQ(tree.begin(), tree.end());
+}
+
+TEST(NodePoolTests, copy_gets_its_own_arena)
+{
+    pool_tree tree{};
+    for (int i = 0; i < 10; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    pool_tree copy{tree};
+    EXPECT_FALSE(copy.get_allocator() == tree.get_allocator());
+    tree.clear(); //frees the whole arena of tree, copy must be untouched
+    EXPECT_EQ(copy.find(9)->second, 9);
+
+    pool_tree moved{std::move(copy)};
+    EXPECT_EQ(moved.find(3)->second, 3);
+}
+
+TEST(NodePoolTests, non_trivial_pairs)
+{
+    bst<int, std::string, std::less<int>, avl, pool_allocator<std::pair<const int, std::string>>> tree{};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree.insert(std::pair<const int, std::string>{i, std::string(64, 'x')});
+    }
+    tree.erase(42);
+    EXPECT_EQ(tree.find(42), tree.end());
+    EXPECT_EQ(tree.find(43)->second.size(), 64u);
+}
+
+#if __cplusplus >= 201703L
+TEST(NodePoolTests, pmr_allocator)
+{
+    std::pmr::monotonic_buffer_resource resource{};
+    bst<int, int, std::less<int>, red_black, std::pmr::polymorphic_allocator<std::pair<const int, int>>> tree{&resource};
+    for (int i = 0; i < 100; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    EXPECT_EQ(tree.get_allocator().resource(), &resource);
+    EXPECT_EQ(tree.find(99)->second, 99);
+}
+#endif
+
+TEST(NodePoolTests, copy_is_preallocated)
+{
+    pool_tree tree{pool_allocator<std::pair<const int, int>>{16}};
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{(i * 7919) % 1000, i});
+    }
+    pool_tree copy{tree};
+    EXPECT_EQ(copy.get_allocator().resource().chunk_count(), 1u); //all the Nodes in one block
+    EXPECT_EQ(copy.find(999)->second, tree.find(999)->second);
+}
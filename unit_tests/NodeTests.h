@@ -50,6 +50,42 @@ TEST(nodeTesting, Multiple_Nodes)
     EXPECT_EQ(node.parent->parent->right->data.first, 2);
 }
 
+TEST(nodeTesting, Long_Chain_Destruction)
+{
+    //one million Nodes linked as a list: a recursive destruction would overflow the stack
+    auto head_node = new Node<std::pair<int, int>>(std::pair<int, int>(0, 0), nullptr);
+    auto last = head_node;
+    for (int i = 1; i < 1000000; ++i)
+    {
+        last->right.reset(new Node<std::pair<int, int>>(std::pair<int, int>(i, i), last));
+        last = last->right.get();
+    }
+    for (int i = 0; i < 1000; ++i) //zig-zag tail, to exercise the rotations
+    {
+        last->left.reset(new Node<std::pair<int, int>>(std::pair<int, int>(-i, i), last));
+        last = last->left.get();
+        last->right.reset(new Node<std::pair<int, int>>(std::pair<int, int>(i, -i), last));
+        last = last->right.get();
+    }
+    delete head_node;
+    SUCCEED();
+}
+
+TEST(nodeTesting, Deep_Copy)
+{
+    std::unique_ptr<Node<std::pair<int, int>>> head_node{new Node<std::pair<int, int>>(std::pair<int, int>(10, 10), nullptr)};
+    head_node->left.reset(new Node<std::pair<int, int>>(std::pair<int, int>(5, 5), head_node.get()));
+    head_node->left->right.reset(new Node<std::pair<int, int>>(std::pair<int, int>(7, 7), head_node->left.get()));
+    head_node->right.reset(new Node<std::pair<int, int>>(std::pair<int, int>(20, 20), head_node.get()));
+    Node<std::pair<int, int>> copy{head_node, nullptr};
+    EXPECT_EQ(copy.left->data.first, 5);
+    EXPECT_EQ(copy.left->right->data.first, 7);
+    EXPECT_EQ(copy.right->data.first, 20);
+    EXPECT_TRUE(copy.left->right->parent == copy.left.get());
+    EXPECT_TRUE(copy.right->parent == &copy);
+    EXPECT_TRUE(copy.left.get() != head_node->left.get());
+}
+
 // int main(int argc, char **argv)
 // {
 //     testing::InitGoogleTest(&argc, argv);
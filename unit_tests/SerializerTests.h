@@ -0,0 +1,148 @@
+#include "../include/bst.h"
+#include <gtest/gtest.h>
+#include <cstdio> //std::remove
+#include <sstream>
+#include <string>
+
+struct sample_point
+{
+    double x;
+    double y;
+};
+
+template <>
+struct serializer<sample_point> : trivial_serializer<sample_point, 0x706f696e74> //"point"
+{
+};
+
+enum class sample_colour : unsigned char
+{
+    red,
+    green
+};
+
+/**
+ * @brief A user-defined type with its own serializer: only the id is stored, the name is rebuilt from it.
+ */
+struct sample_record
+{
+    int id;
+    std::string name;
+};
+
+template <>
+struct serializer<sample_record>
+{
+    static constexpr bool bulk = false;
+    static constexpr std::uint64_t tag = 0x7265636f7264; //"record"
+
+    static void write(serial_writer &out, const sample_record &r)
+    {
+        out.write_value(r.id);
+    }
+
+    static sample_record read(serial_reader &in)
+    {
+        const int id{in.read_value<int>()};
+        return sample_record{id, "record " + std::to_string(id)};
+    }
+};
+
+TEST(SerializerTests, round_trip)
+{
+    bst<int, sample_point, std::less<int>, red_black> tree{};
+    for (int i = 0; i < 10000; ++i)
+    {
+        const int k{(i * 7919) % 10007};
+        tree.insert(std::pair<const int, sample_point>{k, sample_point{k * 0.5, -k * 1.0}});
+    }
+    std::stringstream buffer{};
+    tree.save(buffer);
+    EXPECT_EQ(buffer.str().size(), 40 + 10000 * (sizeof(int) + sizeof(sample_point)) + 8); //header, pairs, checksum
+
+    bst<int, sample_point, std::less<int>, red_black> copy{};
+    copy.insert(std::pair<const int, sample_point>{-1, sample_point{}}); //replaced by the load
+    copy.load(buffer);
+    EXPECT_EQ(copy.size(), tree.size());
+    auto it = copy.cbegin();
+    for (const auto &p : tree)
+    {
+        EXPECT_EQ(it->first, p.first);
+        EXPECT_EQ(it->second.y, p.second.y);
+        ++it;
+    }
+    EXPECT_EQ(copy.rbegin()->first, tree.rbegin()->first);
+    copy.insert(std::pair<const int, sample_point>{-1, sample_point{}}); //the policy keeps working
+    EXPECT_EQ(copy.begin()->first, -1);
+
+    bst<std::string, sample_record> records{};
+    for (int i = 0; i < 100; ++i)
+    {
+        records.insert(std::pair<const std::string, sample_record>{"key " + std::to_string(i), sample_record{i, ""}});
+    }
+    const std::string path{"serializer_test.bin"};
+    records.save(path);
+    bst<std::string, sample_record, std::less<std::string>, avl> loaded{};
+    loaded.load(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded.size(), 100u);
+    EXPECT_EQ(loaded.find("key 42")->second.name, "record 42");
+    EXPECT_TRUE(loaded.is_balanced());
+}
+
+TEST(SerializerTests, tags_tell_types_apart)
+{
+    EXPECT_NE(serializer<bool>::tag, serializer<unsigned char>::tag);
+    EXPECT_NE(serializer<char>::tag, serializer<signed char>::tag);
+    EXPECT_NE(serializer<char16_t>::tag, serializer<unsigned short>::tag);
+    EXPECT_NE(serializer<char32_t>::tag, serializer<unsigned int>::tag);
+    EXPECT_NE(serializer<sample_colour>::tag, serializer<unsigned char>::tag);
+    EXPECT_EQ(serializer<sample_colour>::tag >> 56, std::uint64_t{'E'});
+    EXPECT_EQ(serializer<const int>::tag, serializer<int>::tag);
+    EXPECT_EQ(serializer<int>::tag, (std::uint64_t{'S'} << 56) | sizeof(int)); //unchanged, files saved before still load
+    EXPECT_EQ(serializer<double>::tag, (std::uint64_t{'F'} << 56) | sizeof(double));
+    EXPECT_TRUE(serializer<sample_point>::bulk);
+
+    bst<int, bool> flags{};
+    flags.insert(std::pair<const int, bool>{1, true});
+    std::stringstream buffer{};
+    flags.save(buffer);
+    bst<int, unsigned char> bytes{};
+    EXPECT_THROW(bytes.load(buffer), std::runtime_error);
+}
+
+TEST(SerializerTests, rejects_bad_input)
+{
+    bst<int, int> tree{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        tree.insert(std::pair<const int, int>{i, i});
+    }
+    std::stringstream buffer{};
+    tree.save(buffer);
+    const std::string bytes{buffer.str()};
+
+    bst<int, int> target{};
+    target.insert(std::pair<const int, int>{-1, -1});
+    std::string corrupted{bytes};
+    corrupted[100] ^= 1;
+    std::stringstream bad{corrupted};
+    EXPECT_THROW(target.load(bad), std::runtime_error);
+    std::stringstream truncated{bytes.substr(0, bytes.size() / 2)};
+    EXPECT_THROW(target.load(truncated), std::runtime_error);
+    std::stringstream not_a_tree{"hello, world"};
+    EXPECT_THROW(target.load(not_a_tree), std::runtime_error);
+    EXPECT_EQ(target.size(), 1u); //untouched
+    EXPECT_EQ(target.begin()->first, -1);
+
+    std::stringstream other_types{bytes};
+    bst<long int, int> wrong{};
+    EXPECT_THROW(wrong.load(other_types), std::runtime_error);
+    EXPECT_THROW(target.load(std::string{"no/such/file.bin"}), std::runtime_error);
+
+    bst<int, int> empty{};
+    std::stringstream nothing{};
+    empty.save(nothing);
+    target.load(nothing);
+    EXPECT_EQ(target.begin(), target.end());
+}
@@ -0,0 +1,115 @@
+#include "../include/sharded_bst.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(ShardedTests, routing_and_ordered_iteration)
+{
+    sharded_bst<int, int> map{{100, 200, 300}};
+    EXPECT_EQ(map.shard_count(), 4u);
+    for (int i = 399; i >= 0; --i)
+    {
+        EXPECT_TRUE(map.insert({i, i}));
+    }
+    EXPECT_FALSE(map.insert({150, 0}));
+    for (std::size_t s = 0; s < 4; ++s)
+    {
+        EXPECT_EQ(map.shard_size(s), 100u);
+    }
+    EXPECT_EQ(map.erase(250), 1u);
+    EXPECT_EQ(map.erase(250), 0u);
+    EXPECT_FALSE(map.contains(250));
+    EXPECT_FALSE(map.insert_or_assign(100, -100));
+    int v{0};
+    EXPECT_TRUE(map.get(100, v));
+    EXPECT_EQ(v, -100);
+    EXPECT_EQ(map[500], 0); //inserted
+    map.update(500, [](int &x) { x = 5; });
+    EXPECT_EQ(map[500], 5);
+
+    int expected{0};
+    for (const auto &p : map)
+    {
+        if (expected == 250)
+        {
+            ++expected;
+        }
+        EXPECT_EQ(p.first, expected == 400 ? 500 : expected);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 401);
+    EXPECT_EQ(map.size(), 400u);
+}
+
+TEST(ShardedTests, split_shard)
+{
+    sharded_bst<int, int> map{};
+    EXPECT_FALSE(map.split_shard(0));
+    for (int i = 0; i < 1000; ++i)
+    {
+        map.insert({i, i});
+    }
+    map.update(10, [](int &) {});
+    EXPECT_TRUE(map.split_hottest());
+    EXPECT_EQ(map.shard_count(), 2u);
+    EXPECT_EQ(map.shard_size(0), 500u);
+    EXPECT_EQ(map.shard_size(1), 500u);
+    EXPECT_TRUE(map.split_shard(1));
+    EXPECT_EQ(map.shard_size(2), 250u);
+    EXPECT_TRUE(map.contains(999));
+    EXPECT_TRUE(map.contains(500));
+    EXPECT_TRUE(map.insert({1000, 0}));
+    EXPECT_EQ(map.shard_size(2), 251u); //routed to the last shard
+    int expected{0};
+    for (const auto &p : map)
+    {
+        EXPECT_EQ(p.first, expected++);
+    }
+    EXPECT_EQ(expected, 1001);
+}
+
+TEST(ShardedTests, split_shard_checks_the_index)
+{
+    sharded_bst<int, int, std::less<int>, order_statistics<red_black>> map{{10}};
+    for (int i = 0; i < 20; ++i)
+    {
+        map.insert({i, i});
+    }
+    EXPECT_THROW(map.split_shard(2), std::out_of_range);
+    EXPECT_THROW(map.shard_size(2), std::out_of_range);
+    EXPECT_TRUE(map.split_shard(1)); //the median found by select()
+    EXPECT_EQ(map.shard_size(1), 5u);
+    EXPECT_EQ(map.shard_size(2), 5u);
+    EXPECT_TRUE(map.contains(15));
+    EXPECT_EQ(map.size(), 20u);
+}
+
+TEST(ShardedTests, split_while_writing)
+{
+    sharded_bst<int, int> map{{50000}};
+    std::vector<std::thread> writers{};
+    for (int t = 0; t < 4; ++t)
+    {
+        writers.emplace_back([&map, t]() {
+            for (int i = t; i < 100000; i += 4)
+            {
+                map.insert({i, i});
+            }
+        });
+    }
+    for (int s = 0; s < 6; ++s)
+    {
+        map.split_hottest();
+    }
+    for (auto &w : writers)
+    {
+        w.join();
+    }
+    EXPECT_EQ(map.size(), 100000u);
+    int expected{0};
+    for (const auto &p : map)
+    {
+        EXPECT_EQ(p.first, expected++);
+    }
+    EXPECT_EQ(expected, 100000);
+}
@@ -0,0 +1,105 @@
+#include "../include/snapshot_bst.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(SnapshotTests, versions_are_isolated)
+{
+    snapshot_bst<int, std::string> tree{};
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(tree.insert({i, std::to_string(i)}));
+    }
+    EXPECT_FALSE(tree.insert({5, "five"}));
+    auto before = tree.snapshot();
+
+    EXPECT_FALSE(tree.insert_or_assign({5, "five"}));
+    EXPECT_EQ(tree.erase(42), 1u);
+    EXPECT_EQ(tree.erase(42), 0u);
+    auto after = tree.snapshot();
+
+    EXPECT_EQ(*before.get(5), "5"); //taken before the updates
+    EXPECT_EQ(before.size(), 100u);
+    EXPECT_NE(before.find(42), before.end());
+    EXPECT_EQ(*after.get(5), "five");
+    EXPECT_EQ(after.size(), 99u);
+    EXPECT_EQ(after.find(42), after.end());
+    EXPECT_EQ(after.lower_bound(42)->first, 43);
+    EXPECT_EQ(after.upper_bound(43)->first, 44);
+
+    int expected{40};
+    for (const auto &p : after.range(40, 45))
+    {
+        if (expected == 42)
+        {
+            ++expected;
+        }
+        EXPECT_EQ(p.first, expected++);
+    }
+    EXPECT_EQ(expected, 45);
+
+    tree.clear();
+    EXPECT_TRUE(tree.snapshot().empty());
+    EXPECT_EQ(after.size(), 99u);
+}
+
+TEST(SnapshotTests, old_versions_are_freed)
+{
+    snapshot_bst<int, std::shared_ptr<int>> tree{};
+    auto token = std::make_shared<int>(1);
+    tree.insert({1, token});
+    std::thread{[&tree]() {
+        auto s = tree.snapshot(); //pinned in the slot of this thread
+        EXPECT_EQ(**s.get(1), 1);
+    }}.join();
+    auto kept = tree.snapshot();
+    EXPECT_GT(token.use_count(), 1);
+    tree.erase(1);
+    EXPECT_GT(token.use_count(), 1); //still in kept
+    kept = tree.snapshot();
+    EXPECT_EQ(token.use_count(), 1); //the erase has dropped the pin left by the other thread
+    EXPECT_EQ(kept.size(), 0u);
+}
+
+TEST(SnapshotTests, readers_see_whole_versions)
+{
+    snapshot_bst<int, int> tree{};
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers{};
+    for (int r = 0; r < 4; ++r)
+    {
+        readers.emplace_back([&tree, &done, &failures]() {
+            while (!done)
+            {
+                auto s = tree.snapshot();
+                std::size_t expected{0}; //the writer only appends, so every version holds 0..size-1
+                for (const auto &p : s)
+                {
+                    if (p.first != static_cast<int>(expected++))
+                    {
+                        ++failures;
+                    }
+                }
+                if (expected != s.size())
+                {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 5000; ++i)
+    {
+        tree.insert({i, i});
+    }
+    done = true;
+    for (auto &t : readers)
+    {
+        t.join();
+    }
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(tree.size(), 5000u);
+}
@@ -1,6 +1,15 @@
 #include "NodeTests.h"
 #include "IteratorTesting.h"
 #include "BstTests.h"
+#include "NodePoolTests.h"
+#include "SerializerTests.h"
+#include "FrozenTests.h"
+#include "MappedTests.h"
+#include "CompactTests.h"
+#include "SnapshotTests.h"
+#include "ConcurrentTests.h"
+#include "ShardedTests.h"
+#include "HeterogeneousTests.h"
 
 int main(int argc, char **argv)
 {